@@ -0,0 +1,57 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - MEMORY ARENA
+*
+*   One block of memory handed out front to back. Allocating is bumping an offset;
+*   there is no per-allocation free, the whole arena is reset at once by setting the
+*   offset back to zero (O(1), no matter how much was handed out). The simulation
+*   gets all of its entity arrays from a single arena (see SimCreate in sim.h).
+*
+*     Arena arena;
+*     ArenaInit(&arena, malloc(size), size);
+*     float *x = ArenaAlloc(&arena, count * sizeof(float));
+*     ArenaReset(&arena);     // Everything above is gone
+*
+********************************************************************************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Every allocation starts on a cache line (also enough for any SIMD load)
+#define ARENA_ALIGNMENT 64
+
+typedef struct {
+    unsigned char *base;
+    size_t         capacity;
+    size_t         used;
+} Arena;
+
+// Room an allocation can take up, padding included. To size an arena, add up
+// ArenaAlignedSize() of every allocation plus ARENA_ALIGNMENT for the start.
+static inline size_t ArenaAlignedSize(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static inline void ArenaInit(Arena *arena, void *memory, size_t capacity) {
+    arena->base = memory;
+    arena->capacity = memory ? capacity : 0;
+    arena->used = 0;
+}
+
+// Returns NULL when the arena is full. The memory is not cleared.
+static inline void *ArenaAlloc(Arena *arena, size_t size) {
+    uintptr_t start = (uintptr_t)(arena->base + arena->used);
+    size_t offset = arena->used + (size_t)(ArenaAlignedSize(start) - start);
+    if (offset > arena->capacity || size > arena->capacity - offset) return NULL;
+    arena->used = offset + size;
+    return arena->base + offset;
+}
+
+static inline void ArenaReset(Arena *arena) {
+    arena->used = 0;
+}
+
+#endif // ARENA_H
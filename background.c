@@ -0,0 +1,89 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - PARALLAX BACKGROUND
+*
+*   Baking and drawing the star layers (see background.h).
+*
+********************************************************************************************/
+
+#include "raylib.h"
+#include "background.h"
+#include "starfield.h"
+
+static RenderTexture2D layers[STARFIELD_LAYERS];
+static bool loaded = false;
+
+// =====================================================================
+// LESSON 5: BACKGROUND STARS
+// =====================================================================
+// Parallax effect: layers scrolling at different speeds give a sense of
+// depth. Each layer is drawn into a texture once (see starfield.h for
+// where every star is).
+//
+// LESSON: Stars are added onto a black texture (BLEND_ADDITIVE) and the
+// texture is added onto the screen the same way. Black adds nothing, so the
+// layers stack without any alpha, and dimming the sky is just a darker tint.
+// A star that pokes out of the top or bottom edge is drawn a second time on
+// the opposite edge, so the texture tiles without a seam.
+
+static void BakeStar(const StarfieldStar *star) {
+    Color color = {
+        (unsigned char)(200 * star->brightness),
+        (unsigned char)(200 * star->brightness),
+        (unsigned char)(255 * star->brightness),
+        255
+    };
+    DrawCircleV(star->position, star->size, color);
+    if (star->position.y - star->size < 0)
+        DrawCircleV((Vector2){ star->position.x, star->position.y + SCREEN_HEIGHT }, star->size, color);
+    if (star->position.y + star->size > SCREEN_HEIGHT)
+        DrawCircleV((Vector2){ star->position.x, star->position.y - SCREEN_HEIGHT }, star->size, color);
+}
+
+void BackgroundLoad(int starCount) {
+    BackgroundUnload();
+    for (int l = 0; l < STARFIELD_LAYERS; l++) {
+        layers[l] = LoadRenderTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+        BeginTextureMode(layers[l]);
+        ClearBackground(BLACK);
+        BeginBlendMode(BLEND_ADDITIVE);
+        // Star i is on layer i % STARFIELD_LAYERS
+        for (int i = l; i < starCount; i += STARFIELD_LAYERS) {
+            StarfieldStar star = StarfieldGetStar(STARFIELD_SEED, i);
+            BakeStar(&star);
+        }
+        EndBlendMode();
+        EndTextureMode();
+    }
+    loaded = true;
+}
+
+void BackgroundUnload(void) {
+    if (!loaded) return;
+    for (int l = 0; l < STARFIELD_LAYERS; l++) UnloadRenderTexture(layers[l]);
+    loaded = false;
+}
+
+// =====================================================================
+// DRAWING
+// =====================================================================
+
+void BackgroundDraw(double scroll, float brightness, int layerCount) {
+    if (!loaded) return;
+    if (layerCount > STARFIELD_LAYERS) layerCount = STARFIELD_LAYERS;
+
+    unsigned char level = (unsigned char)(255 * (brightness < 0 ? 0 : (brightness > 1 ? 1 : brightness)));
+    Color tint = { level, level, level, 255 };
+    // Render textures are stored upside down, hence the negative source height
+    Rectangle source = { 0, 0, SCREEN_WIDTH, -SCREEN_HEIGHT };
+
+    BeginBlendMode(BLEND_ADDITIVE);
+    // Thinning the sky drops the far layers first: they are the dimmest
+    for (int l = STARFIELD_LAYERS - layerCount; l < STARFIELD_LAYERS; l++) {
+        // The layer moved down by offset: one copy there, one right above it
+        float offset = StarfieldLayerOffset(l, scroll);
+        DrawTextureRec(layers[l].texture, source, (Vector2){ 0, offset }, tint);
+        DrawTextureRec(layers[l].texture, source, (Vector2){ 0, offset - SCREEN_HEIGHT }, tint);
+    }
+    EndBlendMode();
+}
@@ -0,0 +1,26 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - PARALLAX BACKGROUND
+*
+*   The star field (starfield.h) baked into one screen-sized, vertically tileable
+*   texture per parallax layer. Drawing the background is two textured quads per layer,
+*   offset by how far the layer has scrolled, so 100 stars and 100,000 stars cost the
+*   same per frame; only BackgroundLoad gets slower.
+*
+*   Needs raylib and an open window: call BackgroundLoad() after InitWindow() and
+*   BackgroundUnload() before CloseWindow().
+*
+********************************************************************************************/
+
+#ifndef BACKGROUND_H
+#define BACKGROUND_H
+
+// Bake starCount stars (spread over all layers); can be called again to re-bake
+void BackgroundLoad(int starCount);
+void BackgroundUnload(void);
+
+// scroll: seconds of scrolling so far; brightness dims the whole sky (0..1);
+// layerCount thins it out by drawing only the nearest layers (STARFIELD_LAYERS: all)
+void BackgroundDraw(double scroll, float brightness, int layerCount);
+
+#endif // BACKGROUND_H
@@ -0,0 +1,246 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - MONTE CARLO BATCH RUNNER
+*
+*   Plays a large number of seeded games with the bot (bot.h), spread over every
+*   core, and prints how the games went: how long the bot survived, which wave it
+*   reached and what it scored, as percentiles and a histogram of waves. The
+*   difficulty curve (SimTuning in sim.h) can be changed from the command line, so
+*   a balance change can be measured over thousands of games before anyone plays it:
+*
+*     ./batch --games=200000 --spawn-interval=1.6 --spawn-chance=50,30,20
+*
+*   Game g always uses seed + g and runs on one thread from start to end, so the
+*   results are the same for any thread count (the "results" hash proves it). The
+*   throughput is reported per core, to plan sweeps on bigger machines. Particles
+*   are switched off: they never change a game (see particleScale in sim.h).
+*
+*   To compile:
+*     gcc batch.c bot.c sim.c particles.c jobs.c config.c -O2 -o batch -lm -lpthread
+*
+*   Usage:
+*     ./batch [--games=N] [--seed=N] [--threads=N] [--max-time=SECONDS] [--csv=FILE]
+*             [--reaction=SECONDS] [--spawn-interval=S] [--difficulty-period=S] [--wave-period=S]
+*             [--spawn-chance=N,N,N] [--config=FILE] [--max-bullets=N ...]
+*
+********************************************************************************************/
+
+#include "sim.h"
+#include "bot.h"
+#include "config.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_CHUNK         16      // Games per job: one Simulation is set up per chunk
+#define BATCH_HISTOGRAM     40      // Width of the longest histogram bar
+
+typedef struct {
+    float time;             // Seconds survived
+    int   wave;
+    int   score;
+    long  ticks;
+    bool  timedOut;         // Still alive at --max-time
+} GameResult;
+
+typedef struct {
+    SimConfig    config;
+    SimTuning    tuning;
+    unsigned int seed;
+    float        maxTime;
+    float        reaction;  // The bot's, in seconds
+    GameResult  *results;
+    int          failed;    // Chunks that couldn't allocate their simulation
+} Batch;
+
+static const char *FlagValue(const char *arg, const char *name) {
+    size_t len = strlen(name);
+    if (strncmp(arg, name, len) == 0 && arg[len] == '=') return arg + len + 1;
+    return NULL;
+}
+
+static void PlayGamesJob(void *context, int begin, int end) {
+    Batch *batch = context;
+    Simulation sim;
+    if (!SimCreate(&sim, &batch->config)) {
+        JobAtomicAdd(&batch->failed, 1);
+        return;
+    }
+    sim.tuning = batch->tuning;
+    float dt = 1.0f / SIM_TICK_RATE;
+
+    for (int g = begin; g < end; g++) {
+        SimInit(&sim, batch->seed + (unsigned int)g);
+        Bot bot;
+        BotInit(&bot, batch->reaction, dt);
+        GameResult *result = &batch->results[g];
+        result->ticks = 0;
+        bool alive = true;
+        while (alive && sim.gameTime < batch->maxTime) {
+            alive = SimStep(&sim, BotInput(&bot, &sim), dt);
+            result->ticks++;
+        }
+        result->time = sim.gameTime;
+        result->wave = sim.wave;
+        result->score = sim.player.score;
+        result->timedOut = alive;
+    }
+    SimDestroy(&sim);
+}
+
+static int CompareFloats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// One row of percentiles; sorts values
+static void PrintDistribution(const char *name, float *values, int count) {
+    qsort(values, (size_t)count, sizeof(float), CompareFloats);
+    double sum = 0;
+    for (int i = 0; i < count; i++) sum += values[i];
+    const int percentiles[] = { 10, 25, 50, 75, 90, 99 };
+    printf("%-8s %9.1f %9.1f", name, sum / count, values[0]);
+    for (int p = 0; p < 6; p++) printf(" %9.1f", values[(long)(count - 1) * percentiles[p] / 100]);
+    printf(" %9.1f\n", values[count - 1]);
+}
+
+int main(int argc, char **argv) {
+    Batch batch = { SimDefaultConfig(), SimDefaultTuning(), 1, 600.0f, BOT_REACTION, NULL, 0 };
+    batch.config.maxParticles = 0;
+    int games = 10000;
+    int threads = JobSystemDefaultThreads();
+    const char *csvPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if (ConfigParseFlag(&batch.config, argv[i])) continue;
+        if ((v = FlagValue(argv[i], "--games"))) games = atoi(v);
+        else if ((v = FlagValue(argv[i], "--seed"))) batch.seed = (unsigned int)strtoul(v, NULL, 10);
+        else if ((v = FlagValue(argv[i], "--threads"))) threads = atoi(v);
+        else if ((v = FlagValue(argv[i], "--max-time"))) batch.maxTime = (float)atof(v);
+        else if ((v = FlagValue(argv[i], "--reaction"))) batch.reaction = (float)atof(v);
+        else if ((v = FlagValue(argv[i], "--csv"))) csvPath = v;
+        else if ((v = FlagValue(argv[i], "--spawn-interval"))) batch.tuning.spawnInterval = (float)atof(v);
+        else if ((v = FlagValue(argv[i], "--difficulty-period"))) batch.tuning.difficultyPeriod = (float)atof(v);
+        else if ((v = FlagValue(argv[i], "--wave-period"))) batch.tuning.wavePeriod = (float)atof(v);
+        else if ((v = FlagValue(argv[i], "--spawn-chance"))) {
+            // Comma separated percentages, one per enemy type
+            for (int t = 0; t < ENEMY_TYPE_COUNT && *v; t++) {
+                char *next;
+                batch.tuning.spawnChance[t] = (int)strtol(v, &next, 10);
+                v = (*next == ',') ? next + 1 : next;
+            }
+        }
+        else {
+            fprintf(stderr, "usage: %s [--games=N] [--seed=N] [--threads=N] [--max-time=SECONDS] [--csv=FILE]\n"
+                            "       [--reaction=SECONDS] [--spawn-interval=S] [--difficulty-period=S] [--wave-period=S]\n"
+                            "       [--spawn-chance=N,N,N] [--config=FILE] [--max-bullets=N ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (games < 1) games = 1;
+    if (batch.tuning.spawnInterval <= 0 || batch.tuning.difficultyPeriod <= 0 || batch.tuning.wavePeriod <= 0) {
+        fprintf(stderr, "the spawn interval and periods must be positive\n");
+        return 1;
+    }
+    // SimSpawnEnemy gives whatever is missing from 100 to the last type
+    int chanceSum = 0;
+    bool chanceNegative = false;
+    for (int t = 0; t < ENEMY_TYPE_COUNT; t++) {
+        chanceSum += batch.tuning.spawnChance[t];
+        chanceNegative |= batch.tuning.spawnChance[t] < 0;
+    }
+    if (chanceSum != 100 || chanceNegative) {
+        fprintf(stderr, "the spawn chances must be %d percentages that add up to 100 (these add up to %d)\n",
+                ENEMY_TYPE_COUNT, chanceSum);
+        return 1;
+    }
+
+    batch.results = calloc((size_t)games, sizeof(GameResult));
+    JobSystem *jobs = JobSystemCreate(threads);
+    if (!batch.results || !jobs) {
+        fprintf(stderr, "out of memory for %d games\n", games);
+        return 1;
+    }
+    threads = JobSystemThreadCount(jobs);
+    int cores = JobSystemDefaultThreads();      // More threads than cores don't add any
+    if (cores > threads) cores = threads;
+
+    printf("bot:          reacts every %.2f s\n", batch.reaction);
+    printf("tuning:       spawn every %.2f s, difficulty +1 every %.1f s, wave every %.1f s, types",
+           batch.tuning.spawnInterval, batch.tuning.difficultyPeriod, batch.tuning.wavePeriod);
+    for (int t = 0; t < ENEMY_TYPE_COUNT; t++) printf(" %d%%", batch.tuning.spawnChance[t]);
+    printf("\n");
+
+    double start = TimerNow();
+    JobParallelFor(jobs, games, BATCH_CHUNK, PlayGamesJob, &batch);
+    double elapsed = TimerNow() - start;
+    JobSystemDestroy(jobs);
+    if (batch.failed > 0) {
+        fprintf(stderr, "out of memory for %zu bytes\n", SimArenaSize(&batch.config));
+        return 1;
+    }
+
+    // Totals, and a hash of every result to compare runs
+    long ticks = 0;
+    int timedOut = 0, maxWave = 1;
+    unsigned int hash = 2166136261u;
+    for (int g = 0; g < games; g++) {
+        const GameResult *r = &batch.results[g];
+        ticks += r->ticks;
+        timedOut += r->timedOut;
+        if (r->wave > maxWave) maxWave = r->wave;
+        int fields[] = { (int)r->ticks, r->wave, r->score };
+        for (size_t k = 0; k < sizeof(fields); k++) hash = (hash ^ ((unsigned char *)fields)[k]) * 16777619u;
+    }
+
+    printf("games:        %d (seeds %u to %u), %d still alive after %.0f s\n",
+           games, batch.seed, batch.seed + (unsigned int)games - 1, timedOut, batch.maxTime);
+    printf("elapsed:      %.3f s on %d thread%s\n", elapsed, threads, threads == 1 ? "" : "s");
+    printf("throughput:   %.0f games/s, %.0f games/s per core, %.0fx realtime per core\n",
+           games / elapsed, games / elapsed / cores, ticks / (double)SIM_TICK_RATE / elapsed / cores);
+    printf("results:      %08x\n\n", hash);
+
+    float *values = malloc((size_t)games * sizeof(float));
+    if (!values) return 1;
+    printf("%-8s %9s %9s %9s %9s %9s %9s %9s %9s %9s\n",
+           "", "mean", "min", "p10", "p25", "p50", "p75", "p90", "p99", "max");
+    for (int g = 0; g < games; g++) values[g] = batch.results[g].time;
+    PrintDistribution("time (s)", values, games);
+    for (int g = 0; g < games; g++) values[g] = (float)batch.results[g].wave;
+    PrintDistribution("wave", values, games);
+    for (int g = 0; g < games; g++) values[g] = (float)batch.results[g].score;
+    PrintDistribution("score", values, games);
+    free(values);
+
+    // Where games end, wave by wave
+    int *reached = calloc((size_t)maxWave + 1, sizeof(int));
+    if (!reached) return 1;
+    int most = 0;
+    for (int g = 0; g < games; g++) reached[batch.results[g].wave]++;
+    for (int w = 1; w <= maxWave; w++) if (reached[w] > most) most = reached[w];
+    printf("\nlast wave\n");
+    for (int w = 1; w <= maxWave; w++) {
+        int bar = (int)((long)reached[w] * BATCH_HISTOGRAM / most);
+        printf("%5d %8d  %.*s\n", w, reached[w], bar, "########################################");
+    }
+    free(reached);
+
+    if (csvPath) {
+        FILE *csv = fopen(csvPath, "w");
+        if (!csv) {
+            fprintf(stderr, "can't write %s\n", csvPath);
+            return 1;
+        }
+        fprintf(csv, "seed,time,wave,score,alive\n");
+        for (int g = 0; g < games; g++) {
+            const GameResult *r = &batch.results[g];
+            fprintf(csv, "%u,%.3f,%d,%d,%d\n", batch.seed + (unsigned int)g, r->time, r->wave, r->score, r->timedOut);
+        }
+        fclose(csv);
+    }
+
+    free(batch.results);
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - COLLISION BROADPHASE BENCHMARK
+*
+*   Fills the playfield with N enemies and N/2 upward bullets, then runs the same
+*   ticks twice from identical state: once testing every enemy against every bullet,
+*   once with the spatial grid. Prints the cost of each and checks that both runs
+*   end in exactly the same state.
+*
+*   Before that, one long tick (5 per second) shoots a bullet through an enemy
+*   that just spawned above the screen and on past the line where bullets are
+*   culled; with either broadphase it has to hit. Exits with 1 if it does not.
+*
+*   To compile:
+*     gcc bench_collision.c sim.c particles.c jobs.c -O2 -o bench_collision -lm -lpthread
+*
+********************************************************************************************/
+
+#include "sim.h"
+#include "timer.h"
+#include <stdio.h>
+
+#define BENCH_TICKS 20
+#define BENCH_MAX_ENEMIES 10000
+#define BENCH_MAX_BULLETS 5000
+
+static Simulation brute, grid;
+
+// Scatter enemies and bullets over the whole field
+static void FillScenario(Simulation *sim, int enemyCount, int bulletCount) {
+    SimInit(sim, 12345);
+    sim->player.position = (Vector2){ SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT - 30.0f };
+    sim->player.prev_position = sim->player.position;
+
+    for (int i = 0; i < enemyCount && i < sim->enemyPool.capacity; i++) {
+        Enemy *e = &sim->enemies[SimSpawnEnemy(sim)];
+        e->position = (Vector2){
+            (float)SimRandomInt(sim, 0, SCREEN_WIDTH),
+            (float)SimRandomInt(sim, 0, SCREEN_HEIGHT - 100)
+        };
+        e->prev_position = e->position;
+    }
+    for (int j = 0; j < bulletCount && j < sim->bulletPool.capacity; j++) {
+        Vector2 p = {
+            (float)SimRandomInt(sim, 0, SCREEN_WIDTH),
+            (float)SimRandomInt(sim, 0, SCREEN_HEIGHT)
+        };
+        SimShootBullet(sim, p, (Vector2){ 0, -500.0f }, (Color){ 0, 200, 255, 255 });
+    }
+}
+
+static double Run(Simulation *sim, bool broadphase) {
+    SimInput idle = { 0 };
+    sim->broadphase = broadphase;
+    double t0 = TimerNow();
+    for (int t = 0; t < BENCH_TICKS; t++) SimStep(sim, idle, 1.0f / SIM_TICK_RATE);
+    return TimerNow() - t0;
+}
+
+// A bullet below the top edge, an enemy where new ones spawn (40 px above it).
+// At 500 px/s a 0.2 s tick carries the bullet 100 px: through the enemy and
+// past viewTop - 10, so it is only hit if the sweep runs before the cull.
+static bool TopEdgeHit(Simulation *sim, bool broadphase) {
+    SimInput idle = { 0 };
+    SimInit(sim, 12345);
+    sim->broadphase = broadphase;
+    float viewTop = sim->world.viewTop;
+    if (SimSpawnEnemyType(sim, ENEMY_NORMAL, (Vector2){ SCREEN_WIDTH / 2.0f, viewTop - 40.0f }) < 0) return false;
+    SimShootBullet(sim, (Vector2){ SCREEN_WIDTH / 2.0f, viewTop + 20.0f }, (Vector2){ 0, -500.0f },
+                   (Color){ 0, 200, 255, 255 });
+    SimStep(sim, idle, 0.2f);
+    for (int i = 0; i < sim->events.count; i++) {
+        if (sim->events.items[i].type == SIM_EVENT_BULLET_HIT) return true;
+    }
+    return false;
+}
+
+static bool SameState(const Simulation *a, const Simulation *b) {
+    if (a->player.score != b->player.score || a->player.health != b->player.health) return false;
+    if (a->rngState != b->rngState) return false;
+    if (a->enemyPool.count != b->enemyPool.count) return false;
+    if (a->bulletPool.count != b->bulletPool.count) return false;
+    if (a->particles.slots.count != b->particles.slots.count) return false;
+    for (int i = 0; i < a->enemyPool.count; i++) {
+        const Enemy *x = &a->enemies[i], *y = &b->enemies[i];
+        if (x->position.x != y->position.x || x->health != y->health) return false;
+    }
+    for (int j = 0; j < a->bulletPool.count; j++) {
+        if (a->bullets[j].position.x != b->bullets[j].position.x) return false;
+    }
+    return true;
+}
+
+int main(void) {
+    const int counts[] = { 20, 100, 500, 1000, 2500, 5000, 10000 };
+    SimConfig config = SimDefaultConfig();
+    config.maxEnemies = BENCH_MAX_ENEMIES;
+    config.maxBullets = BENCH_MAX_BULLETS;
+    if (!SimCreate(&brute, &config) || !SimCreate(&grid, &config)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    bool bruteHit = TopEdgeHit(&brute, false), gridHit = TopEdgeHit(&grid, true);
+    printf("top edge at 5 ticks/s: brute %s, grid %s\n\n",
+           bruteHit ? "hit" : "MISSED", gridHit ? "hit" : "MISSED");
+    if (!bruteHit || !gridHit) {
+        SimDestroy(&brute);
+        SimDestroy(&grid);
+        return 1;
+    }
+
+    printf("%8s %8s | %12s %12s | %8s | %s\n",
+           "enemies", "bullets", "brute us/tk", "grid us/tk", "speedup", "identical");
+    for (int c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++) {
+        int enemyCount = counts[c];
+        int bulletCount = enemyCount / 2 < 50 ? 50 : enemyCount / 2;
+
+        // Same seed, so both copies start out identical
+        FillScenario(&brute, enemyCount, bulletCount);
+        FillScenario(&grid, enemyCount, bulletCount);
+
+        double tBrute = Run(&brute, false);
+        double tGrid = Run(&grid, true);
+
+        printf("%8d %8d | %12.1f %12.1f | %7.1fx | %s\n",
+               enemyCount, bulletCount < BENCH_MAX_BULLETS ? bulletCount : BENCH_MAX_BULLETS,
+               tBrute * 1e6 / BENCH_TICKS, tGrid * 1e6 / BENCH_TICKS,
+               tGrid > 0 ? tBrute / tGrid : 0.0,
+               SameState(&brute, &grid) ? "yes" : "NO");
+    }
+
+    SimDestroy(&brute);
+    SimDestroy(&grid);
+    return 0;
+}
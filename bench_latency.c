@@ -0,0 +1,169 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - INPUT LATENCY BENCHMARK
+*
+*   Runs the game's frame pacing (latency.h) against a fake clock, once in normal
+*   mode and once in low latency mode, and prints the input-to-present histogram
+*   of each. No window and no waiting: a minute of frames takes a few milliseconds.
+*
+*   The simulation thread is modelled the way sim_thread.c runs it: a tick starts
+*   every 1/60 s, takes the input messages pushed before it started and publishes
+*   a frame when it is done. Tick and draw work vary from frame to frame (seeded),
+*   so the same flags always print the same numbers. Waiting for the tick in low
+*   latency mode is the game's own FramePacerWaitForTick, polling the model.
+*
+*   First it checks that a frame showing a tick (or an input) that an earlier frame
+*   already showed isn't counted again, and exits with 1 if it is.
+*
+*   To compile:
+*     gcc bench_latency.c latency.c -O2 -o bench_latency -lm
+*
+*   Usage:
+*     ./bench_latency [--frames=N] [--seed=N] [--tick-ms=MS] [--draw-ms=MS] [--present-ms=MS]
+*
+********************************************************************************************/
+
+#include "latency.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_TICK_DT       (1.0 / 60.0)
+#define BENCH_PHASE         0.005       // Seconds the first frame starts after the first tick
+
+typedef struct {
+    double       tickWork;      // Average seconds per tick
+    double       drawWork;      // Average seconds to draw a frame
+    double       presentWork;   // Seconds EndDrawing takes
+    unsigned int seed;
+    double      *samples;       // Every input message, in order
+    int          sampleCount;
+} Model;
+
+// Work between 0.5x and 1.5x the average, the same for the same (seed, n, salt)
+static double Jitter(const Model *model, double average, unsigned int n, unsigned int salt) {
+    unsigned int h = (model->seed ^ (n * 2654435761u) ^ (salt * 40503u)) * 2246822519u;
+    h ^= h >> 15;
+    h *= 3266489917u;
+    h ^= h >> 16;
+    return average * (0.5 + (h & 0xFFFF) / 65536.0);
+}
+
+static double TickDone(const Model *model, long tick) {
+    return tick * BENCH_TICK_DT + Jitter(model, model->tickWork, (unsigned int)tick, 1);
+}
+
+// The newest tick published by time now (-1: none yet)
+static long NewestTick(const Model *model, double now) {
+    long tick = (long)floor(now / BENCH_TICK_DT);
+    while (tick >= 0 && TickDone(model, tick) > now) tick--;
+    return tick;
+}
+
+// When the buttons of a tick were read: the last message pushed before it started
+static double TickInput(const Model *model, long tick) {
+    double start = tick * BENCH_TICK_DT;
+    for (int m = model->sampleCount - 1; m >= 0; m--)
+        if (model->samples[m] < start) return model->samples[m];
+    return 0.0;
+}
+
+// What FramePacerWaitForTick polls: the newest tick at the fake clock's time
+typedef struct {
+    const Model *model;
+    FakeClock   *clock;
+    long         tick;          // -1: none published yet
+} NewestTickContext;
+
+static double NewestTickInput(void *context) {
+    NewestTickContext *newest = context;
+    newest->tick = NewestTick(newest->model, newest->clock->time);
+    return newest->tick >= 0 ? TickInput(newest->model, newest->tick) : -1.0;
+}
+
+static void Run(Model *model, bool lowLatency, int frames) {
+    FakeClock fake = { BENCH_PHASE };      // Frames don't start in step with ticks
+    Clock clock = FakeClockMake(&fake);
+    FramePacer pacer;
+    FramePacerInit(&pacer, clock, BENCH_TICK_DT, lowLatency);
+    LatencyTracker latency;
+    LatencyInit(&latency);
+    model->sampleCount = 0;
+
+    for (int f = 0; f < frames; f++) {
+        double nextTick = (floor(fake.time / BENCH_TICK_DT) + 1.0) * BENCH_TICK_DT;
+        double sampled = FramePacerBeginFrame(&pacer, nextTick);
+        model->samples[model->sampleCount++] = sampled;
+
+        // The same wait the game does (the pacer only waits in low latency mode)
+        NewestTickContext newest = { model, &fake, -1 };
+        NewestTickInput(&newest);
+        FramePacerWaitForTick(&pacer, sampled, BENCH_TICK_DT, NewestTickInput, &newest);
+        long tick = newest.tick;
+
+        FakeClockAdvance(&fake, Jitter(model, model->drawWork, (unsigned int)f, 2));
+        double submitted = fake.time;
+        FakeClockAdvance(&fake, model->presentWork);
+        if (tick >= 0 && TickInput(model, tick) > 0) {
+            LatencyFrame times = { TickInput(model, tick), TickDone(model, tick), submitted, fake.time };
+            LatencyRecord(&latency, &times);
+        }
+        FramePacerEndFrame(&pacer);
+    }
+
+    printf("%s: %d frames in %.1f s (fake clock)\n", lowLatency ? "low latency" : "normal", frames, fake.time);
+    LatencyPrint(&latency, stdout);
+    printf("\n");
+}
+
+// A tick drawn twice, or a new tick with input a frame already showed, must not
+// be counted again: only the first frame that shows an input is its latency
+static bool CheckRepeatedTicks(void) {
+    LatencyTracker latency;
+    LatencyInit(&latency);
+    LatencyFrame first = { 1.000, 1.002, 1.007, 1.008 };
+    LatencyFrame again = { 1.000, 1.002, 1.014, 1.015 };    // Same tick, next frame
+    LatencyFrame held = { 1.000, 1.019, 1.021, 1.022 };     // Next tick, no newer input
+    LatencyFrame next = { 1.016, 1.019, 1.021, 1.022 };
+    bool counted[] = { LatencyRecord(&latency, &first), LatencyRecord(&latency, &again),
+                       LatencyRecord(&latency, &held), LatencyRecord(&latency, &next) };
+    return counted[0] && !counted[1] && !counted[2] && counted[3] &&
+           latency.count == 2 && latency.repeated == 2 && fabs(latency.worst - 0.008) < 1e-9;
+}
+
+int main(int argc, char **argv) {
+    Model model = { 0.002, 0.005, 0.0005, 1, NULL, 0 };
+    int frames = 3600;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--frames=", 9) == 0) frames = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--seed=", 7) == 0) model.seed = (unsigned int)strtoul(argv[i] + 7, NULL, 10);
+        else if (strncmp(argv[i], "--tick-ms=", 10) == 0) model.tickWork = atof(argv[i] + 10) / 1000.0;
+        else if (strncmp(argv[i], "--draw-ms=", 10) == 0) model.drawWork = atof(argv[i] + 10) / 1000.0;
+        else if (strncmp(argv[i], "--present-ms=", 13) == 0) model.presentWork = atof(argv[i] + 13) / 1000.0;
+        else {
+            fprintf(stderr, "usage: %s [--frames=N] [--seed=N] [--tick-ms=MS] [--draw-ms=MS] [--present-ms=MS]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (frames < 1) frames = 1;
+    if (model.tickWork * 1.5 >= BENCH_TICK_DT) {
+        fprintf(stderr, "a tick has to fit in 1/60 s (--tick-ms below %.1f)\n", BENCH_TICK_DT / 1.5 * 1000.0);
+        return 1;
+    }
+
+    if (!CheckRepeatedTicks()) {
+        fprintf(stderr, "a repeated tick was counted twice in the latency histogram\n");
+        return 1;
+    }
+
+    model.samples = malloc((size_t)frames * sizeof(double));
+    if (!model.samples) return 1;
+    printf("model: ticks every %.2f ms taking ~%.1f ms, draw ~%.1f ms, present %.1f ms\n\n",
+           BENCH_TICK_DT * 1000.0, model.tickWork * 1000.0, model.drawWork * 1000.0, model.presentWork * 1000.0);
+    Run(&model, false, frames);
+    Run(&model, true, frames);
+    free(model.samples);
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - PARTICLE UPDATE MICRO-BENCHMARK
+*
+*   Compares three ways to store particles: the original array of structs (one struct
+*   per particle, an `active` flag checked in every slot), the structure of float
+*   arrays the pool used next, and the pool's 16-bit fixed-point arrays with their
+*   SIMD kernel from particles.c. Reports bytes and nanoseconds per particle update;
+*   past the cache sizes the smaller layouts win because less memory moves.
+*
+*   To compile (add -march=native to get the AVX2 kernel where available):
+*     gcc bench_particles.c particles.c -O2 -o bench_particles -lm
+*
+********************************************************************************************/
+
+#include "sim.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+// The particle layout the game used before the pool
+typedef struct {
+    Vector2 position;
+    Vector2 prev_position;
+    Vector2 velocity;
+    float   radius;
+    float   lifetime;
+    float   max_lifetime;
+    Color   color;
+    bool    active;
+} Particle;
+
+// The float structure of arrays the pool used before it went fixed point
+typedef struct {
+    float *x, *y, *prev_x, *prev_y, *vx, *vy, *lifetime, *max_lifetime, *radius;
+    Color *color;
+} FloatParticles;
+
+#define BENCH_CAPACITY  1000000
+#define FLOAT_BYTES     (9 * sizeof(float) + sizeof(Color))
+
+static Particle       *aos;
+static FloatParticles  floats;
+static ParticlePool    soa;         // Arrays carved from one arena, like in the game
+
+#define UPDATES_PER_RUN 50000000L   // Particle updates per measurement
+
+// The fixed-point lifetime only reaches 16 s, so the timed loop tops it up now
+// and then (one store per particle every few hundred updates)
+#define REFILL_ROUNDS   512
+
+static void RefillLifetimes(int count) {
+    for (int i = 0; i < count; i++) soa.lifetime[i] = INT16_MAX;
+}
+
+static void Fill(int count) {
+    soa.slots.count = count;
+    for (int i = 0; i < count; i++) {
+        float vx = (float)(i % 97) - 48.0f;
+        float vy = (float)(i % 89) - 44.0f;
+        aos[i] = (Particle){ { 400, 300 }, { 400, 300 }, { vx, vy }, 4.0f, 1e9f, 1e9f, { 255, 255, 255, 255 }, true };
+        floats.x[i] = 400; floats.y[i] = 300;
+        floats.vx[i] = vx; floats.vy[i] = vy;
+        floats.lifetime[i] = floats.max_lifetime[i] = 1e9f;    // Nothing expires during the run
+        floats.radius[i] = 4.0f;
+        floats.color[i] = (Color){ 255, 255, 255, 255 };
+        soa.x[i] = (int16_t)(400 * PARTICLE_POSITION_SCALE);
+        soa.y[i] = (int16_t)(300 * PARTICLE_POSITION_SCALE);
+        soa.vx[i] = (int16_t)(vx * PARTICLE_VELOCITY_SCALE);
+        soa.vy[i] = (int16_t)(vy * PARTICLE_VELOCITY_SCALE);
+        soa.max_lifetime[i] = INT16_MAX;
+        soa.radius[i] = (uint8_t)(4 * PARTICLE_RADIUS_SCALE);
+        soa.color[i] = 0;
+    }
+    RefillLifetimes(count);
+}
+
+static void UpdateAoS(int count, float dt, float drag) {
+    for (int i = 0; i < count; i++) {
+        if (aos[i].active) {
+            aos[i].prev_position = aos[i].position;
+            aos[i].position.x += aos[i].velocity.x * dt;
+            aos[i].position.y += aos[i].velocity.y * dt;
+            aos[i].lifetime -= dt;
+            aos[i].velocity.x *= drag;
+            aos[i].velocity.y *= drag;
+            if (aos[i].lifetime <= 0) aos[i].active = false;
+        }
+    }
+}
+
+// The float pool's update, with the SIMD kernel it had then
+static int UpdateFloats(int count, float dt, float drag) {
+    int i = 0;
+    int expired = 0;
+#if defined(__AVX__)
+    __m256 vdt = _mm256_set1_ps(dt), vdrag = _mm256_set1_ps(drag), zero = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(&floats.x[i]), y = _mm256_loadu_ps(&floats.y[i]);
+        __m256 vx = _mm256_loadu_ps(&floats.vx[i]), vy = _mm256_loadu_ps(&floats.vy[i]);
+        _mm256_storeu_ps(&floats.prev_x[i], x);
+        _mm256_storeu_ps(&floats.prev_y[i], y);
+        _mm256_storeu_ps(&floats.x[i], _mm256_add_ps(x, _mm256_mul_ps(vx, vdt)));
+        _mm256_storeu_ps(&floats.y[i], _mm256_add_ps(y, _mm256_mul_ps(vy, vdt)));
+        _mm256_storeu_ps(&floats.vx[i], _mm256_mul_ps(vx, vdrag));
+        _mm256_storeu_ps(&floats.vy[i], _mm256_mul_ps(vy, vdrag));
+        __m256 life = _mm256_sub_ps(_mm256_loadu_ps(&floats.lifetime[i]), vdt);
+        _mm256_storeu_ps(&floats.lifetime[i], life);
+        expired += _mm256_movemask_ps(_mm256_cmp_ps(life, zero, _CMP_LE_OQ)) != 0;
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 vdt = _mm_set1_ps(dt), vdrag = _mm_set1_ps(drag), zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(&floats.x[i]), y = _mm_loadu_ps(&floats.y[i]);
+        __m128 vx = _mm_loadu_ps(&floats.vx[i]), vy = _mm_loadu_ps(&floats.vy[i]);
+        _mm_storeu_ps(&floats.prev_x[i], x);
+        _mm_storeu_ps(&floats.prev_y[i], y);
+        _mm_storeu_ps(&floats.x[i], _mm_add_ps(x, _mm_mul_ps(vx, vdt)));
+        _mm_storeu_ps(&floats.y[i], _mm_add_ps(y, _mm_mul_ps(vy, vdt)));
+        _mm_storeu_ps(&floats.vx[i], _mm_mul_ps(vx, vdrag));
+        _mm_storeu_ps(&floats.vy[i], _mm_mul_ps(vy, vdrag));
+        __m128 life = _mm_sub_ps(_mm_loadu_ps(&floats.lifetime[i]), vdt);
+        _mm_storeu_ps(&floats.lifetime[i], life);
+        expired += _mm_movemask_ps(_mm_cmple_ps(life, zero)) != 0;
+    }
+#endif
+    for (; i < count; i++) {
+        floats.prev_x[i] = floats.x[i];
+        floats.prev_y[i] = floats.y[i];
+        floats.x[i] += floats.vx[i] * dt;
+        floats.y[i] += floats.vy[i] * dt;
+        floats.lifetime[i] -= dt;
+        floats.vx[i] *= drag;
+        floats.vy[i] *= drag;
+        expired += floats.lifetime[i] <= 0;
+    }
+    return expired;
+}
+
+int main(void) {
+    const int counts[] = { 200, 1000, 10000, 100000, 1000000 };
+    const float dt = 1.0f / SIM_TICK_RATE;
+    // Alternate drag with its inverse so velocities never decay into denormals,
+    // which would make every run measure the CPU's slow path instead
+    const float drag[2] = { 0.98f, 1.0f / 0.98f };
+
+    size_t soaSize = ParticlePoolArenaSize(BENCH_CAPACITY) + ARENA_ALIGNMENT;
+    Arena arena;
+    ArenaInit(&arena, malloc(soaSize), soaSize);
+    aos = malloc(BENCH_CAPACITY * sizeof(Particle));
+    float **fields[] = { &floats.x, &floats.y, &floats.prev_x, &floats.prev_y, &floats.vx, &floats.vy,
+                         &floats.lifetime, &floats.max_lifetime, &floats.radius };
+    bool ok = aos != NULL;
+    for (int f = 0; f < 9; f++) ok = ok && (*fields[f] = malloc(BENCH_CAPACITY * sizeof(float)));
+    floats.color = malloc(BENCH_CAPACITY * sizeof(Color));
+    if (!ok || !floats.color || !ParticlePoolCarve(&soa, &arena, BENCH_CAPACITY)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("kernel: %s\n", ParticleKernelName());
+    printf("bytes per particle: AoS %d, float SoA %d, fixed SoA %d\n",
+           (int)sizeof(Particle), (int)FLOAT_BYTES, (int)(ParticlePoolArenaSize(BENCH_CAPACITY) / BENCH_CAPACITY));
+    printf("%10s | %12s %12s %12s | %8s %8s\n", "particles",
+           "AoS ns/p", "float ns/p", "fixed ns/p", "vs AoS", "vs float");
+
+    for (int c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++) {
+        int count = counts[c];
+        long rounds = UPDATES_PER_RUN / count;
+
+        Fill(count);
+        double t0 = TimerNow();
+        for (long r = 0; r < rounds; r++) UpdateAoS(count, dt, drag[r & 1]);
+        double tAoS = TimerNow() - t0;
+
+        int expired = 0;
+        t0 = TimerNow();
+        for (long r = 0; r < rounds; r++) expired += UpdateFloats(count, dt, drag[r & 1]);
+        double tFloat = TimerNow() - t0;
+
+        t0 = TimerNow();
+        for (long r = 0; r < rounds; r++) {
+            if (ParticlePoolIntegrate(&soa, dt, drag[r & 1]) > 0)
+                ParticlePoolRemoveExpired(&soa);
+            if (r % REFILL_ROUNDS == REFILL_ROUNDS - 1) RefillLifetimes(count);
+        }
+        double tSoA = TimerNow() - t0;
+
+        double updates = (double)rounds * count;
+        printf("%10d | %12.3f %12.3f %12.3f | %7.2fx %7.2fx\n", count,
+               tAoS * 1e9 / updates, tFloat * 1e9 / updates, tSoA * 1e9 / updates,
+               tSoA > 0 ? tAoS / tSoA : 0.0, tSoA > 0 ? tFloat / tSoA : 0.0);
+        if (soa.slots.count != count || expired != 0) fprintf(stderr, "particles expired during the run\n");
+    }
+
+    // Keep the compiler from discarding the AoS and float work
+    return aos[0].position.x == 12345.0f || floats.x[0] == 12345.0f;
+}
@@ -0,0 +1,404 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SCENARIO STRESS BENCHMARK
+*
+*   Runs named, seeded stress scenarios through the real SimStep and reports, per
+*   subsystem (the profiler zones in sim.c), nanoseconds per tick and per entity.
+*   The numbers are compared against a checked-in baseline and any subsystem that
+*   got slower by more than the threshold is flagged; the exit code is 1 if one did,
+*   so this can run in CI before a change to the collision loop or the particle
+*   system ships.
+*
+*   Every scenario is topped up before each tick so the load stays constant (the
+*   top-up is timed as its own "Spawn" zone and isn't part of the tick). Each one
+*   runs a few times and the fastest repetition counts, which is the most stable
+*   number on a busy machine.
+*
+*   After every tick the state is also captured into a rewind ring (snapshot.h),
+*   timed as "Snapshot": the report shows the delta size and how much of a 60 Hz
+*   tick budget the capture takes, and a short rewind checks that the restored
+*   state matches the one recorded at that tick.
+*
+*   Baselines are per machine: after an intended change (or on new hardware) write
+*   a fresh one with --write-baseline and commit it.
+*
+*   To compile (the profiler provides the per-subsystem timings):
+*     gcc bench_scenarios.c sim.c particles.c jobs.c profiler.c snapshot.c -O2 -DENABLE_PROFILER \
+*         -o bench_scenarios -lm -lpthread
+*
+*   Usage:
+*     ./bench_scenarios [--baseline=FILE] [--write-baseline=FILE] [--threshold=PERCENT]
+*                       [--scenario=NAME] [--threads=N]
+*
+********************************************************************************************/
+
+#include "sim.h"
+#include "profiler.h"
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(ENABLE_PROFILER)
+    #error "bench_scenarios needs the profiler: compile with -DENABLE_PROFILER"
+#endif
+
+#define BASELINE_FILE       "bench_baseline.json"
+#define DEFAULT_THRESHOLD   15.0    // Percent slower before it counts as a regression
+#define WARMUP_TICKS        10
+#define MEASURE_TICKS       60
+#define REPETITIONS         5
+#define MAX_RESULTS         64
+#define NOISE_FLOOR_NS      2000.0  // Subsystems cheaper than this per tick are shown but never flagged
+#define REWIND_CHECK_TICKS  4       // How far back the snapshot check rewinds
+
+// =====================================================================
+// SCENARIOS
+// =====================================================================
+
+typedef struct {
+    const char *name;
+    const char *description;
+    SimConfig   config;
+    void      (*fill)(Simulation *sim);     // Build the starting state (not timed)
+    void      (*topUp)(Simulation *sim);    // Before every tick, timed as "Spawn"
+} Scenario;
+
+static Vector2 RandomPoint(Simulation *sim, float top, float bottom) {
+    return (Vector2){ SimRandomFloat(sim, 20, SCREEN_WIDTH - 20), SimRandomFloat(sim, top, bottom) };
+}
+
+// Player parked in the bottom corner and kept alive, so a stray enemy can't
+// end the scenario early
+static void ParkPlayer(Simulation *sim) {
+    sim->player.position = (Vector2){ 30, SCREEN_HEIGHT - 30 };
+    sim->player.prev_position = sim->player.position;
+    sim->player.active = true;
+    sim->player.health = 3;
+}
+
+// A random type, or the given one
+static void AddEnemy(Simulation *sim, int type, float top, float bottom) {
+    if (type < 0) {
+        int i = SimSpawnEnemy(sim);
+        if (i >= 0) sim->enemies[i].position = sim->enemies[i].prev_position = RandomPoint(sim, top, bottom);
+    } else {
+        SimSpawnEnemyType(sim, (EnemyType)type, RandomPoint(sim, top, bottom));
+    }
+}
+
+// 10k enemies of every type drifting down in the sinf(move_angle) wave,
+// replaced at the top as they leave the screen
+static void TopUpDrift(Simulation *sim) {
+    ParkPlayer(sim);
+    while (sim->enemyPool.count < sim->enemyPool.capacity) AddEnemy(sim, -1, -40, 0);
+}
+
+static void FillDrift(Simulation *sim) {
+    ParkPlayer(sim);
+    while (sim->enemyPool.count < sim->enemyPool.capacity) AddEnemy(sim, -1, 0, SCREEN_HEIGHT - 100);
+}
+
+// 100k particles from explosions all over the screen, topped up as they fade
+static void TopUpStorm(Simulation *sim) {
+    ParkPlayer(sim);
+    while (sim->particles.slots.count < sim->particles.slots.capacity) {
+        Color fire = { 255, (unsigned char)SimRandomInt(sim, 60, 200), 30, 255 };
+        SimSpawnParticles(sim, RandomPoint(sim, 20, SCREEN_HEIGHT - 20), fire, 500);
+    }
+}
+
+static void FillStorm(Simulation *sim) {
+    TopUpStorm(sim);
+}
+
+// 5k bullets flying up into 1k strong (3 HP) enemies. Dead enemies and spent
+// bullets are replaced every tick, so the collision load stays the same.
+static void TopUpBarrage(Simulation *sim) {
+    ParkPlayer(sim);
+    while (sim->enemyPool.count < sim->enemyPool.capacity) AddEnemy(sim, ENEMY_STRONG, 60, 400);
+    while (sim->bulletPool.count < sim->bulletPool.capacity) {
+        Vector2 p = RandomPoint(sim, SCREEN_HEIGHT - 60, SCREEN_HEIGHT);
+        p.x = SimRandomFloat(sim, 60, SCREEN_WIDTH);    // Keep clear of the parked player
+        SimShootBullet(sim, p, (Vector2){ 0, -500.0f }, (Color){ 0, 200, 255, 255 });
+    }
+}
+
+static void FillBarrage(Simulation *sim) {
+    TopUpBarrage(sim);
+    // Spread the first wave of bullets over the whole height
+    for (int j = 0; j < sim->bulletPool.count; j++) {
+        sim->bullets[j].position.y = sim->bullets[j].prev_position.y = SimRandomFloat(sim, 0, SCREEN_HEIGHT);
+    }
+}
+
+static const Scenario scenarios[] = {
+    { "drift",   "10k enemies drifting in the sine wave",
+      { 50, 10000, 100, 200, 0, SCREEN_HEIGHT },      FillDrift,   TopUpDrift },
+    { "storm",   "100k-particle explosion storm",
+      { 50, 20, 100, 100000, 0, SCREEN_HEIGHT },      FillStorm,   TopUpStorm },
+    { "barrage", "5k bullets vs 1k strong enemies",
+      { 5000, 1000, 100, 20000, 0, SCREEN_HEIGHT },   FillBarrage, TopUpBarrage },
+};
+
+#define SCENARIO_COUNT (int)(sizeof(scenarios) / sizeof(scenarios[0]))
+
+// =====================================================================
+// MEASURING
+// =====================================================================
+
+// Subsystems reported, with the entity count each one is divided by
+typedef enum { COUNT_NONE, COUNT_BULLETS, COUNT_ENEMIES, COUNT_PARTICLES } EntityKind;
+
+typedef struct {
+    const char *zone;
+    EntityKind  entities;
+} Subsystem;
+
+static const Subsystem subsystems[] = {
+    { "Tick",      COUNT_NONE },        // The whole SimStep
+    { "Bullets",   COUNT_BULLETS },
+    { "EnemyMove", COUNT_ENEMIES },
+    { "Collision", COUNT_ENEMIES },
+    { "Particles", COUNT_PARTICLES },
+    { "Spawn",     COUNT_NONE },        // Scenario top-up, not part of the tick
+    { "Snapshot",  COUNT_NONE },        // Rewind capture after the tick
+};
+
+#define SUBSYSTEM_COUNT (int)(sizeof(subsystems) / sizeof(subsystems[0]))
+
+typedef struct {
+    char   key[64];         // "scenario/subsystem"
+    double nsPerTick;
+    double nsPerEntity;     // 0 when the subsystem has no entity count
+} Result;
+
+static Result results[MAX_RESULTS];
+static int resultCount = 0;
+
+static Simulation sim;
+static SnapshotRing history;
+static int rewindFailures = 0;
+
+static double Entities(EntityKind kind, const double sums[]) {
+    return kind == COUNT_NONE ? 0.0 : sums[kind] / MEASURE_TICKS;
+}
+
+static void RunScenario(const Scenario *scenario, JobSystem *jobs) {
+    if (!SimCreate(&sim, &scenario->config)) {
+        fprintf(stderr, "%s: out of memory\n", scenario->name);
+        return;
+    }
+    if (!SnapshotRingCreate(&history, &scenario->config, SNAPSHOT_DEFAULT_BYTES, SNAPSHOT_DEFAULT_ENTRIES)) {
+        fprintf(stderr, "%s: out of memory for snapshots\n", scenario->name);
+        SimDestroy(&sim);
+        return;
+    }
+    sim.jobs = jobs;
+    SimInit(&sim, 20240601);
+    scenario->fill(&sim);
+
+    double best[SUBSYSTEM_COUNT];
+    double entities[SUBSYSTEM_COUNT] = { 0 };
+    for (int s = 0; s < SUBSYSTEM_COUNT; s++) best[s] = -1;
+
+    SimInput idle = { 0 };
+    const float dt = 1.0f / SIM_TICK_RATE;
+    for (int t = 0; t < WARMUP_TICKS; t++) {
+        scenario->topUp(&sim);
+        SimStep(&sim, idle, dt);
+    }
+
+    size_t snapshotBytes = 0, rawBytes = 0;
+    unsigned int checksums[MEASURE_TICKS];
+    for (int rep = 0; rep < REPETITIONS; rep++) {
+        double sums[COUNT_PARTICLES + 1] = { 0 };
+        ProfilerReset();
+        for (int t = 0; t < MEASURE_TICKS; t++) {
+            PROFILE_FRAME_BEGIN();
+            PROFILE_BEGIN("Spawn");
+            scenario->topUp(&sim);
+            PROFILE_END();
+
+            sums[COUNT_BULLETS] += sim.bulletPool.count;
+            sums[COUNT_ENEMIES] += sim.enemyPool.count;
+            sums[COUNT_PARTICLES] += sim.particles.slots.count;
+
+            PROFILE_BEGIN("Tick");
+            SimStep(&sim, idle, dt);
+            PROFILE_END();
+            PROFILE_BEGIN("Snapshot");
+            SnapshotCapture(&history, &sim);
+            PROFILE_END();
+            PROFILE_FRAME_END();
+
+            snapshotBytes += history.last.bytes;
+            rawBytes += history.last.rawBytes;
+            checksums[t] = SimChecksum(&sim);
+        }
+
+        int tick = ProfilerFindZone("Tick", -1);
+        for (int s = 0; s < SUBSYSTEM_COUNT; s++) {
+            bool topLevel = s == 0 || strcmp(subsystems[s].zone, "Spawn") == 0 || strcmp(subsystems[s].zone, "Snapshot") == 0;
+            int parent = topLevel ? -1 : tick;
+            double ns = ProfilerZoneTotal(ProfilerFindZone(subsystems[s].zone, parent)) * 1e9 / MEASURE_TICKS;
+            if (best[s] < 0 || ns < best[s]) {
+                best[s] = ns;
+                entities[s] = Entities(subsystems[s].entities, sums);
+            }
+        }
+    }
+
+    printf("\n%s: %s\n", scenario->name, scenario->description);
+    printf("  %-10s %14s %12s %12s\n", "subsystem", "ns/tick", "entities", "ns/entity");
+    for (int s = 0; s < SUBSYSTEM_COUNT && resultCount < MAX_RESULTS; s++) {
+        Result *r = &results[resultCount++];
+        snprintf(r->key, sizeof(r->key), "%s/%s", scenario->name, subsystems[s].zone);
+        r->nsPerTick = best[s];
+        r->nsPerEntity = entities[s] >= 1 ? best[s] / entities[s] : 0.0;
+        if (entities[s] >= 1)
+            printf("  %-10s %14.0f %12.0f %12.2f\n", subsystems[s].zone, r->nsPerTick, entities[s], r->nsPerEntity);
+        else
+            printf("  %-10s %14.0f %12s %12s\n", subsystems[s].zone, r->nsPerTick, "-", "-");
+    }
+
+    // Snapshot cost against the 60 Hz tick budget, and a rewind that must land on
+    // exactly the state recorded at that tick
+    const double captures = (double)REPETITIONS * MEASURE_TICKS;
+    const double budgetNs = 1e9 / SIM_TICK_RATE;
+    double snapshotNs = best[SUBSYSTEM_COUNT - 1];     // "Snapshot" is the last subsystem
+    int back = SnapshotRewind(&history, &sim, REWIND_CHECK_TICKS);
+    bool rewound = SimChecksum(&sim) == checksums[MEASURE_TICKS - 1 - back];
+    rewindFailures += !rewound;
+    printf("  snapshots: %.0f bytes of %.0f (%.0f%%), %.1f us = %.2f%% of the tick budget, rewind %d: %s\n",
+           snapshotBytes / captures, rawBytes / captures, rawBytes > 0 ? snapshotBytes * 100.0 / rawBytes : 0.0,
+           snapshotNs / 1e3, snapshotNs * 100.0 / budgetNs, back, rewound ? "ok" : "MISMATCH");
+
+    SnapshotRingDestroy(&history);
+    SimDestroy(&sim);
+}
+
+// =====================================================================
+// BASELINE
+// =====================================================================
+// A flat JSON object: { "threshold_percent": 15, "ns_per_tick": { "drift/Tick": 123, ... } }
+// Only "key": number pairs are looked at, which is all this file ever holds.
+
+static char *ReadFile(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = malloc((size_t)size + 1);
+    if (text && fread(text, 1, (size_t)size, file) != (size_t)size) {
+        free(text);
+        text = NULL;
+    }
+    if (text) text[size] = '\0';
+    fclose(file);
+    return text;
+}
+
+// Value of "key": number, or -1 if the key isn't there
+static double JsonNumber(const char *json, const char *key) {
+    char quoted[80];
+    snprintf(quoted, sizeof(quoted), "\"%s\"", key);
+    const char *p = strstr(json, quoted);
+    if (!p) return -1;
+    p += strlen(quoted);
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    if (*p != ':') return -1;
+    return strtod(p + 1, NULL);
+}
+
+static bool WriteBaseline(const char *path, double threshold) {
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "{\n  \"threshold_percent\": %.1f,\n  \"ns_per_tick\": {\n", threshold);
+    for (int r = 0; r < resultCount; r++) {
+        fprintf(file, "    \"%s\": %.0f%s\n", results[r].key, results[r].nsPerTick,
+                r + 1 < resultCount ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+    return true;
+}
+
+// Returns the number of regressions
+static int CompareBaseline(const char *json, double threshold) {
+    int regressions = 0;
+    printf("\n%-22s %12s %12s %8s\n", "vs baseline", "baseline", "now", "change");
+    for (int r = 0; r < resultCount; r++) {
+        double base = JsonNumber(json, results[r].key);
+        if (base < 0) {
+            printf("%-22s %12s %12.0f %8s\n", results[r].key, "-", results[r].nsPerTick, "new");
+            continue;
+        }
+        double change = base > 0 ? (results[r].nsPerTick - base) * 100.0 / base : 0.0;
+        bool regressed = change > threshold && results[r].nsPerTick > NOISE_FLOOR_NS;
+        regressions += regressed;
+        printf("%-22s %12.0f %12.0f %+7.1f%%%s\n", results[r].key, base, results[r].nsPerTick,
+               change, regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+// Returns the value part of "--name=value", or NULL if arg is not that flag
+static const char *FlagValue(const char *arg, const char *name) {
+    size_t len = strlen(name);
+    if (strncmp(arg, name, len) == 0 && arg[len] == '=') return arg + len + 1;
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    const char *baselinePath = BASELINE_FILE;
+    const char *writePath = NULL;
+    const char *only = NULL;
+    double threshold = -1;
+    int threads = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if ((v = FlagValue(argv[i], "--baseline"))) baselinePath = v;
+        else if ((v = FlagValue(argv[i], "--write-baseline"))) writePath = v;
+        else if ((v = FlagValue(argv[i], "--threshold"))) threshold = atof(v);
+        else if ((v = FlagValue(argv[i], "--scenario"))) only = v;
+        else if ((v = FlagValue(argv[i], "--threads"))) threads = atoi(v);
+        else {
+            fprintf(stderr, "usage: %s [--baseline=FILE] [--write-baseline=FILE] [--threshold=PERCENT]\n"
+                            "       [--scenario=NAME] [--threads=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    JobSystem *jobs = JobSystemCreate(threads);
+    printf("particle kernel: %s, threads: %d\n", ParticleKernelName(), JobSystemThreadCount(jobs));
+    for (int s = 0; s < SCENARIO_COUNT; s++) {
+        if (!only || strcmp(only, scenarios[s].name) == 0) RunScenario(&scenarios[s], jobs);
+    }
+    JobSystemDestroy(jobs);
+
+    if (writePath) {
+        if (!WriteBaseline(writePath, threshold < 0 ? DEFAULT_THRESHOLD : threshold)) {
+            fprintf(stderr, "can't write %s\n", writePath);
+            return 1;
+        }
+        printf("\nbaseline written to %s\n", writePath);
+        return rewindFailures > 0 ? 1 : 0;
+    }
+
+    char *json = ReadFile(baselinePath);
+    if (!json) {
+        printf("\nno baseline at %s (create one with --write-baseline=%s)\n", baselinePath, baselinePath);
+        return rewindFailures > 0 ? 1 : 0;
+    }
+    if (threshold < 0) threshold = JsonNumber(json, "threshold_percent");
+    if (threshold < 0) threshold = DEFAULT_THRESHOLD;
+
+    int regressions = CompareBaseline(json, threshold);
+    free(json);
+    printf("\n%d regression%s over %.1f%%\n", regressions, regressions == 1 ? "" : "s", threshold);
+    if (rewindFailures > 0) printf("%d snapshot rewind%s didn't match\n", rewindFailures, rewindFailures == 1 ? "" : "s");
+    return regressions > 0 || rewindFailures > 0 ? 1 : 0;
+}
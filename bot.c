@@ -0,0 +1,77 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - BOT PILOT
+*
+*   See bot.h for the rules it plays by.
+*
+********************************************************************************************/
+
+#include "bot.h"
+#include <math.h>
+
+// What to do, looking at the field right now
+static SimInput Decide(const Simulation *sim) {
+    const Player *player = &sim->player;
+    SimInput input = { INPUT_FIRE };
+    if (!player->active) return input;
+
+    Vector2 p = player->position;
+    float shipTop = p.y - player->size.y / 2;
+    float shipBottom = p.y + player->size.y / 2;
+
+    // The threat is the enemy that reaches the ship's height first while in its
+    // column; the target is the lowest enemy still above the ship
+    int threat = -1, target = -1;
+    float soonest = BOT_LOOKAHEAD, lowest = -INFINITY;
+    for (int i = 0; i < sim->enemyPool.count; i++) {
+        const Enemy *e = &sim->enemies[i];
+        if (e->position.y - e->size.y / 2 > shipBottom) continue;  // Already gone past
+
+        float gap = shipTop - (e->position.y + e->size.y / 2);
+        float reach = gap > 0 ? gap / e->speed : 0.0f;
+        float clearance = (e->size.x + player->size.x) / 2 + BOT_MARGIN;
+        if (reach < soonest && fabsf(e->position.x - p.x) < clearance) {
+            soonest = reach;
+            threat = i;
+        }
+        if (e->position.y < p.y && e->position.y > lowest) {
+            lowest = e->position.y;
+            target = i;
+        }
+    }
+
+    float goalX = p.x;
+    if (threat >= 0) {
+        // Step aside to the nearer side of it that is still on screen
+        const Enemy *e = &sim->enemies[threat];
+        float clearance = (e->size.x + player->size.x) / 2 + BOT_MARGIN;
+        float left = e->position.x - clearance, right = e->position.x + clearance;
+        bool leftFits = left >= player->size.x / 2;
+        bool rightFits = right <= SCREEN_WIDTH - player->size.x / 2;
+        goalX = (rightFits && (!leftFits || right - p.x < p.x - left)) ? right : left;
+    } else if (target >= 0) {
+        goalX = sim->enemies[target].position.x;
+    }
+
+    if (goalX < p.x - BOT_DEADZONE) input.buttons |= INPUT_LEFT;
+    else if (goalX > p.x + BOT_DEADZONE) input.buttons |= INPUT_RIGHT;
+
+    float homeY = sim->config.worldHeight - 80.0f;     // Where SimInit puts the ship
+    if (p.y < homeY - BOT_DEADZONE) input.buttons |= INPUT_DOWN;
+    else if (p.y > homeY + BOT_DEADZONE) input.buttons |= INPUT_UP;
+    return input;
+}
+
+void BotInit(Bot *bot, float reaction, float dt) {
+    bot->reactionTicks = (int)(reaction / dt + 0.5f);
+    bot->wait = 0;
+    bot->held = (SimInput){ 0 };
+}
+
+SimInput BotInput(Bot *bot, const Simulation *sim) {
+    if (bot->wait-- <= 0) {
+        bot->held = Decide(sim);
+        bot->wait = bot->reactionTicks - 1;
+    }
+    return bot->held;
+}
@@ -0,0 +1,44 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - BOT PILOT
+*
+*   A computer player for testing the game's balance. It sees what a human sees
+*   (where the player and the enemies are) and answers with the same SimInput
+*   buttons a keyboard would produce, so it plays by exactly the same rules:
+*
+*     - always fire,
+*     - if an enemy will reach the ship within the next moment, move out of its way,
+*     - otherwise line up under the enemy closest to the bottom of the screen,
+*     - and drift back to the starting height.
+*
+*   Like a person it needs time to react: it looks at the field every `reaction`
+*   seconds and holds the same buttons in between. Without that it never gets hit
+*   and the games say nothing about the difficulty. It has no randomness, so a
+*   bot game is as repeatable as its seed. Pure C, no raylib.
+*
+********************************************************************************************/
+
+#ifndef BOT_H
+#define BOT_H
+
+#include "sim.h"
+
+#define BOT_REACTION    0.2f    // Default seconds between looks, about a person's
+#define BOT_LOOKAHEAD   0.6f    // Seconds ahead an enemy counts as a threat
+#define BOT_MARGIN      12.0f   // Extra room kept on each side of the ship
+#define BOT_DEADZONE    4.0f    // Close enough to the target, stop moving
+
+typedef struct {
+    int      reactionTicks;
+    int      wait;              // Ticks until the next look
+    SimInput held;              // Buttons until then
+} Bot;
+
+// Get ready for a new game that steps dt seconds per tick (reaction is in
+// seconds, so the bot reacts as fast at any tick rate)
+void BotInit(Bot *bot, float reaction, float dt);
+
+// The buttons the bot holds for the next tick
+SimInput BotInput(Bot *bot, const Simulation *sim);
+
+#endif // BOT_H
@@ -0,0 +1,99 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - STARTUP CONFIGURATION
+*
+*   See config.h for the file format.
+*
+********************************************************************************************/
+
+#include "config.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Large enough for any sensible game, small enough that sizes can't overflow
+#define CONFIG_MAX_CAPACITY (1 << 24)
+
+typedef struct {
+    const char *key;        // File key; the flag is the same with '-' for '_'
+    size_t      offset;     // Where the value goes in SimConfig
+} ConfigKey;
+
+static const ConfigKey configKeys[] = {
+    { "max_bullets",   offsetof(SimConfig, maxBullets) },
+    { "max_enemies",   offsetof(SimConfig, maxEnemies) },
+    { "max_stars",     offsetof(SimConfig, maxStars) },
+    { "max_particles", offsetof(SimConfig, maxParticles) },
+    { "max_frozen_enemies", offsetof(SimConfig, maxFrozenEnemies) },
+    { "world_height",  offsetof(SimConfig, worldHeight) },
+};
+
+#define CONFIG_KEY_COUNT (int)(sizeof(configKeys) / sizeof(configKeys[0]))
+
+// Set key to value. Returns false (and leaves config alone) for unknown
+// keys and values that are not a number in [0, CONFIG_MAX_CAPACITY].
+static bool SetValue(SimConfig *config, const char *key, const char *value) {
+    for (int k = 0; k < CONFIG_KEY_COUNT; k++) {
+        if (strcmp(key, configKeys[k].key) != 0) continue;
+
+        char *end;
+        long n = strtol(value, &end, 10);
+        while (isspace((unsigned char)*end)) end++;
+        if (end == value || *end != '\0' || n < 0 || n > CONFIG_MAX_CAPACITY) return false;
+        *(int *)((char *)config + configKeys[k].offset) = (int)n;
+        return true;
+    }
+    return false;
+}
+
+static char *Trim(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return s;
+}
+
+bool ConfigLoadFile(SimConfig *config, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[256];
+    for (int lineNumber = 1; fgets(line, sizeof(line), file); lineNumber++) {
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        char *text = Trim(line);
+        if (*text == '\0') continue;
+
+        char *equals = strchr(text, '=');
+        if (equals) *equals = '\0';
+        if (!equals || !SetValue(config, Trim(text), Trim(equals + 1)))
+            fprintf(stderr, "%s:%d: ignoring bad line\n", path, lineNumber);
+    }
+    fclose(file);
+    return true;
+}
+
+bool ConfigParseFlag(SimConfig *config, const char *arg) {
+    if (strncmp(arg, "--config=", 9) == 0) {
+        if (!ConfigLoadFile(config, arg + 9)) fprintf(stderr, "can't read config file %s\n", arg + 9);
+        return true;
+    }
+    if (strncmp(arg, "--", 2) != 0) return false;
+
+    // --max-bullets=N becomes max_bullets / N
+    char key[32];
+    const char *equals = strchr(arg, '=');
+    size_t len = equals ? (size_t)(equals - arg - 2) : 0;
+    if (!equals || len >= sizeof(key)) return false;
+    for (size_t i = 0; i < len; i++) key[i] = arg[2 + i] == '-' ? '_' : arg[2 + i];
+    key[len] = '\0';
+
+    for (int k = 0; k < CONFIG_KEY_COUNT; k++) {
+        if (strcmp(key, configKeys[k].key) != 0) continue;
+        if (!SetValue(config, key, equals + 1)) fprintf(stderr, "bad value in %s\n", arg);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,37 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - STARTUP CONFIGURATION
+*
+*   Entity capacities and the world's size (see SimConfig in sim.h) come from a
+*   small text file and/or command line flags, so memory can be traded against
+*   load without recompiling:
+*
+*     # space_shooter.cfg
+*     max_bullets   = 50
+*     max_enemies   = 20
+*     max_stars     = 100
+*     max_particles = 200
+*     max_frozen_enemies = 256
+*     world_height  = 600         # Pixels; more than one screen scrolls
+*
+*   The same keys work as flags: --max-bullets=500. --config=FILE loads a file;
+*   whatever comes later on the command line wins.
+*
+********************************************************************************************/
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "sim.h"
+
+#define CONFIG_DEFAULT_FILE "space_shooter.cfg"
+
+// Read "key = value" lines into config ('#' starts a comment). Returns false if
+// the file can't be opened; bad lines are reported on stderr and skipped.
+bool ConfigLoadFile(SimConfig *config, const char *path);
+
+// Handle one of the config flags (or --config=FILE). Returns false if arg
+// isn't one of them, so callers can go on with their own flags.
+bool ConfigParseFlag(SimConfig *config, const char *arg);
+
+#endif // CONFIG_H
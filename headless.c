@@ -0,0 +1,429 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - HEADLESS TICK BENCHMARK
+*
+*   Runs the simulation core (sim.c) for N ticks without opening a window and reports
+*   how many ticks per second this machine can simulate. A simple scripted pilot
+*   weaves left and right while holding fire; when it dies a new game starts with
+*   the next seed, so the benchmark always measures live gameplay. What happened
+*   is tallied from the simulation's gameplay events (hits, kills, damage).
+*
+*   --threads=1,2,4,8 runs the same benchmark once per thread count (see jobs.h),
+*   prints the speedup over the first one and checks that every run ended in exactly
+*   the same game state. The default capacities are far too small for threads to
+*   help; raise them (see config.h) and keep the particle pool topped up with
+*   --particles=N to see a difference:
+*     ./headless --ticks=2000 --max-enemies=5000 --max-particles=200000 \
+*                --particles=200000 --threads=1,2,4,8
+*
+*   With --render-stats every tick is also turned into a frame through the render
+*   queue (scene.c), without a GPU, and the average number of draw commands, batches
+*   (= draw calls) and vertices per frame is reported. Scene building is timed
+*   separately so the tick rate above still measures the simulation alone. Before
+*   that, a small known scene is sorted and batched and checked against the
+*   expected order and batches; headless exits with 1 if it doesn't match.
+*   --quality=N builds those frames (and sizes particle bursts) at quality level N
+*   (quality.h); the games played must come out exactly the same at every level.
+*   The player and enemies are sprites from the atlas layout (sprites.h), like in
+*   the game; --no-atlas builds their shapes instead, to compare.
+*
+*   Built with -DENABLE_PROFILER, every tick is one profiler frame: a table of the
+*   zones (see profiler.h) is printed at the end, and --trace=FILE / --profile-csv=FILE
+*   record the first run as a Chrome trace and a per-frame CSV.
+*
+*   --record=FILE saves the first game of the first run as a replay (replay.h), which
+*   replayer can simulate again and check tick for tick.
+*
+*   A world taller than the screen (--world-height=PIXELS, see sim.h) is only simulated
+*   near the view. --world-enemies=N fills it with N enemies at the start of every game,
+*   and --climb makes the pilot fly up through it instead of staying near the bottom:
+*   the tick rate should hardly depend on N.
+*     ./headless --world-height=60000 --max-frozen-enemies=100000 --world-enemies=100000 --climb
+*
+*   How full the pools got, and how many spawns they had to drop, is counted over every
+*   game (stats_feed.h). --stats-feed also publishes those counts every tick into shared
+*   memory, for statsmon to watch while the benchmark runs.
+*
+*   To compile:
+*     gcc headless.c sim.c particles.c jobs.c config.c render_queue.c scene.c sprites.c profiler.c \
+*         replay.c quality.c stats_feed.c -O2 -o headless -lm -lpthread
+*
+*   Usage:
+*     ./headless [--ticks=N] [--seed=N] [--dt=SECONDS] [--threads=N[,N...]]
+*                [--particles=N] [--render-stats] [--config=FILE] [--max-bullets=N ...]
+*                [--trace=FILE] [--profile-csv=FILE] [--record=FILE] [--quality=N] [--no-atlas]
+*                [--stats-feed] [--world-enemies=N] [--climb]
+*
+********************************************************************************************/
+
+#include "sim.h"
+#include "config.h"
+#include "profiler.h"
+#include "timer.h"
+#include "render_queue.h"
+#include "scene.h"
+#include "replay.h"
+#include "quality.h"
+#include "stats_feed.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_THREAD_RUNS 16
+
+typedef struct {
+    long         ticks;
+    unsigned int seed;
+    float        dt;
+    int          particles;     // Keep at least this many particles alive (0: off)
+    bool         renderStats;
+    const char  *tracePath;     // Profiler capture (ENABLE_PROFILER builds only)
+    const char  *csvPath;
+    const char  *recordPath;    // Replay of the first game (NULL: none)
+    int          quality;       // QualityLevel for particles and scene building
+    const SpriteAtlas *atlas;   // Sprites for the scene (NULL: shapes)
+    StatsFeed  *feed;           // Where every tick's pool counts go (NULL: nowhere)
+    int          worldEnemies;  // Enemies spread over the world at the start of every game
+    bool         climb;         // The pilot holds UP
+} BenchConfig;
+
+typedef struct {
+    double       elapsed;       // SimStep only, not the stress top-up, populating or scene building
+    int          games;
+    long         bestScore;
+    int          score;         // Final state, to check runs against each other
+    unsigned int rngState;
+    int          liveParticles;
+    long         events[SIM_EVENT_TYPE_COUNT];  // Totals over every game
+    StatsRecord  pools;         // Pool counts after the last tick, over every game
+} BenchResult;
+
+static Simulation sim;
+static ReplayWriter recorder;
+
+// Returns the value part of "--name=value", or NULL if arg is not that flag
+static const char *FlagValue(const char *arg, const char *name) {
+    size_t len = strlen(name);
+    if (strncmp(arg, name, len) == 0 && arg[len] == '=') return arg + len + 1;
+    return NULL;
+}
+
+// Scripted pilot: sweep across the screen and keep firing (and climb, if asked)
+static SimInput ScriptedInput(long tick, bool climb) {
+    SimInput input = { INPUT_FIRE };
+    input.buttons |= ((tick / 90) % 2 == 0) ? INPUT_LEFT : INPUT_RIGHT;
+    if (climb) input.buttons |= INPUT_UP;
+    else if ((tick / 240) % 4 == 1) input.buttons |= INPUT_UP;
+    else if ((tick / 240) % 4 == 3) input.buttons |= INPUT_DOWN;
+    return input;
+}
+
+// Stress load: top the particle pool up with bursts all over the view
+static void TopUpParticles(Simulation *s, int target) {
+    float top = s->world.viewTop;
+    while (s->particles.slots.count < target && s->particles.slots.count < s->particles.slots.capacity) {
+        Vector2 p = { SimRandomFloat(s, 0, SCREEN_WIDTH), SimRandomFloat(s, top, top + SCREEN_HEIGHT) };
+        SimSpawnParticles(s, p, (Color){ 255, 160, 50, 255 }, 256);
+    }
+}
+
+// The render queue's sorting and batching, checked without a GPU: a known mix of
+// layers and blend modes must come out in layer order (submission order inside
+// a layer, whatever the blend) and merge into the expected batches
+static bool CheckRenderQueue(void) {
+    static const struct { RenderLayer layer; RenderBlend blend; } pushes[] = {
+        { LAYER_PARTICLES, RENDER_BLEND_ADDITIVE },     // 0
+        { LAYER_BULLETS,   RENDER_BLEND_ALPHA },        // 1
+        { LAYER_ENEMIES,   RENDER_BLEND_ALPHA },        // 2
+        { LAYER_PARTICLES, RENDER_BLEND_ALPHA },        // 3
+        { LAYER_BULLETS,   RENDER_BLEND_ADDITIVE },     // 4
+        { LAYER_PLAYER,    RENDER_BLEND_ALPHA },        // 5
+        { LAYER_BULLETS,   RENDER_BLEND_ALPHA },        // 6
+    };
+    enum { PUSHES = sizeof(pushes) / sizeof(pushes[0]) };
+    static const int expectedOrder[PUSHES] = { 1, 4, 6, 2, 5, 0, 3 };
+    static const RenderBatch expectedBatches[] = {
+        { 0, 1, 3, RENDER_BLEND_ALPHA },        // Bullets
+        { 1, 1, 3, RENDER_BLEND_ADDITIVE },     // Bullets
+        { 2, 3, 9, RENDER_BLEND_ALPHA },        // Last bullet, enemies and player together
+        { 5, 1, 3, RENDER_BLEND_ADDITIVE },     // Particles
+        { 6, 1, 3, RENDER_BLEND_ALPHA },        // Particles
+    };
+    enum { BATCHES = sizeof(expectedBatches) / sizeof(expectedBatches[0]) };
+
+    RenderCommand commands[PUSHES];
+    int order[PUSHES];
+    RenderQueue queue;
+    RenderQueueInit(&queue, commands, order, PUSHES);
+    RenderQueueBegin(&queue);
+    for (int i = 0; i < PUSHES; i++) {
+        RenderQueueSetLayer(&queue, pushes[i].layer, pushes[i].blend);
+        RenderPushTriangle(&queue, (Vector2){ 0, 0 }, (Vector2){ 1, 0 }, (Vector2){ 0, 1 }, (Color){ 255, 255, 255, 255 });
+    }
+    RenderQueueSort(&queue);
+
+    bool ok = queue.stats.commands == PUSHES && queue.stats.vertices == 3 * PUSHES &&
+              queue.stats.dropped == 0 && queue.batchCount == BATCHES;
+    for (int k = 0; ok && k < PUSHES; k++) ok = queue.order[k] == expectedOrder[k];
+    for (int b = 0; ok && b < BATCHES; b++) {
+        const RenderBatch *got = &queue.batches[b], *want = &expectedBatches[b];
+        ok = got->first == want->first && got->count == want->count &&
+             got->vertices == want->vertices && got->blend == want->blend;
+    }
+    return ok;
+}
+
+// A populated world: enemies all over it, most of them far from the view,
+// where they wait frozen until the pilot gets near
+static void PopulateWorld(Simulation *s, int count) {
+    for (int i = 0; i < count; i++) {
+        Vector2 p = { SimRandomFloat(s, 40, SCREEN_WIDTH - 40), SimRandomFloat(s, 0, (float)s->config.worldHeight) };
+        SimSpawnEnemyType(s, (EnemyType)SimRandomInt(s, 0, ENEMY_TYPE_COUNT - 1), p);
+    }
+}
+
+static BenchResult RunBenchmark(const BenchConfig *config, JobSystem *jobs) {
+    static RenderCommand commands[16384];
+    static int order[16384];
+    RenderQueue queue;
+    RenderQueueInit(&queue, commands, order, 16384);
+    RenderQueueStats totals = { 0 };
+    int peakCommands = 0;
+    double buildTime = 0.0;
+    double topUpTime = 0.0;
+
+    BenchResult result = { 0 };
+    StatsCounter stats;
+    StatsCounterInit(&stats);
+    sim.jobs = jobs;
+    SimInit(&sim, config->seed);
+    PopulateWorld(&sim, config->worldEnemies);
+    result.games = 1;
+    if (config->recordPath) {
+        ReplayHeader header = ReplayHeaderFor(&sim, config->seed, config->dt);
+        if (!ReplayWriterOpen(&recorder, config->recordPath, &header))
+            fprintf(stderr, "can't write %s\n", config->recordPath);
+    }
+
+    double start = TimerNow();
+    for (long t = 0; t < config->ticks; t++) {
+        PROFILE_FRAME_BEGIN();
+        if (config->particles > 0) {
+            double topUpStart = TimerNow();
+            TopUpParticles(&sim, config->particles);
+            topUpTime += TimerNow() - topUpStart;
+        }
+        SimInput input = ScriptedInput(t, config->climb);
+        bool alive = SimStep(&sim, input, config->dt);
+        for (int e = 0; e < sim.events.count; e++) result.events[sim.events.items[e].type]++;
+        if (recorder.file) {
+            ReplayWriterTick(&recorder, input, &sim);
+            if (!alive) ReplayWriterClose(&recorder, &sim);
+        }
+        if (!alive) {
+            if (sim.player.score > result.bestScore) result.bestScore = sim.player.score;
+            SimInit(&sim, config->seed + (unsigned int)result.games);
+            double topUpStart = TimerNow();
+            PopulateWorld(&sim, config->worldEnemies);
+            topUpTime += TimerNow() - topUpStart;
+            result.games++;
+        }
+        StatsCounterTick(&stats, &sim, (uint32_t)result.games, TimerNow());
+        if (config->feed) StatsFeedPublish(config->feed, &stats.record);
+        if (config->renderStats) {
+            double buildStart = TimerNow();
+            PROFILE_BEGIN("Scene");
+            RenderQueueBegin(&queue);
+            BuildGameScene(&queue, &sim, 1.0f, t * config->dt, &qualityLevels[config->quality], config->atlas);
+            RenderQueueSort(&queue);
+            PROFILE_END();
+            buildTime += TimerNow() - buildStart;
+
+            totals.commands += queue.stats.commands;
+            totals.batches += queue.stats.batches;
+            totals.vertices += queue.stats.vertices;
+            totals.dropped += queue.stats.dropped;
+            if (queue.stats.commands > peakCommands) peakCommands = queue.stats.commands;
+        }
+        PROFILE_FRAME_END();
+    }
+    result.elapsed = TimerNow() - start - buildTime - topUpTime;
+    if (recorder.file) ReplayWriterClose(&recorder, &sim);     // Still alive at the last tick
+
+    if (sim.player.score > result.bestScore) result.bestScore = sim.player.score;
+    result.score = sim.player.score;
+    result.rngState = sim.rngState;
+    result.liveParticles = sim.particles.slots.count;
+    result.pools = stats.record;
+
+    if (config->renderStats && config->ticks > 0) {
+        // Before the queue every command was its own Draw*() call
+        printf("render:       %.1f commands, %.2f batches, %.0f vertices per frame (peak %d commands, %d dropped)\n",
+               (double)totals.commands / config->ticks, (double)totals.batches / config->ticks,
+               (double)totals.vertices / config->ticks, peakCommands, totals.dropped);
+        printf("scene build:  %.2f us per frame\n", buildTime * 1e6 / config->ticks);
+    }
+    return result;
+}
+
+#if defined(ENABLE_PROFILER)
+static void PrintProfile(void) {
+    printf("%-24s %9s %9s %9s %9s\n", "zone (us per tick)", "last", "min", "avg", "p99");
+    for (int z = 0; z < ProfilerZoneCount(); z++) {
+        ProfilerStats stats = ProfilerZoneStats(z);
+        printf("%*s%-*s %9.2f %9.2f %9.2f %9.2f\n", ProfilerZoneDepth(z) * 2, "",
+               24 - ProfilerZoneDepth(z) * 2, ProfilerZoneName(z),
+               stats.last * 1e3, stats.min * 1e3, stats.avg * 1e3, stats.p99 * 1e3);
+    }
+}
+#endif
+
+static bool SameResult(const BenchResult *a, const BenchResult *b) {
+    return a->games == b->games && a->bestScore == b->bestScore && a->score == b->score &&
+           a->rngState == b->rngState && a->liveParticles == b->liveParticles &&
+           memcmp(a->events, b->events, sizeof(a->events)) == 0 &&
+           memcmp(a->pools.pools, b->pools.pools, sizeof(a->pools.pools)) == 0;
+}
+
+int main(int argc, char **argv) {
+    BenchConfig config = { 1000000, 1, 1.0f / SIM_TICK_RATE, 0, false, NULL, NULL, NULL, QUALITY_HIGH, NULL, NULL, 0, false };
+    static SpriteAtlas atlas;
+    static StatsFeed feed;
+    bool useAtlas = true;
+    bool useFeed = false;
+    SimConfig simConfig = SimDefaultConfig();
+    int threadCounts[MAX_THREAD_RUNS] = { 1 };
+    int runs = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if (ConfigParseFlag(&simConfig, argv[i])) continue;
+        if ((v = FlagValue(argv[i], "--ticks"))) config.ticks = atol(v);
+        else if ((v = FlagValue(argv[i], "--seed"))) config.seed = (unsigned int)strtoul(v, NULL, 10);
+        else if ((v = FlagValue(argv[i], "--dt"))) config.dt = (float)atof(v);
+        else if ((v = FlagValue(argv[i], "--particles"))) config.particles = atoi(v);
+        else if ((v = FlagValue(argv[i], "--trace"))) config.tracePath = v;
+        else if ((v = FlagValue(argv[i], "--profile-csv"))) config.csvPath = v;
+        else if ((v = FlagValue(argv[i], "--record"))) config.recordPath = v;
+        else if ((v = FlagValue(argv[i], "--quality"))) config.quality = atoi(v);
+        else if ((v = FlagValue(argv[i], "--world-enemies"))) config.worldEnemies = atoi(v);
+        else if ((v = FlagValue(argv[i], "--threads"))) {
+            // Comma separated list, e.g. 1,2,4,8
+            for (runs = 0; *v && runs < MAX_THREAD_RUNS; runs++) {
+                char *next;
+                threadCounts[runs] = (int)strtol(v, &next, 10);
+                if (threadCounts[runs] < 1) threadCounts[runs] = 1;
+                v = (*next == ',') ? next + 1 : next;
+                if (next == v && *v) break;
+            }
+            if (runs == 0) runs = 1;
+        }
+        else if (strcmp(argv[i], "--render-stats") == 0) config.renderStats = true;
+        else if (strcmp(argv[i], "--no-atlas") == 0) useAtlas = false;
+        else if (strcmp(argv[i], "--stats-feed") == 0) useFeed = true;
+        else if (strcmp(argv[i], "--climb") == 0) config.climb = true;
+        else {
+            fprintf(stderr, "usage: %s [--ticks=N] [--seed=N] [--dt=SECONDS] [--threads=N[,N...]]\n"
+                            "       [--particles=N] [--render-stats] [--config=FILE] [--max-bullets=N ...]\n"
+                            "       [--trace=FILE] [--profile-csv=FILE] [--record=FILE] [--quality=N] [--no-atlas]\n"
+                            "       [--stats-feed] [--world-enemies=N] [--climb]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (config.recordPath && (config.particles > 0 || config.worldEnemies > 0)) {
+        // The top-up changes the game outside SimStep, so a replay couldn't follow it
+        fprintf(stderr, "--record can't be combined with --particles or --world-enemies\n");
+        return 1;
+    }
+
+    if (!SimCreate(&sim, &simConfig)) {
+        fprintf(stderr, "out of memory for %zu bytes\n", SimArenaSize(&simConfig));
+        return 1;
+    }
+    printf("capacities:   %d bullets, %d enemies, %d particles (%.1f KB arena)\n",
+           simConfig.maxBullets, simConfig.maxEnemies, simConfig.maxParticles,
+           SimArenaSize(&simConfig) / 1024.0);
+    printf("entity size:  %d B per bullet, %d B per enemy, %d B per particle\n",
+           (int)sizeof(Bullet), (int)sizeof(Enemy),
+           (int)(ParticlePoolArenaSize(1 << 16) >> 16));
+    if (sim.config.worldHeight > SCREEN_HEIGHT) {
+        printf("world:        %d px tall, %d chunks, room for %d frozen enemies\n",
+               sim.config.worldHeight, SimChunkCount(&sim.config), sim.config.maxFrozenEnemies);
+    }
+    if (config.quality < 0 || config.quality >= QUALITY_LEVEL_COUNT) config.quality = QUALITY_HIGH;
+    sim.particleScale = qualityLevels[config.quality].particleScale;
+    if (config.quality != QUALITY_HIGH) printf("quality:      %s\n", qualityLevels[config.quality].name);
+    if (config.renderStats && !CheckRenderQueue()) {
+        fprintf(stderr, "the render queue sorted or batched a known scene wrong\n");
+        return 1;
+    }
+    if (config.renderStats && useAtlas) {
+        if (!SpriteAtlasBuild(&atlas)) {
+            fprintf(stderr, "the sprite frames don't fit in the atlas\n");
+            return 1;
+        }
+        config.atlas = &atlas;
+        printf("atlas:        %d frames in %dx%d\n", atlas.frameCount, atlas.width, atlas.height);
+    }
+    if (useFeed) {
+        if (!StatsFeedCreate(&feed, STATS_FEED_NAME)) {
+            fprintf(stderr, "can't create the stats feed %s\n", STATS_FEED_NAME);
+            return 1;
+        }
+        config.feed = &feed;
+        printf("stats feed:   %s\n", STATS_FEED_NAME);
+    }
+
+#if defined(ENABLE_PROFILER)
+    if ((config.tracePath || config.csvPath) && !ProfilerStartCapture(config.tracePath, config.csvPath)) {
+        fprintf(stderr, "can't write the profiler capture\n");
+        return 1;
+    }
+#else
+    if (config.tracePath || config.csvPath)
+        fprintf(stderr, "--trace / --profile-csv need a build with -DENABLE_PROFILER\n");
+#endif
+
+    BenchResult first = { 0 };
+    for (int r = 0; r < runs; r++) {
+        JobSystem *jobs = JobSystemCreate(threadCounts[r]);
+        BenchResult result = RunBenchmark(&config, jobs);
+        config.recordPath = NULL;   // Only the first run is recorded
+        int threads = JobSystemThreadCount(jobs);
+        JobSystemDestroy(jobs);
+#if defined(ENABLE_PROFILER)
+        ProfilerStopCapture();  // Only the first run is recorded
+#endif
+
+        if (r == 0) first = result;
+        if (runs > 1) printf("--- %d thread%s ---\n", threads, threads == 1 ? "" : "s");
+        printf("ticks:        %ld\n", config.ticks);
+        printf("elapsed:      %.3f s\n", result.elapsed);
+        printf("ticks/second: %.0f\n", result.elapsed > 0 ? config.ticks / result.elapsed : 0.0);
+        printf("realtime:     %.0fx (at dt=%.4f)\n",
+               result.elapsed > 0 ? config.ticks * config.dt / result.elapsed : 0.0, config.dt);
+        printf("games:        %d (best score %ld)\n", result.games, result.bestScore);
+        printf("events:       %ld hits, %ld kills, %ld times damaged\n",
+               result.events[SIM_EVENT_BULLET_HIT], result.events[SIM_EVENT_ENEMY_KILLED],
+               result.events[SIM_EVENT_PLAYER_DAMAGED]);
+        for (int p = 0; p < STATS_POOL_COUNT; p++) {
+            const StatsPool *pool = &result.pools.pools[p];
+            printf("%-14s%-9s peak %6d of %-6d %lld of %lld spawns dropped\n", p == 0 ? "pools:" : "",
+                   statsPoolNames[p], pool->peak, pool->capacity, (long long)pool->dropped, (long long)pool->attempts);
+        }
+        if (r > 0) {
+            printf("speedup:      %.2fx over %d thread%s (%s result)\n",
+                   result.elapsed > 0 ? first.elapsed / result.elapsed : 0.0,
+                   threadCounts[0], threadCounts[0] == 1 ? "" : "s",
+                   SameResult(&first, &result) ? "same" : "DIFFERENT");
+        }
+#if defined(ENABLE_PROFILER)
+        PrintProfile();
+#endif
+    }
+
+    StatsFeedClose(&feed);
+    SimDestroy(&sim);
+    return 0;
+}
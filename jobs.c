@@ -0,0 +1,226 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - JOB SYSTEM
+*
+*   Each thread owns a deque of chunk numbers. Because a JobParallelFor knows all of
+*   its chunks up front, a deque is just a range [front, back) packed into one 64 bit
+*   atomic: the owner takes chunks from the front, thieves take them from the back,
+*   and both do it with a single compare-and-swap. No locks on the hot path; the
+*   mutex and condition variables are only used to wake workers up and to wait for
+*   the last of them.
+*
+********************************************************************************************/
+
+#include "jobs.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+// One per thread, padded to a cache line so stealing doesn't slow the owner down
+typedef struct {
+    atomic_ullong range;    // Low 32 bits: front, high 32 bits: back
+    char          pad[64 - sizeof(atomic_ullong)];
+} JobDeque;
+
+// What a worker thread gets when it starts
+typedef struct {
+    JobSystem *jobs;
+    int        index;
+} WorkerStart;
+
+struct JobSystem {
+    int             threadCount;
+    pthread_t       threads[JOB_MAX_THREADS];
+    JobDeque        deques[JOB_MAX_THREADS];
+    WorkerStart     starts[JOB_MAX_THREADS];
+
+    pthread_mutex_t mutex;
+    pthread_cond_t  wake;           // Workers wait here for the next JobParallelFor
+    pthread_cond_t  done;           // The caller waits here for the workers
+    unsigned int    generation;     // Bumped for every JobParallelFor
+    int             busyWorkers;    // Workers that haven't checked in yet
+    bool            quit;
+
+    // The JobParallelFor being run
+    JobFunc         func;
+    void           *context;
+    int             count;
+    int             chunkSize;
+};
+
+static unsigned long long PackRange(unsigned int front, unsigned int back) {
+    return ((unsigned long long)back << 32) | front;
+}
+
+// Owner side: next chunk from the front
+static bool TakeFront(JobDeque *deque, int *chunk) {
+    unsigned long long range = atomic_load(&deque->range);
+    for (;;) {
+        unsigned int front = (unsigned int)range, back = (unsigned int)(range >> 32);
+        if (front >= back) return false;
+        if (atomic_compare_exchange_weak(&deque->range, &range, PackRange(front + 1, back))) {
+            *chunk = (int)front;
+            return true;
+        }
+    }
+}
+
+// Thief side: last chunk from the back
+static bool TakeBack(JobDeque *deque, int *chunk) {
+    unsigned long long range = atomic_load(&deque->range);
+    for (;;) {
+        unsigned int front = (unsigned int)range, back = (unsigned int)(range >> 32);
+        if (front >= back) return false;
+        if (atomic_compare_exchange_weak(&deque->range, &range, PackRange(front, back - 1))) {
+            *chunk = (int)(back - 1);
+            return true;
+        }
+    }
+}
+
+static void RunChunk(JobSystem *jobs, int chunk) {
+    int begin = chunk * jobs->chunkSize;
+    int end = begin + jobs->chunkSize;
+    if (end > jobs->count) end = jobs->count;
+    jobs->func(jobs->context, begin, end);
+}
+
+// Work through our own chunks, then steal until every deque is empty.
+// No chunks are added during a JobParallelFor, so empty everywhere means done.
+static void RunChunks(JobSystem *jobs, int self) {
+    int chunk;
+    while (TakeFront(&jobs->deques[self], &chunk)) RunChunk(jobs, chunk);
+
+    for (int k = 1; k < jobs->threadCount; k++) {
+        JobDeque *victim = &jobs->deques[(self + k) % jobs->threadCount];
+        while (TakeBack(victim, &chunk)) RunChunk(jobs, chunk);
+    }
+}
+
+static void *WorkerMain(void *arg) {
+    WorkerStart *start = arg;
+    JobSystem *jobs = start->jobs;
+    unsigned int seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&jobs->mutex);
+        while (jobs->generation == seen && !jobs->quit) pthread_cond_wait(&jobs->wake, &jobs->mutex);
+        if (jobs->quit) {
+            pthread_mutex_unlock(&jobs->mutex);
+            return NULL;
+        }
+        seen = jobs->generation;
+        pthread_mutex_unlock(&jobs->mutex);
+
+        RunChunks(jobs, start->index);
+
+        pthread_mutex_lock(&jobs->mutex);
+        if (--jobs->busyWorkers == 0) pthread_cond_signal(&jobs->done);
+        pthread_mutex_unlock(&jobs->mutex);
+    }
+}
+
+JobSystem *JobSystemCreate(int threads) {
+    if (threads < 1) threads = 1;
+    if (threads > JOB_MAX_THREADS) threads = JOB_MAX_THREADS;
+
+    JobSystem *jobs = calloc(1, sizeof(*jobs));
+    if (!jobs) return NULL;
+    jobs->threadCount = threads;
+    pthread_mutex_init(&jobs->mutex, NULL);
+    pthread_cond_init(&jobs->wake, NULL);
+    pthread_cond_init(&jobs->done, NULL);
+
+    // Thread 0 is whoever calls JobParallelFor
+    for (int i = 1; i < threads; i++) {
+        jobs->starts[i] = (WorkerStart){ jobs, i };
+        if (pthread_create(&jobs->threads[i], NULL, WorkerMain, &jobs->starts[i]) != 0) {
+            jobs->threadCount = i;  // Make do with the threads we got
+            break;
+        }
+    }
+    return jobs;
+}
+
+void JobSystemDestroy(JobSystem *jobs) {
+    if (!jobs) return;
+    pthread_mutex_lock(&jobs->mutex);
+    jobs->quit = true;
+    pthread_cond_broadcast(&jobs->wake);
+    pthread_mutex_unlock(&jobs->mutex);
+
+    for (int i = 1; i < jobs->threadCount; i++) pthread_join(jobs->threads[i], NULL);
+    pthread_cond_destroy(&jobs->done);
+    pthread_cond_destroy(&jobs->wake);
+    pthread_mutex_destroy(&jobs->mutex);
+    free(jobs);
+}
+
+int JobSystemThreadCount(const JobSystem *jobs) {
+    return jobs ? jobs->threadCount : 1;
+}
+
+int JobSystemDefaultThreads(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int cores = (int)info.dwNumberOfProcessors;
+#else
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (cores < 1) cores = 1;
+    return cores > JOB_MAX_THREADS ? JOB_MAX_THREADS : cores;
+}
+
+void JobParallelFor(JobSystem *jobs, int count, int chunkSize, JobFunc func, void *context) {
+    if (count <= 0) return;
+    if (chunkSize < 1) chunkSize = 1;
+    if (!jobs || jobs->threadCount == 1 || count <= chunkSize) {
+        func(context, 0, count);
+        return;
+    }
+
+    jobs->func = func;
+    jobs->context = context;
+    jobs->count = count;
+    jobs->chunkSize = chunkSize;
+
+    // Deal the chunks out evenly; stealing sorts out the rest
+    int chunks = (count + chunkSize - 1) / chunkSize;
+    int threads = jobs->threadCount;
+    for (int t = 0; t < threads; t++) {
+        unsigned int front = (unsigned int)((long long)chunks * t / threads);
+        unsigned int back = (unsigned int)((long long)chunks * (t + 1) / threads);
+        atomic_store(&jobs->deques[t].range, PackRange(front, back));
+    }
+
+    pthread_mutex_lock(&jobs->mutex);
+    jobs->generation++;
+    jobs->busyWorkers = threads - 1;
+    pthread_cond_broadcast(&jobs->wake);
+    pthread_mutex_unlock(&jobs->mutex);
+
+    RunChunks(jobs, 0);
+
+    // Workers may still be in the middle of a stolen chunk
+    pthread_mutex_lock(&jobs->mutex);
+    while (jobs->busyWorkers > 0) pthread_cond_wait(&jobs->done, &jobs->mutex);
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+int JobAtomicAdd(int *target, int value) {
+    return atomic_fetch_add((_Atomic int *)target, value);
+}
+
+void JobAtomicMin(int *target, int value) {
+    _Atomic int *a = (_Atomic int *)target;
+    int current = atomic_load(a);
+    while (value < current && !atomic_compare_exchange_weak(a, &current, value)) { }
+}
@@ -0,0 +1,45 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - JOB SYSTEM
+*
+*   A small work-stealing thread pool for the simulation's big loops (particles,
+*   stars, bullet and enemy movement, collision detection). JobParallelFor cuts
+*   [0, count) into chunks and hands every thread, the caller included, its own
+*   share of them. A thread that runs out steals the remaining chunks of another
+*   one, so uneven chunks (a crowded corner of the screen) still finish together.
+*
+*   Jobs must only write to their own elements. Anything shared (counters, "lowest
+*   index wins" results) goes through JobAtomicAdd / JobAtomicMin, whose results do
+*   not depend on the order threads get there. That way a tick gives exactly the
+*   same result with 1 thread or 64.
+*
+*   Uses POSIX threads and C11 atomics (on Windows: MinGW's winpthreads).
+*
+********************************************************************************************/
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#define JOB_MAX_THREADS 64
+
+typedef struct JobSystem JobSystem;
+
+// Called with a range of element indices, [begin, end)
+typedef void (*JobFunc)(void *context, int begin, int end);
+
+// threads counts the calling thread too: 1 means no workers, everything inline
+JobSystem *JobSystemCreate(int threads);
+void       JobSystemDestroy(JobSystem *jobs);
+int        JobSystemThreadCount(const JobSystem *jobs);
+int        JobSystemDefaultThreads(void);  // Number of CPU cores
+
+// Run func over [0, count) in chunks of chunkSize and return when all are done.
+// With jobs == NULL, or when everything fits in one chunk, func runs inline.
+void JobParallelFor(JobSystem *jobs, int count, int chunkSize, JobFunc func, void *context);
+
+// Order independent updates of shared ints from inside jobs. JobAtomicAdd
+// returns the value before the add (e.g. to claim slots in a shared array).
+int  JobAtomicAdd(int *target, int value);
+void JobAtomicMin(int *target, int value);
+
+#endif // JOBS_H
@@ -0,0 +1,169 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - INPUT LATENCY
+*
+*   Clocks, the frame pacer and the latency histogram (see latency.h).
+*
+********************************************************************************************/
+
+#include "latency.h"
+#include "timer.h"
+
+#define LATENCY_ROW_BINS    2       // Bins per printed histogram row (1 ms)
+#define LATENCY_BAR         40      // Width of the longest histogram bar
+
+// =====================================================================
+// CLOCK
+// =====================================================================
+
+static double SystemNow(void *context) {
+    (void)context;
+    return TimerNow();
+}
+
+static void SystemSleepUntil(void *context, double time) {
+    (void)context;
+    TimerSleepUntil(time);
+}
+
+Clock ClockSystem(void) {
+    return (Clock){ SystemNow, SystemSleepUntil, NULL };
+}
+
+static double FakeNow(void *context) {
+    return ((FakeClock *)context)->time;
+}
+
+static void FakeSleepUntil(void *context, double time) {
+    FakeClock *fake = context;
+    if (time > fake->time) fake->time = time;
+}
+
+Clock FakeClockMake(FakeClock *fake) {
+    return (Clock){ FakeNow, FakeSleepUntil, fake };
+}
+
+void FakeClockAdvance(FakeClock *fake, double seconds) {
+    fake->time += seconds;
+}
+
+// =====================================================================
+// FRAME PACER
+// =====================================================================
+
+void FramePacerInit(FramePacer *pacer, Clock clock, double period, bool lowLatency) {
+    pacer->clock = clock;
+    pacer->period = period;
+    pacer->next = clock.now(clock.context) + period;
+    pacer->lowLatency = lowLatency;
+    pacer->margin = LATENCY_DEFAULT_MARGIN;
+}
+
+double FramePacerBeginFrame(FramePacer *pacer, double nextTick) {
+    Clock clock = pacer->clock;
+    if (pacer->lowLatency) clock.sleepUntil(clock.context, nextTick - pacer->margin);
+    return clock.now(clock.context);
+}
+
+bool FramePacerWaitForTick(FramePacer *pacer, double sampled, double timeout, LatencyNewestInput newest,
+                           void *context) {
+    if (!pacer->lowLatency) return true;
+
+    Clock clock = pacer->clock;
+    double deadline = sampled + timeout;
+    while (newest(context) < sampled) {
+        double now = clock.now(clock.context);
+        if (now >= deadline) return false;
+        clock.sleepUntil(clock.context, now + LATENCY_POLL_INTERVAL);
+    }
+    return true;
+}
+
+void FramePacerEndFrame(FramePacer *pacer) {
+    if (pacer->lowLatency) return;      // The simulation's ticks set the pace
+
+    Clock clock = pacer->clock;
+    double now = clock.now(clock.context);
+    if (now > pacer->next) {
+        pacer->next = now + pacer->period;
+        return;
+    }
+    clock.sleepUntil(clock.context, pacer->next);
+    pacer->next += pacer->period;
+}
+
+// =====================================================================
+// LATENCY HISTOGRAM
+// =====================================================================
+
+void LatencyInit(LatencyTracker *tracker) {
+    *tracker = (LatencyTracker){ 0 };
+}
+
+bool LatencyRecord(LatencyTracker *tracker, const LatencyFrame *frame) {
+    if (tracker->count > 0 && frame->inputSampled <= tracker->lastInput) {
+        tracker->repeated++;
+        return false;
+    }
+    tracker->lastInput = frame->inputSampled;
+
+    double latency = frame->presented - frame->inputSampled;
+    if (latency < 0) latency = 0;
+    int bin = (int)(latency / LATENCY_BIN);
+    if (bin >= LATENCY_BINS) bin = LATENCY_BINS - 1;
+    tracker->bins[bin]++;
+    tracker->count++;
+    tracker->sum += latency;
+    if (latency > tracker->worst) tracker->worst = latency;
+    tracker->simSum += frame->simDone - frame->inputSampled;
+    tracker->drawSum += frame->drawSubmitted - frame->simDone;
+    tracker->presentSum += frame->presented - frame->drawSubmitted;
+    return true;
+}
+
+double LatencyPercentile(const LatencyTracker *tracker, double percent) {
+    if (tracker->count == 0) return 0.0;
+    long target = (long)((tracker->count - 1) * percent / 100.0);
+    long seen = 0;
+    double edge = LATENCY_BINS * LATENCY_BIN;
+    for (int b = 0; b < LATENCY_BINS; b++) {
+        seen += tracker->bins[b];
+        if (seen > target) {
+            edge = (b + 1) * LATENCY_BIN;
+            break;
+        }
+    }
+    // The bin's upper edge, but never more than the worst frame actually measured
+    return (edge < tracker->worst ? edge : tracker->worst) * 1000.0;
+}
+
+void LatencyPrint(const LatencyTracker *tracker, FILE *out) {
+    long count = tracker->count;
+    if (count == 0) {
+        fprintf(out, "latency: no frames\n");
+        return;
+    }
+    fprintf(out, "latency: %ld frames, input to present avg %.2f ms, p50 %.1f, p90 %.1f, p99 %.1f, worst %.2f ms\n",
+            count, tracker->sum / count * 1000.0, LatencyPercentile(tracker, 50), LatencyPercentile(tracker, 90),
+            LatencyPercentile(tracker, 99), tracker->worst * 1000.0);
+    fprintf(out, "         avg %.2f ms to the tick, %.2f ms to draw, %.2f ms to present\n",
+            tracker->simSum / count * 1000.0, tracker->drawSum / count * 1000.0,
+            tracker->presentSum / count * 1000.0);
+    fprintf(out, "         %ld more frames showed input already counted\n", tracker->repeated);
+
+    // One row per ms, from the first frame to the last
+    int rows = LATENCY_BINS / LATENCY_ROW_BINS, first = rows, last = 0;
+    long row[LATENCY_BINS / LATENCY_ROW_BINS] = { 0 }, most = 0;
+    for (int b = 0; b < LATENCY_BINS; b++) row[b / LATENCY_ROW_BINS] += tracker->bins[b];
+    for (int r = 0; r < rows; r++) {
+        if (row[r] == 0) continue;
+        if (r < first) first = r;
+        last = r;
+        if (row[r] > most) most = row[r];
+    }
+    for (int r = first; r <= last; r++) {
+        int bar = (int)(row[r] * LATENCY_BAR / most);
+        fprintf(out, "  <%3.0f ms%s %8ld  %.*s\n", (r + 1) * LATENCY_ROW_BINS * LATENCY_BIN * 1000.0,
+                r == rows - 1 ? "+" : " ", row[r], bar, "########################################");
+    }
+}
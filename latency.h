@@ -0,0 +1,132 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - INPUT LATENCY
+*
+*   How long a key press takes to reach the screen, and a frame pacer that can make
+*   it shorter. Each frame the game records four moments:
+*
+*     input sampled -> simulation tick done -> draw submitted -> presented
+*
+*   where "input sampled" is when the buttons in the drawn tick were read. The time
+*   from the first to the last goes into a histogram with 0.5 ms bins, once per
+*   input: only the first frame that shows it counts.
+*
+*   The pacer decides where in a frame the waiting happens:
+*
+*     - normal: read input, draw, present, then sleep until the next frame is due
+*       (what SetTargetFPS does). The input is as old as the whole frame.
+*     - low latency (late latch): sleep first, until just before the simulation's
+*       next tick, then read input, wait for that tick and draw it right away. The
+*       input is only a tick's work and a draw old when it reaches the screen.
+*
+*   Every time and every wait goes through a Clock, so the pacing can be run
+*   against a FakeClock without a window or real time (see bench_latency.c).
+*   Pure C, no raylib.
+*
+********************************************************************************************/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// =====================================================================
+// CLOCK
+// =====================================================================
+
+typedef struct {
+    double (*now)(void *context);                       // Seconds, monotonic
+    void   (*sleepUntil)(void *context, double time);   // Returns at (or just after) time
+    void    *context;
+} Clock;
+
+// The real one (timer.h)
+Clock ClockSystem(void);
+
+// Time only moves when it is told to (or slept on)
+typedef struct {
+    double time;
+} FakeClock;
+
+Clock FakeClockMake(FakeClock *fake);
+void  FakeClockAdvance(FakeClock *fake, double seconds);
+
+// =====================================================================
+// FRAME PACER
+// =====================================================================
+
+#define LATENCY_DEFAULT_MARGIN  0.002   // Low latency: read input this long before the tick
+#define LATENCY_POLL_INTERVAL   0.0002  // Low latency: how often to look for the tick with the input
+
+typedef struct {
+    Clock  clock;
+    double period;          // Seconds per frame (normal mode)
+    double next;            // When the next frame is due (normal mode)
+    bool   lowLatency;
+    double margin;          // Seconds between reading input and the tick (low latency)
+} FramePacer;
+
+void FramePacerInit(FramePacer *pacer, Clock clock, double period, bool lowLatency);
+
+// Start of a frame, right before input is read. In low latency mode this sleeps
+// until margin before nextTick, the start of the simulation's next tick.
+// Returns the time the input is read at.
+double FramePacerBeginFrame(FramePacer *pacer, double nextTick);
+
+// When the buttons in the newest published tick were read. It may also take that
+// tick for drawing (the game swaps in the newest frame of its triple buffer).
+typedef double (*LatencyNewestInput)(void *context);
+
+// Low latency mode: after the input read at `sampled` was sent, wait for the tick
+// that takes it, looking every LATENCY_POLL_INTERVAL, at most timeout seconds (a
+// stuck simulation doesn't hang the frame). Returns false if it gave up. Normal
+// mode draws whatever is newest and returns true right away.
+bool FramePacerWaitForTick(FramePacer *pacer, double sampled, double timeout, LatencyNewestInput newest,
+                           void *context);
+
+// After presenting. In normal mode this sleeps until the next frame is due; a
+// frame that ran late moves the schedule instead of making the next ones rush.
+void FramePacerEndFrame(FramePacer *pacer);
+
+// =====================================================================
+// LATENCY HISTOGRAM
+// =====================================================================
+
+#define LATENCY_BIN     0.0005  // Seconds per bin
+#define LATENCY_BINS    200     // Up to 100 ms; later frames go into the last bin
+
+typedef struct {
+    double inputSampled;
+    double simDone;
+    double drawSubmitted;
+    double presented;
+} LatencyFrame;
+
+typedef struct {
+    long   bins[LATENCY_BINS];
+    long   count;
+    long   repeated;            // Frames that showed input an earlier frame already showed
+    double lastInput;           // inputSampled of the last frame counted
+    double sum;                 // Input to present
+    double worst;
+    double simSum;              // Input sampled to tick done
+    double drawSum;             // Tick done to draw submitted
+    double presentSum;          // Draw submitted to presented
+} LatencyTracker;
+
+void LatencyInit(LatencyTracker *tracker);
+
+// Count a presented frame, if it is the first one to show its input. A frame that
+// shows the same tick again, or a new tick with no newer input (the display is
+// faster than the ticks), only counts as repeated. Returns whether it was counted.
+bool LatencyRecord(LatencyTracker *tracker, const LatencyFrame *frame);
+
+// Milliseconds below which percent of the frames were: the top of their bin, or
+// the worst frame measured if that is lower
+double LatencyPercentile(const LatencyTracker *tracker, double percent);
+
+// Averages of each step, percentiles and a histogram, like the batch runner's
+void LatencyPrint(const LatencyTracker *tracker, FILE *out);
+
+#endif // LATENCY_H
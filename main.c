@@ -15,8 +15,44 @@
 *     8. Particle effects
 *     9. Game states (menu, game, game over screen)
 *
+*   The game logic itself lives in sim.c (see sim.h); this file handles the window,
+*   input and drawing. The simulation ticks on a thread of its own (sim_thread.h):
+*   the main thread samples input, sends it over, and draws the newest finished tick.
+*
 *   To compile:
-*     gcc main.c -o space_shooter -lraylib -lm -lpthread -ldl -lrt -lX11
+*     gcc main.c sim.c particles.c jobs.c config.c render_queue.c render_gl.c scene.c sprites.c ui.c background.c profiler.c \
+*         replay.c snapshot.c quality.c bot.c sim_thread.c latency.c stats_feed.c -o space_shooter -lraylib -lm -lpthread -ldl -lrt -lX11
+*
+*   Add -DENABLE_PROFILER for the frame profiler: F3 shows the overlay, F4 starts and
+*   stops recording profile_trace.json (Chrome trace) and profile_frames.csv.
+*
+*   How long input takes to reach the screen is printed on exit (latency.h);
+*   --low-latency reads input as late as it can instead of at the start of the frame.
+*
+*   Every game is recorded to last_game.rpl (--record=FILE to pick another file,
+*   --no-record to turn it off); replayer checks a recording against this build.
+*   Hold BACKSPACE to rewind the last 10 seconds, F5 / F9 save and load the game.
+*
+*   When frames take longer than the budget, glow effects, particle bursts and background
+*   stars are cut back step by step (quality.h); --quality=N fixes the level instead and
+*   --frame-budget=MS changes the budget.
+*
+*   Spawns that a full pool had to drop are counted (stats_feed.h) and printed on exit;
+*   --stats-feed also publishes the counts every tick, for statsmon to watch live.
+*
+*   --world-height=PIXELS (or world_height in space_shooter.cfg) makes the world taller
+*   than the screen; a camera follows the ship up through it (LESSON 19 in sim.c).
+*
+*   Headless simulation benchmark (no window, no raylib library needed):
+*     gcc headless.c sim.c particles.c jobs.c config.c render_queue.c scene.c sprites.c profiler.c replay.c quality.c stats_feed.c -O2 -o headless -lm -lpthread
+*   Replay verifier:
+*     gcc replayer.c replay.c sim.c particles.c jobs.c -O2 -o replayer -lm -lpthread
+*   Input latency of both frame pacing modes, against a fake clock:
+*     gcc bench_latency.c latency.c -O2 -o bench_latency -lm
+*   Bot batch runner for balance testing (--bot lets the same bot play the game):
+*     gcc batch.c bot.c sim.c particles.c jobs.c config.c -O2 -o batch -lm -lpthread
+*   Live pool statistics of a game started with --stats-feed:
+*     gcc statsmon.c stats_feed.c -O2 -o statsmon
 *
 *   Or using CMake:
 *     mkdir build && cd build && cmake .. && make
@@ -24,25 +60,27 @@
 ********************************************************************************************/
 
 #include "raylib.h"
+#include "sim.h"          // After raylib.h so it reuses raylib's Vector2/Color types
+#include "config.h"
+#include "profiler.h"
+#include "render_queue.h"
+#include "scene.h"
+#include "sprites.h"
+#include "ui.h"
+#include "background.h"
+#include "starfield.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "quality.h"
+#include "bot.h"
+#include "sim_thread.h"
+#include "latency.h"
+#include "stats_feed.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
-// =====================================================================
-// LESSON 1: CONSTANTS AND STRUCTS
-// =====================================================================
-// In raylib, we define game objects using structs.
-// Each object has a position (Vector2), size, speed, and state.
-
-#define SCREEN_WIDTH    800
-#define SCREEN_HEIGHT   600
-#define MAX_BULLETS     50
-#define MAX_ENEMIES     20
-#define MAX_STARS       100
-#define MAX_PARTICLES   200
-#define MAX_EXPLOSIONS  10
-
 // Game states - menu, game, and game over screen
 typedef enum {
     STATE_MENU,
@@ -50,747 +88,409 @@ typedef enum {
     STATE_GAMEOVER
 } GameState;
 
-// Player ship
-typedef struct {
-    Vector2 position;       // x,y position on screen
-    Vector2 size;           // Width and height
-    float   speed;          // Movement speed (pixels/frame)
-    int     health;         // Remaining health
-    int     score;          // Total score
-    float   shoot_timer;    // Last shot time (for cooldown)
-    bool    active;         // Is the player active?
-    float   damage_timer;   // For damage animation
-} Player;
-
-// Bullet
-typedef struct {
-    Vector2 position;
-    Vector2 velocity;
-    float   radius;
-    bool    active;
-    Color   color;
-} Bullet;
-
-// Enemy
-typedef struct {
-    Vector2 position;
-    Vector2 size;
-    float   speed;
-    int     health;
-    bool    active;
-    int     type;           // 0: normal, 1: fast, 2: strong
-    float   move_angle;     // For wavy movement
-} Enemy;
-
-// Star (background)
-typedef struct {
-    Vector2 position;
-    float   speed;
-    float   brightness;
-    float   size;
-} Star;
+// Keys the simulation thread handles itself, sent along with the buttons
+typedef enum {
+    COMMAND_ENTER  = 1 << 0,        // Start a game (menu, game over)
+    COMMAND_ESCAPE = 1 << 1,        // Back to the menu
+    COMMAND_REWIND = 1 << 2,        // Held: ticks go backwards
+    COMMAND_SAVE   = 1 << 3,        // Save state
+    COMMAND_LOAD   = 1 << 4,        // Load it again
+    COMMAND_PROFILER = 1 << 5,      // Main thread only: profiler overlay
+    COMMAND_CAPTURE  = 1 << 6       // Main thread only: profiler recording
+} GameCommand;
 
-// Particle effect
-typedef struct {
-    Vector2 position;
-    Vector2 velocity;
-    float   radius;
-    float   lifetime;       // Remaining lifetime (seconds)
-    float   max_lifetime;
-    Color   color;
-    bool    active;
-} Particle;
+#define TARGET_FPS  60
 
 // =====================================================================
 // LESSON 2: GLOBAL VARIABLES
 // =====================================================================
-// We store all game objects in global arrays.
-
-static Player    player;
-static Bullet    bullets[MAX_BULLETS];
-static Enemy     enemies[MAX_ENEMIES];
-static Star      stars[MAX_STARS];
-static Particle  particles[MAX_PARTICLES];
-static GameState gameState;
-static float     gameTime;
-static float     enemyTimer;
-static int       wave;              // Enemy wave number
-static float     difficultyMultiplier;
-
-// =====================================================================
-// LESSON 3: UTILITY FUNCTIONS
-// =====================================================================
-
-// Generate a random floating point number
-float RandomFloat(float min, float max) {
-    return min + (float)GetRandomValue(0, 10000) / 10000.0f * (max - min);
-}
+// The whole game lives in one Simulation (see sim.h). main.c only reads
+// input, advances the simulation and draws it.
+// Everything from sim to bot belongs to the simulation thread once it runs
+// (LESSON 18); the draw code only ever looks at a GameFrame.
+
+static Simulation sim;
+static GameState  gameState;
+static float      renderAlpha;      // How far we are between the last two ticks (0..1)
+static double     starScroll;       // Seconds the star background has scrolled (see starfield.h)
+static double     prevStarScroll;   // Same, one tick ago
+static float      tickDt = 1.0f / SIM_TICK_RATE;
+static const char *replayPath = REPLAY_DEFAULT_FILE;   // NULL: don't record
+static ReplayWriter replay;
+static SnapshotRing history;        // Every tick of the current game, for rewinding
+static bool         rewinding;      // BACKSPACE held: ticks go backwards
+#define SAVE_STATE_FILE "quicksave.sav"
+static QualityGovernor quality;     // Cosmetic detail, adjusted to the frame time
+static bool         autopilot;      // --bot: the bot plays instead of the keyboard
+static Bot          bot;
+static SimInput     heldInput;      // The buttons of the newest input message
+static double       heldSampled;    // When they were read
+static uint32_t     gamesStarted;   // Tells StatsCounterTick when the pools start over
+static StatsCounter poolStats;      // Pool counts over every game (stats_feed.h)
+static StatsFeed    statsFeed;      // --stats-feed: poolStats, every tick, in shared memory
+
+// What the draw code sees of one tick: a copy, so the next tick can run meanwhile
+typedef struct {
+    Simulation  sim;                // Live state only (SimCopyState)
+    GameState   state;
+    double      starScroll;
+    double      prevStarScroll;
+    double      time;               // When the tick finished (SimThreadNow)
+    double      inputTime;          // When its buttons were read (0: no input yet)
+    JitterStats tickJitter;         // How evenly the simulation thread has been ticking
+} GameFrame;
+
+static GameFrame     frames[3];     // See TripleBuffer
+static TripleBuffer  frameBuffer;
+static InputQueue    inputQueue;    // Main thread -> simulation thread
+static SimThread     simThread;
+static JitterTracker frameJitter;   // Frame starts on the main thread
+static FramePacer    pacer;         // Where in a frame the waiting happens (latency.h)
+static LatencyTracker latency;      // Input read to frame presented
 
 // =====================================================================
 // LESSON 4: GAME INITIALIZATION
 // =====================================================================
-// We reset all objects every time a new game starts.
-
-void InitGame(void) {
-    // Player initial values
-    player.position = (Vector2){ SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT - 80.0f };
-    player.size = (Vector2){ 40.0f, 40.0f };
-    player.speed = 300.0f;
-    player.health = 5;
-    player.score = 0;
-    player.shoot_timer = 0;
-    player.active = true;
-    player.damage_timer = 0;
-
-    // Deactivate all bullets
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        bullets[i].active = false;
-    }
-
-    // Deactivate all enemies
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        enemies[i].active = false;
-    }
-
-    // Deactivate all particles
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        particles[i].active = false;
-    }
-
-    // LESSON 5: BACKGROUND STARS
-    // Parallax effect: stars at different speeds give a sense of depth
-    for (int i = 0; i < MAX_STARS; i++) {
-        stars[i].position = (Vector2){
-            (float)GetRandomValue(0, SCREEN_WIDTH),
-            (float)GetRandomValue(0, SCREEN_HEIGHT)
-        };
-        stars[i].speed = RandomFloat(20.0f, 150.0f);
-        stars[i].brightness = RandomFloat(0.3f, 1.0f);
-        stars[i].size = RandomFloat(1.0f, 3.0f);
-    }
-
-    gameTime = 0;
-    enemyTimer = 0;
-    wave = 1;
-    difficultyMultiplier = 1.0f;
+// Every new game gets a fresh random seed from raylib. Nothing is allocated
+// or cleared slot by slot here: SimInit just empties the pools (see sim.c).
+// Returns the seed, which is all a replay needs to start the same game again.
+
+unsigned int InitGame(void) {
+    unsigned int seed = (unsigned int)GetRandomValue(1, 0x7FFFFFFF);
+    SimInit(&sim, seed);
+    gamesStarted++;
+    return seed;
 }
 
-// =====================================================================
-// LESSON 6: PARTICLE SYSTEM
-// =====================================================================
-// Particle system for explosions and effects.
-// Each particle has a lifetime, velocity, and color.
-
-void SpawnParticles(Vector2 position, Color color, int count) {
-    for (int i = 0; i < MAX_PARTICLES && count > 0; i++) {
-        if (!particles[i].active) {
-            particles[i].active = true;
-            particles[i].position = position;
-            // Spread in random directions
-            float angle = RandomFloat(0, 2.0f * PI);
-            float spd = RandomFloat(50.0f, 250.0f);
-            particles[i].velocity = (Vector2){
-                cosf(angle) * spd,
-                sinf(angle) * spd
-            };
-            particles[i].radius = RandomFloat(2.0f, 6.0f);
-            particles[i].lifetime = RandomFloat(0.3f, 0.8f);
-            particles[i].max_lifetime = particles[i].lifetime;
-            particles[i].color = color;
-            count--;
-        }
-    }
+// Finish the replay of the game that just ended (or was left)
+void StopRecording(void) {
+    if (replay.file && !ReplayWriterClose(&replay, &sim))
+        fprintf(stderr, "Couldn't write the replay to %s\n", replayPath);
 }
 
-// =====================================================================
-// LESSON 7: SHOOTING BULLETS
-// =====================================================================
-// Find an empty bullet slot and activate it.
-
-void ShootBullet(Vector2 position, Vector2 velocity, Color color) {
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (!bullets[i].active) {
-            bullets[i].active = true;
-            bullets[i].position = position;
-            bullets[i].velocity = velocity;
-            bullets[i].radius = 4.0f;
-            bullets[i].color = color;
-            return;
-        }
+// A new game, recorded tick by tick from the start (see replay.h)
+void StartGame(void) {
+    StopRecording();
+    unsigned int seed = InitGame();
+    SnapshotRingReset(&history);
+    SnapshotCapture(&history, &sim);
+    BotInit(&bot, BOT_REACTION, tickDt);
+    if (replayPath) {
+        ReplayHeader header = ReplayHeaderFor(&sim, seed, tickDt);
+        if (!ReplayWriterOpen(&replay, replayPath, &header))
+            fprintf(stderr, "Couldn't create %s, this game won't be recorded\n", replayPath);
     }
+    gameState = STATE_GAME;
 }
 
 // =====================================================================
-// LESSON 8: SPAWNING ENEMIES
+// LESSON 9: UPDATE - Game Logic
 // =====================================================================
-// Different enemy types: normal, fast, strong
-
-void SpawnEnemy(void) {
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (!enemies[i].active) {
-            enemies[i].active = true;
-            enemies[i].position = (Vector2){
-                (float)GetRandomValue(40, SCREEN_WIDTH - 40),
-                -40.0f
-            };
-
-            // Determine type (harder enemies appear as waves progress)
-            int typeChance = GetRandomValue(0, 100);
-            if (typeChance < 60) {
-                // Normal enemy
-                enemies[i].type = 0;
-                enemies[i].size = (Vector2){ 30.0f, 30.0f };
-                enemies[i].speed = 80.0f + wave * 10.0f;
-                enemies[i].health = 1;
-            } else if (typeChance < 85) {
-                // Fast enemy
-                enemies[i].type = 1;
-                enemies[i].size = (Vector2){ 20.0f, 20.0f };
-                enemies[i].speed = 150.0f + wave * 15.0f;
-                enemies[i].health = 1;
-            } else {
-                // Strong enemy
-                enemies[i].type = 2;
-                enemies[i].size = (Vector2){ 40.0f, 40.0f };
-                enemies[i].speed = 50.0f + wave * 5.0f;
-                enemies[i].health = 3;
-            }
+// LESSON: Keyboard input is checked with IsKeyDown(), then handed to the
+// simulation as a set of button flags.
+
+SimInput ReadInput(void) {
+    SimInput input = { 0 };
+    if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A))  input.buttons |= INPUT_LEFT;
+    if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D)) input.buttons |= INPUT_RIGHT;
+    if (IsKeyDown(KEY_UP) || IsKeyDown(KEY_W))    input.buttons |= INPUT_UP;
+    if (IsKeyDown(KEY_DOWN) || IsKeyDown(KEY_S))  input.buttons |= INPUT_DOWN;
+    if (IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_BUTTON_LEFT))
+        input.buttons |= INPUT_FIRE;
+    return input;
+}
 
-            enemies[i].move_angle = RandomFloat(0, 2.0f * PI);
-            return;
-        }
-    }
+// Menu, rewind and save state keys. Whether they do anything depends on the
+// game state, which only the simulation thread knows for sure (HandleCommands).
+unsigned int ReadCommands(void) {
+    unsigned int commands = 0;
+    if (IsKeyPressed(KEY_ENTER))     commands |= COMMAND_ENTER;
+    if (IsKeyPressed(KEY_ESCAPE))    commands |= COMMAND_ESCAPE;
+    if (IsKeyDown(KEY_BACKSPACE))    commands |= COMMAND_REWIND;
+    if (IsKeyPressed(KEY_F5))        commands |= COMMAND_SAVE;
+    if (IsKeyPressed(KEY_F9))        commands |= COMMAND_LOAD;
+    if (IsKeyPressed(KEY_F3))        commands |= COMMAND_PROFILER;
+    if (IsKeyPressed(KEY_F4))        commands |= COMMAND_CAPTURE;
+    return commands;
 }
 
-// =====================================================================
-// LESSON 9: UPDATE - Game Logic
-// =====================================================================
-// Called every frame. Updates all objects.
-
-void UpdateGame(void) {
-    float dt = GetFrameTime(); // Delta time: time between frames
-    gameTime += dt;
-
-    // --- PLAYER MOVEMENT ---
-    // LESSON: Keyboard input is checked with IsKeyDown()
-    if (player.active) {
-        if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A))
-            player.position.x -= player.speed * dt;
-        if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D))
-            player.position.x += player.speed * dt;
-        if (IsKeyDown(KEY_UP) || IsKeyDown(KEY_W))
-            player.position.y -= player.speed * dt;
-        if (IsKeyDown(KEY_DOWN) || IsKeyDown(KEY_S))
-            player.position.y += player.speed * dt;
-
-        // Screen boundary clamping
-        if (player.position.x < player.size.x / 2)
-            player.position.x = player.size.x / 2;
-        if (player.position.x > SCREEN_WIDTH - player.size.x / 2)
-            player.position.x = SCREEN_WIDTH - player.size.x / 2;
-        if (player.position.y < player.size.y / 2)
-            player.position.y = player.size.y / 2;
-        if (player.position.y > SCREEN_HEIGHT - player.size.y / 2)
-            player.position.y = SCREEN_HEIGHT - player.size.y / 2;
-
-        // --- SHOOTING ---
-        // LESSON: We limit fire rate using a cooldown system
-        player.shoot_timer -= dt;
-        if ((IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_BUTTON_LEFT))
-            && player.shoot_timer <= 0) {
-            // Fire double bullets
-            ShootBullet(
-                (Vector2){ player.position.x - 12, player.position.y - 20 },
-                (Vector2){ 0, -500.0f },
-                (Color){ 0, 200, 255, 255 }
-            );
-            ShootBullet(
-                (Vector2){ player.position.x + 12, player.position.y - 20 },
-                (Vector2){ 0, -500.0f },
-                (Color){ 0, 200, 255, 255 }
-            );
-            player.shoot_timer = 0.15f; // 0.15 second cooldown
-        }
+void HandleCommands(unsigned int commands) {
+    if ((commands & COMMAND_ENTER) && gameState != STATE_GAME) StartGame();
+    if (commands & COMMAND_ESCAPE) {
+        if (gameState == STATE_GAME) StopRecording();
+        gameState = STATE_MENU;
     }
 
-    // Update damage animation
-    if (player.damage_timer > 0)
-        player.damage_timer -= dt;
-
-    // --- UPDATE BULLETS ---
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (bullets[i].active) {
-            bullets[i].position.x += bullets[i].velocity.x * dt;
-            bullets[i].position.y += bullets[i].velocity.y * dt;
-
-            // Remove bullets that go off screen
-            if (bullets[i].position.y < -10 || bullets[i].position.y > SCREEN_HEIGHT + 10)
-                bullets[i].active = false;
+    // Save states (see snapshot.h): the last tick of the game, to a file and back
+    if ((commands & COMMAND_SAVE) && gameState == STATE_GAME && !SnapshotSave(&history, SAVE_STATE_FILE))
+        fprintf(stderr, "Couldn't write %s\n", SAVE_STATE_FILE);
+    // The replay can't follow a jump to another state, so a good file ends it, on
+    // the state it reached; a missing or refused one leaves game and recording be
+    if (commands & COMMAND_LOAD) {
+        if (SnapshotRead(&history, SAVE_STATE_FILE)) {
+            StopRecording();
+            SnapshotApply(&history, &sim);
+            gameState = STATE_GAME;
+        } else {
+            fprintf(stderr, "No save state to load (or it is from other capacities)\n");
         }
     }
+}
 
-    // --- UPDATE ENEMIES ---
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemies[i].active) {
-            // Move downward + wavy horizontal movement
-            enemies[i].move_angle += dt * 3.0f;
-            enemies[i].position.y += enemies[i].speed * dt;
-            enemies[i].position.x += sinf(enemies[i].move_angle) * 50.0f * dt;
-
-            // Remove enemies that go off screen
-            if (enemies[i].position.y > SCREEN_HEIGHT + 50) {
-                enemies[i].active = false;
-            }
-
-            // --- COLLISION DETECTION: Bullet vs Enemy ---
-            // LESSON: AABB (Axis-Aligned Bounding Box) collision check
-            for (int j = 0; j < MAX_BULLETS; j++) {
-                if (bullets[j].active && bullets[j].velocity.y < 0) { // Only upward bullets
-                    Rectangle enemyRect = {
-                        enemies[i].position.x - enemies[i].size.x / 2,
-                        enemies[i].position.y - enemies[i].size.y / 2,
-                        enemies[i].size.x,
-                        enemies[i].size.y
-                    };
-
-                    if (CheckCollisionCircleRec(bullets[j].position, bullets[j].radius, enemyRect)) {
-                        bullets[j].active = false;
-                        enemies[i].health--;
-
-                        if (enemies[i].health <= 0) {
-                            enemies[i].active = false;
-                            // Explosion effect — unique color per enemy type
-                            if (enemies[i].type == 0) {
-                                // Normal: red burst
-                                SpawnParticles(enemies[i].position, (Color){ 255, 60, 30, 255 }, 10);
-                                SpawnParticles(enemies[i].position, (Color){ 255, 160, 50, 255 }, 6);
-                            } else if (enemies[i].type == 1) {
-                                // Fast: bright cyan/white flash
-                                SpawnParticles(enemies[i].position, (Color){ 0, 230, 255, 255 }, 10);
-                                SpawnParticles(enemies[i].position, (Color){ 255, 255, 255, 255 }, 5);
-                            } else {
-                                // Strong: purple + magenta blast
-                                SpawnParticles(enemies[i].position, (Color){ 200, 0, 255, 255 }, 15);
-                                SpawnParticles(enemies[i].position, (Color){ 255, 80, 200, 255 }, 8);
-                            }
-
-                            // Score: different points per type
-                            int points[] = { 100, 150, 300 };
-                            player.score += points[enemies[i].type];
-                        } else {
-                            // Took damage but didn't die — light grey sparks
-                            SpawnParticles(bullets[j].position, (Color){ 200, 200, 200, 255 }, 4);
-                        }
-                    }
-                }
-            }
-
-            // --- COLLISION: Enemy vs Player ---
-            if (player.active && player.damage_timer <= 0) {
-                Rectangle playerRect = {
-                    player.position.x - player.size.x / 2,
-                    player.position.y - player.size.y / 2,
-                    player.size.x,
-                    player.size.y
-                };
-                Rectangle enemyRect = {
-                    enemies[i].position.x - enemies[i].size.x / 2,
-                    enemies[i].position.y - enemies[i].size.y / 2,
-                    enemies[i].size.x,
-                    enemies[i].size.y
-                };
-
-                if (CheckCollisionRecs(playerRect, enemyRect)) {
-                    enemies[i].active = false;
-                    player.health--;
-                    player.damage_timer = 1.0f; // 1 second of invincibility
-                    // Player hit — blue sparks
-                    SpawnParticles(player.position, (Color){ 0, 180, 255, 255 }, 12);
-                    SpawnParticles(player.position, (Color){ 255, 255, 255, 255 }, 6);
-
-                    if (player.health <= 0) {
-                        player.active = false;
-                        // Player death — big multi-color explosion
-                        SpawnParticles(player.position, (Color){ 0, 180, 255, 255 }, 30);
-                        SpawnParticles(player.position, (Color){ 255, 255, 255, 255 }, 20);
-                        SpawnParticles(player.position, (Color){ 100, 220, 255, 255 }, 15);
-                        gameState = STATE_GAMEOVER;
-                    }
+// Called once per simulation tick (dt is always the fixed tick length)
+void UpdateGame(SimInput input, float dt) {
+    // The star background only needs to know how far it has scrolled;
+    // on the game over screen it slows down
+    prevStarScroll = starScroll;
+    starScroll += gameState == STATE_GAMEOVER ? dt * 0.3f : dt;
+
+    switch (gameState) {
+        case STATE_MENU:
+            break;
+        case STATE_GAME:
+            if (rewinding) {
+                // One tick back per tick. The replay can't follow a jump back in
+                // time, so it ends here with the game as it was before the rewind.
+                if (SnapshotHistory(&history) > 0) {
+                    StopRecording();
+                    SnapshotRewind(&history, &sim, 1);
                 }
+                break;
             }
-        }
+            if (!SimStep(&sim, input, dt)) gameState = STATE_GAMEOVER;
+            SnapshotCapture(&history, &sim);
+            ReplayWriterTick(&replay, input, &sim);
+            if (gameState == STATE_GAMEOVER) StopRecording();
+            break;
+        case STATE_GAMEOVER:
+            // Keep particles going
+            SimUpdateParticles(&sim, dt);
+            break;
     }
+}
 
-    // --- UPDATE PARTICLES ---
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        if (particles[i].active) {
-            particles[i].position.x += particles[i].velocity.x * dt;
-            particles[i].position.y += particles[i].velocity.y * dt;
-            particles[i].lifetime -= dt;
-            // Drag effect
-            particles[i].velocity.x *= 0.98f;
-            particles[i].velocity.y *= 0.98f;
-
-            if (particles[i].lifetime <= 0)
-                particles[i].active = false;
-        }
-    }
+// =====================================================================
+// LESSON 18: TWO THREADS
+// =====================================================================
+// LESSON: With one loop, a frame that waits for vsync or a slow driver call
+// makes the next ticks late, and a slow tick makes the frame late. Here the
+// simulation runs on a thread of its own at exactly its tick rate
+// (SimThreadStart), and the main thread only samples input and draws:
+//
+//   main thread:  ReadInput -> InputQueue -------> GameTick -> UpdateGame
+//   draw:         DrawGame <- TripleBuffer <------ PublishFrame
+//
+// Neither waits for the other. The draw code always gets a whole tick (a copy
+// of it), never one that is half updated.
+
+// Copy what the draw code needs into a frame the main thread isn't reading
+static void PublishFrame(void) {
+    GameFrame *frame = &frames[TripleBufferWriteSlot(&frameBuffer)];
+    SimCopyState(&frame->sim, &sim);
+    frame->state = gameState;
+    frame->starScroll = starScroll;
+    frame->prevStarScroll = prevStarScroll;
+    frame->time = SimThreadNow();
+    frame->inputTime = heldSampled;
+    frame->tickJitter = simThread.jitter.window;
+    TripleBufferPublish(&frameBuffer);
+}
 
-    // --- UPDATE STARS (Parallax) ---
-    for (int i = 0; i < MAX_STARS; i++) {
-        stars[i].position.y += stars[i].speed * dt;
-        if (stars[i].position.y > SCREEN_HEIGHT) {
-            stars[i].position.y = 0;
-            stars[i].position.x = (float)GetRandomValue(0, SCREEN_WIDTH);
-        }
+// One tick on the simulation thread: every message since the last tick, then the game
+static void GameTick(void *context) {
+    (void)context;
+    PROFILE_BEGIN("Update");        // On the simulation thread's row of the profiler
+    InputMessage message;
+    while (InputQueuePop(&inputQueue, &message)) {
+        HandleCommands(message.commands);
+        heldInput = message.input;
+        heldSampled = message.sampled;
+        rewinding = message.commands & COMMAND_REWIND;
+        sim.particleScale = message.particleScale;
     }
+    UpdateGame(autopilot ? BotInput(&bot, &sim) : heldInput, tickDt);
+    PublishFrame();
+    StatsCounterTick(&poolStats, &sim, gamesStarted, SimThreadNow());
+    StatsFeedPublish(&statsFeed, &poolStats.record);    // Nothing happens if it isn't open
+    PROFILE_END();
+}
 
-    // --- ENEMY WAVE SYSTEM ---
-    enemyTimer += dt;
-    float spawnInterval = 2.0f / difficultyMultiplier; // More frequent as difficulty increases
-    if (enemyTimer >= spawnInterval) {
-        enemyTimer = 0;
-        SpawnEnemy();
-    }
+// Low latency: take the newest frame the simulation has published, and say
+// when the input it shows was read (FramePacerWaitForTick polls this)
+static double NewestFrameInput(void *context) {
+    const GameFrame **frame = context;
+    *frame = &frames[TripleBufferReadSlot(&frameBuffer)];
+    return (*frame)->inputTime;
+}
 
-    // Difficulty increases every 30 seconds
-    difficultyMultiplier = 1.0f + gameTime / 30.0f;
-    wave = 1 + (int)(gameTime / 20.0f);
+// Stars scrolled to where they are between the last two ticks, and moved
+// along with the camera (slower than the world: they are far away)
+static void DrawStars(const GameFrame *frame, float brightness) {
+    double scroll = frame->prevStarScroll + (frame->starScroll - frame->prevStarScroll) * renderAlpha;
+    BackgroundDraw(StarfieldCameraScroll(scroll, SceneView(&frame->sim, renderAlpha).y), brightness,
+                   QualityCurrent(&quality)->starLayers);
 }
 
 // =====================================================================
 // LESSON 10: DRAWING FUNCTIONS
 // =====================================================================
 // In raylib, drawing is done between BeginDrawing() and EndDrawing().
-
-// Draw the player ship (ship shape made of triangles)
-void DrawPlayer(void) {
-    if (!player.active) return;
-
-    // Flash when damaged
-    if (player.damage_timer > 0 && (int)(player.damage_timer * 10) % 2 == 0)
-        return;
-
-    float x = player.position.x;
-    float y = player.position.y;
-
-    // Ship body (triangle)
-    DrawTriangle(
-        (Vector2){ x, y - 22 },          // Top tip (nose)
-        (Vector2){ x - 18, y + 15 },     // Bottom left
-        (Vector2){ x + 18, y + 15 },     // Bottom right
-        (Color){ 50, 150, 255, 255 }
-    );
-
-    // Inner detail
-    DrawTriangle(
-        (Vector2){ x, y - 14 },
-        (Vector2){ x - 10, y + 8 },
-        (Vector2){ x + 10, y + 8 },
-        (Color){ 100, 200, 255, 255 }
-    );
-
-    // Wings
-    DrawTriangle(
-        (Vector2){ x - 18, y + 15 },
-        (Vector2){ x - 28, y + 22 },
-        (Vector2){ x - 8, y + 10 },
-        (Color){ 30, 100, 200, 255 }
-    );
-    DrawTriangle(
-        (Vector2){ x + 18, y + 15 },
-        (Vector2){ x + 28, y + 22 },
-        (Vector2){ x + 8, y + 10 },
-        (Color){ 30, 100, 200, 255 }
-    );
-
-    // Engine flame (animated)
-    float flame = sinf(GetTime() * 20.0f) * 5.0f;
-    DrawTriangle(
-        (Vector2){ x - 6, y + 15 },
-        (Vector2){ x, y + 28 + flame },
-        (Vector2){ x + 6, y + 15 },
-        (Color){ 255, 150, 0, 200 }
-    );
-    DrawTriangle(
-        (Vector2){ x - 3, y + 15 },
-        (Vector2){ x, y + 22 + flame },
-        (Vector2){ x + 3, y + 15 },
-        YELLOW
-    );
-}
-
-// Draw enemy (different shape based on type)
-void DrawEnemy(Enemy *e) {
-    float x = e->position.x;
-    float y = e->position.y;
-
-    if (e->type == 0) {
-        // Normal enemy: Deep red-purple square
-        DrawRectanglePro(
-            (Rectangle){ x, y, e->size.x, e->size.y },
-            (Vector2){ e->size.x / 2, e->size.y / 2 },
-            sinf(e->move_angle) * 15.0f,
-            (Color){ 180, 20, 80, 255 }
-        );
-        DrawRectanglePro(
-            (Rectangle){ x, y, e->size.x * 0.6f, e->size.y * 0.6f },
-            (Vector2){ e->size.x * 0.3f, e->size.y * 0.3f },
-            sinf(e->move_angle) * 15.0f,
-            (Color){ 240, 60, 130, 255 }
-        );
-    } else if (e->type == 1) {
-        // Fast enemy: Magenta — drawn as filled polygon using lines to avoid winding issues
-        float hw = 14.0f;  // half-width
-        float hh = 13.0f;  // half-height
-        // Draw as two overlapping rects to fake a diamond/triangle shape
-        // Top triangle: v0 top, v1 bottom-left, v2 bottom-right (clockwise for raylib screen coords)
-        Vector2 v0 = { x,       y - hh }; // tip top
-        Vector2 v1 = { x + hw,  y + hh }; // bottom right
-        Vector2 v2 = { x - hw,  y + hh }; // bottom left
-        DrawTriangle(v0, v1, v2, (Color){ 220, 0, 120, 255 });
-
-        // Inner highlight
-        Vector2 i0 = { x,      y - 6.0f };
-        Vector2 i1 = { x + 7,  y + 6.0f };
-        Vector2 i2 = { x - 7,  y + 6.0f };
-        DrawTriangle(i0, i1, i2, (Color){ 255, 80, 180, 255 });
-
-        // Bright outline so it's always visible
-        DrawTriangleLines(v0, v1, v2, (Color){ 255, 150, 220, 255 });
-    } else {
-        // Strong enemy: Bright purple hexagon
-        DrawPoly((Vector2){ x, y }, 6, e->size.x / 2, e->move_angle * 10, (Color){ 140, 0, 200, 255 });
-        DrawPoly((Vector2){ x, y }, 6, e->size.x / 3, e->move_angle * 10, (Color){ 200, 60, 255, 255 });
-        // Health indicator
-        for (int c = 0; c < e->health; c++) {
-            DrawCircle((int)(x - 8 + c * 8), (int)(y - e->size.y / 2 - 8), 3, (Color){ 255, 80, 180, 255 });
-        }
-    }
+// The screen usually refreshes between two simulation ticks, so every
+// position is blended from the previous tick to the current one.
+//
+// LESSON: Hundreds of small DrawCircleV() calls add up. Instead, the scene
+// (scene.c) pushes shapes into a render queue, which sorts them by layer and
+// sends them to the GPU in a few big batches (render_queue.h).
+//
+// LESSON: The ship and the enemies are drawn once, at startup, into one
+// texture with every rotation they can have (sprites.h). After that each of
+// them is a single textured quad, however many shapes it was made of.
+//
+// LESSON: The world can be taller than the screen. Everything is drawn at
+// its world position through a Camera2D that follows the player, and the
+// scene leaves out whatever the camera can't see.
+
+#define RENDER_QUEUE_CAPACITY 16384
+
+static RenderCommand renderCommands[RENDER_QUEUE_CAPACITY];
+static int           renderOrder[RENDER_QUEUE_CAPACITY];
+static RenderQueue   renderQueue;
+static SpriteAtlas   atlas;
+static const SpriteAtlas *sceneAtlas;   // NULL if it couldn't be baked: draw the shapes
+
+// The camera that puts the view (SceneView) on screen
+static Camera2D ViewCamera(const GameFrame *frame) {
+    Rectangle view = SceneView(&frame->sim, renderAlpha);
+    return (Camera2D){ .offset = { 0, 0 }, .target = { view.x, view.y }, .rotation = 0.0f, .zoom = 1.0f };
 }
 
 // =====================================================================
 // LESSON 11: MAIN DRAW FUNCTION
 // =====================================================================
 
-void DrawGame(void) {
+void DrawGame(const GameFrame *frame) {
     // Background: Dark space
     ClearBackground((Color){ 5, 5, 20, 255 });
 
-    // Stars
-    for (int i = 0; i < MAX_STARS; i++) {
-        float alpha = stars[i].brightness * 255;
-        Color starColor = (Color){ 200, 200, 255, (unsigned char)alpha };
-        DrawCircleV(stars[i].position, stars[i].size, starColor);
-    }
-
-    // Bullets
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (bullets[i].active) {
-            // Bullet glow effect
-            DrawCircleV(bullets[i].position, bullets[i].radius * 3,
-                       Fade(bullets[i].color, 0.15f));
-            DrawCircleV(bullets[i].position, bullets[i].radius * 1.5f,
-                       Fade(bullets[i].color, 0.4f));
-            DrawCircleV(bullets[i].position, bullets[i].radius, bullets[i].color);
-        }
-    }
-
-    // Enemies
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemies[i].active) {
-            DrawEnemy(&enemies[i]);
-        }
-    }
-
-    // Player
-    DrawPlayer();
-
-    // Particles
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        if (particles[i].active) {
-            float ratio = particles[i].lifetime / particles[i].max_lifetime;
-            float r = particles[i].radius * ratio;
-            Color color = particles[i].color;
-            color.a = (unsigned char)(255 * ratio);
-            DrawCircleV(particles[i].position, r * 2, Fade(color, 0.2f));
-            DrawCircleV(particles[i].position, r, color);
-        }
-    }
+    // Stars: a few pre-baked layers, whatever the number of stars
+    PROFILE_BEGIN("Stars");
+    DrawStars(frame, 1.0f);
+    PROFILE_END();
+
+    // Bullets, enemies, player and particles in one go
+    PROFILE_BEGIN("Scene");
+    RenderQueueBegin(&renderQueue);
+    BuildGameScene(&renderQueue, &frame->sim, renderAlpha, GetTime(), QualityCurrent(&quality), sceneAtlas);
+    RenderQueueSort(&renderQueue);
+    PROFILE_END();
+    PROFILE_BEGIN("Submit");
+    BeginMode2D(ViewCamera(frame));
+    RenderQueueSubmit(&renderQueue);
+    EndMode2D();
+    PROFILE_END();
 
     // --- HUD (Heads-Up Display) ---
-    // Health indicator
-    DrawText("HP:", 10, 10, 20, WHITE);
-    for (int i = 0; i < player.health; i++) {
-        DrawRectangle(50 + i * 25, 12, 18, 18, (Color){ 255, 50, 50, 255 });
-        DrawRectangleLines(50 + i * 25, 12, 18, 18, WHITE);
-    }
-
-    // Score
-    char scoreText[64];
-    snprintf(scoreText, sizeof(scoreText), "SCORE: %d", player.score);
-    DrawText(scoreText, SCREEN_WIDTH - 200, 10, 20, (Color){ 0, 255, 200, 255 });
-
-    // Wave info
-    char waveText[32];
-    snprintf(waveText, sizeof(waveText), "WAVE: %d", wave);
-    DrawText(waveText, SCREEN_WIDTH / 2 - 40, 10, 20, YELLOW);
-
-    // Time
-    char timeText[32];
-    snprintf(timeText, sizeof(timeText), "%.1f sec", gameTime);
-    DrawText(timeText, SCREEN_WIDTH - 80, 35, 16, GRAY);
+    // Screen space, outside the camera. Cached in textures, redrawn only when a value changes (ui.c)
+    PROFILE_BEGIN("HUD");
+    UiDrawHud(&frame->sim);
+    PROFILE_END();
 }
 
 // =====================================================================
 // LESSON 12: MENU SCREEN
 // =====================================================================
 
-void DrawMenu(void) {
+// ENTER (start) is read by ReadCommands and handled on the simulation thread
+void DrawMenu(const GameFrame *frame) {
     ClearBackground((Color){ 5, 5, 20, 255 });
 
-    // Star background is also active in the menu
-    for (int i = 0; i < MAX_STARS; i++) {
-        float dt = GetFrameTime();
-        stars[i].position.y += stars[i].speed * dt;
-        if (stars[i].position.y > SCREEN_HEIGHT) {
-            stars[i].position.y = 0;
-            stars[i].position.x = (float)GetRandomValue(0, SCREEN_WIDTH);
-        }
-        float alpha = stars[i].brightness * 255;
-        DrawCircleV(stars[i].position, stars[i].size,
-                   (Color){ 200, 200, 255, (unsigned char)alpha });
-    }
-
-    // Title (animated)
-    float titleY = 120 + sinf(GetTime() * 2.0f) * 10.0f;
-    const char *title = "SPACE SHOOTER";
-    int titleWidth = MeasureText(title, 50);
-    DrawText(title, SCREEN_WIDTH / 2 - titleWidth / 2 + 2, (int)titleY + 2, 50, DARKBLUE);
-    DrawText(title, SCREEN_WIDTH / 2 - titleWidth / 2, (int)titleY, 50, (Color){ 0, 200, 255, 255 });
-
-    // Subtitle
-    const char *sub = "made with raylib";
-    int subWidth = MeasureText(sub, 20);
-    DrawText(sub, SCREEN_WIDTH / 2 - subWidth / 2, (int)titleY + 60, 20, GRAY);
-
-    // Start button (blinking)
-    float alpha = (sinf(GetTime() * 3.0f) + 1.0f) / 2.0f;
-    Color buttonColor = { 0, 200, 255, (unsigned char)(150 + alpha * 105) };
-    const char *start = "[ ENTER ] to START";
-    int startWidth = MeasureText(start, 24);
-    DrawText(start, SCREEN_WIDTH / 2 - startWidth / 2, 320, 24, buttonColor);
-
-    // Controls info
-    int infoY = 420;
-    DrawText("CONTROLS:", SCREEN_WIDTH / 2 - 80, infoY, 20, WHITE);
-    DrawText("WASD / Arrow Keys  -  Move", SCREEN_WIDTH / 2 - 140, infoY + 35, 16, LIGHTGRAY);
-    DrawText("SPACE / Left Click -  Shoot", SCREEN_WIDTH / 2 - 140, infoY + 60, 16, LIGHTGRAY);
-
-    // Enemy type info
-    DrawRectangle(SCREEN_WIDTH / 2 - 120, infoY + 100, 18, 18, (Color){ 180, 20, 80, 255 });
-    DrawText("Normal (100 pts)", SCREEN_WIDTH / 2 - 90, infoY + 100, 16, LIGHTGRAY);
-
-    // Fast enemy preview (tip pointing down, clockwise)
-    {
-        float mx = SCREEN_WIDTH / 2.0f - 111;
-        float my = infoY + 135.0f;
-        Vector2 mv0 = { mx,      my - 10 };
-        Vector2 mv1 = { mx + 10, my + 8  };
-        Vector2 mv2 = { mx - 10, my + 8  };
-        DrawTriangle(mv0, mv1, mv2, (Color){ 220, 0, 120, 255 });
-        DrawTriangleLines(mv0, mv1, mv2, (Color){ 255, 150, 220, 255 });
-    }
-    DrawText("Fast   (150 pts)", SCREEN_WIDTH / 2 - 90, infoY + 128, 16, LIGHTGRAY);
-
-    DrawPoly((Vector2){ SCREEN_WIDTH / 2.0f - 111, infoY + 165.0f }, 6, 10, 0, (Color){ 140, 0, 200, 255 });
-    DrawText("Strong (300 pts)", SCREEN_WIDTH / 2 - 90, infoY + 156, 16, LIGHTGRAY);
+    // Star background (scrolled by UpdateGame)
+    DrawStars(frame, 1.0f);
 
-    if (IsKeyPressed(KEY_ENTER)) {
-        InitGame();
-        gameState = STATE_GAME;
-    }
+    // Title, start button, controls and enemy types (cached, see ui.c)
+    UiDrawMenu(GetTime());
 }
 
 // =====================================================================
 // LESSON 13: GAME OVER SCREEN
 // =====================================================================
 
-void DrawGameOver(void) {
+// ENTER (again) and ESCAPE (menu) are handled on the simulation thread too
+void DrawGameOver(const GameFrame *frame) {
     ClearBackground((Color){ 5, 5, 20, 255 });
 
-    // Keep stars going
-    for (int i = 0; i < MAX_STARS; i++) {
-        float dt = GetFrameTime();
-        stars[i].position.y += stars[i].speed * dt * 0.3f;
-        if (stars[i].position.y > SCREEN_HEIGHT) {
-            stars[i].position.y = 0;
-        }
-        float alpha = stars[i].brightness * 200;
-        DrawCircleV(stars[i].position, stars[i].size,
-                   (Color){ 200, 200, 255, (unsigned char)alpha });
-    }
-
-    // Keep particles going
-    float dt = GetFrameTime();
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        if (particles[i].active) {
-            particles[i].position.x += particles[i].velocity.x * dt;
-            particles[i].position.y += particles[i].velocity.y * dt;
-            particles[i].lifetime -= dt;
-            particles[i].velocity.x *= 0.98f;
-            particles[i].velocity.y *= 0.98f;
-            if (particles[i].lifetime <= 0) particles[i].active = false;
-
-            float ratio = particles[i].lifetime / particles[i].max_lifetime;
-            Color color = particles[i].color;
-            color.a = (unsigned char)(255 * ratio);
-            DrawCircleV(particles[i].position, particles[i].radius * ratio, color);
-        }
-    }
+    // Stars (dimmed) and particles keep moving (see UpdateGame)
+    DrawStars(frame, 200.0f / 255.0f);
+    RenderQueueBegin(&renderQueue);
+    PushParticles(&renderQueue, &frame->sim.particles, &frame->sim.palette, renderAlpha, false,
+                  SceneView(&frame->sim, renderAlpha));
+    RenderQueueSort(&renderQueue);
+    BeginMode2D(ViewCamera(frame));
+    RenderQueueSubmit(&renderQueue);
+    EndMode2D();
+
+    // Title, final score and stats, buttons (cached, see ui.c)
+    UiDrawGameOver(&frame->sim, GetTime());
+}
 
-    // Title
-    const char *gameOver = "GAME OVER!";
-    int gameOverWidth = MeasureText(gameOver, 50);
-    DrawText(gameOver, SCREEN_WIDTH / 2 - gameOverWidth / 2 + 2, 152, 50, MAROON);
-    DrawText(gameOver, SCREEN_WIDTH / 2 - gameOverWidth / 2, 150, 50, RED);
-
-    // Score
-    char scoreText[64];
-    snprintf(scoreText, sizeof(scoreText), "SCORE: %d", player.score);
-    int scoreWidth = MeasureText(scoreText, 36);
-    DrawText(scoreText, SCREEN_WIDTH / 2 - scoreWidth / 2, 230, 36, (Color){ 0, 255, 200, 255 });
-
-    // Stats
-    char timeText[64];
-    snprintf(timeText, sizeof(timeText), "Survival time: %.1f seconds", gameTime);
-    int timeWidth = MeasureText(timeText, 20);
-    DrawText(timeText, SCREEN_WIDTH / 2 - timeWidth / 2, 285, 20, LIGHTGRAY);
-
-    char waveText[64];
-    snprintf(waveText, sizeof(waveText), "Wave reached: %d", wave);
-    int waveWidth = MeasureText(waveText, 20);
-    DrawText(waveText, SCREEN_WIDTH / 2 - waveWidth / 2, 315, 20, LIGHTGRAY);
-
-    // Play again
-    float alpha = (sinf(GetTime() * 3.0f) + 1.0f) / 2.0f;
-    Color buttonColor = { 255, 200, 0, (unsigned char)(150 + alpha * 105) };
-    const char *retry = "[ ENTER ] to PLAY AGAIN";
-    int retryWidth = MeasureText(retry, 24);
-    DrawText(retry, SCREEN_WIDTH / 2 - retryWidth / 2, 400, 24, buttonColor);
-
-    const char *menu = "[ ESC ] for MENU";
-    int menuWidth = MeasureText(menu, 20);
-    DrawText(menu, SCREEN_WIDTH / 2 - menuWidth / 2, 440, 20, GRAY);
-
-    if (IsKeyPressed(KEY_ENTER)) {
-        InitGame();
-        gameState = STATE_GAME;
-    }
-    if (IsKeyPressed(KEY_ESCAPE)) {
-        gameState = STATE_MENU;
+// =====================================================================
+// PROFILER OVERLAY (only with -DENABLE_PROFILER)
+// =====================================================================
+// One line per zone, indented by nesting depth: time in the last frame,
+// then min / avg / p99 over the last PROFILER_HISTORY frames, in ms.
+// Draw zones measure how long the CPU takes to queue the work, not the GPU.
+
+#if defined(ENABLE_PROFILER)
+static bool showProfiler = false;
+
+void DrawProfilerOverlay(const GameFrame *frame) {
+    int zones = ProfilerZoneCount();
+    int x = 10, y = 60, lineHeight = 12;
+
+    DrawRectangle(x - 5, y - 5, 330, (zones + 8) * lineHeight + 15, Fade(BLACK, 0.7f));
+    DrawText("zone                    last    min    avg    p99", x, y, 10, YELLOW);
+    for (int z = 0; z < zones; z++) {
+        ProfilerStats stats = ProfilerZoneStats(z);
+        y += lineHeight;
+        DrawText(ProfilerZoneName(z), x + ProfilerZoneDepth(z) * 8, y, 10, WHITE);
+        DrawText(TextFormat("%6.2f %6.2f %6.2f %6.2f", stats.last, stats.min, stats.avg, stats.p99),
+                 x + 130, y, 10, stats.p99 > 1000.0f / 60 ? RED : LIGHTGRAY);
     }
+    if (ProfilerCapturing()) DrawText("REC", x + 295, 60, 10, RED);
+
+    UiStats ui = UiGetStats();
+    DrawText(TextFormat("ui cache: %d hits, %d re-renders", ui.hits, ui.renders), x, y + lineHeight + 5, 10, LIGHTGRAY);
+    DrawText(TextFormat("quality: %s%s, avg %.2f ms, %ld of %ld frames over %.1f ms",
+                        QualityCurrent(&quality)->name, quality.locked ? " (fixed)" : "", quality.average * 1000.0,
+                        quality.overruns, quality.frames, quality.budget * 1000.0),
+             x, y + 2 * lineHeight + 5, 10, LIGHTGRAY);
+
+    // The two threads separately: a hitch on one side shouldn't show on the other
+    JitterStats ticks = frame->tickJitter, draws = frameJitter.window;
+    DrawText(TextFormat("sim ticks: %.2f ms apart, jitter %.3f ms, worst %.2f ms off",
+                        ticks.mean, ticks.stddev, ticks.worst), x, y + 3 * lineHeight + 5, 10, LIGHTGRAY);
+    DrawText(TextFormat("frames:    %.2f ms apart, jitter %.3f ms, worst %.2f ms off",
+                        draws.mean, draws.stddev, draws.worst), x, y + 4 * lineHeight + 5, 10, LIGHTGRAY);
+    DrawText(TextFormat("input to screen: p50 %.1f ms, p99 %.1f ms%s", LatencyPercentile(&latency, 50),
+                        LatencyPercentile(&latency, 99), pacer.lowLatency ? " (low latency)" : ""),
+             x, y + 5 * lineHeight + 5, 10, LIGHTGRAY);
+
+    // Bullets/enemies/particles, this game only: the pools start over with every game
+    const Pool *bullets = &frame->sim.bulletPool, *enemies = &frame->sim.enemyPool;
+    const Pool *particles = &frame->sim.particles.slots;
+    DrawText(TextFormat("pools: peak %d/%d/%d, dropped %ld/%ld/%ld",
+                        bullets->peak, enemies->peak, particles->peak,
+                        bullets->dropped, enemies->dropped, particles->dropped),
+             x, y + 6 * lineHeight + 5, 10, bullets->dropped + enemies->dropped + particles->dropped > 0 ? ORANGE : LIGHTGRAY);
+
+    // Which chunks run at full rate and which at a reduced one (LESSON 19 in sim.c)
+    const SimWorld *world = &frame->sim.world;
+    DrawText(TextFormat("world: view at %.0f of %d px, chunks %d-%d full rate, %d-%d awake of %d",
+                        world->viewTop, frame->sim.config.worldHeight, world->activeFirst, world->activeLast,
+                        world->awakeFirst, world->awakeLast, world->chunkCount),
+             x, y + 7 * lineHeight + 5, 10, LIGHTGRAY);
 }
+#endif
 
 // =====================================================================
 // LESSON 14: MAIN FUNCTION (Main Loop)
@@ -800,45 +500,208 @@ void DrawGameOver(void) {
 //   2. while loop    - Game loop (update + draw)
 //   3. CloseWindow() - Clean up and close
 
-int main(void) {
+int main(int argc, char **argv) {
+    // --- Simulation rate ---
+    // The simulation runs at a fixed rate, independent of the drawing rate.
+    // "--tick-rate=30" trades simulation cost for accuracy on slow machines.
+    // "--threads=N" sets how many cores the big update loops may use.
+    // "--record=FILE" / "--no-record" choose where (or whether) games are recorded.
+    // "--quality=N" fixes the quality level, "--frame-budget=MS" is what it adapts to.
+    // "--bot" lets the bot (bot.h) play, to watch what the batch runner measures.
+    // "--low-latency" reads input right before a tick instead of at the start of a frame.
+    // "--stats-feed" publishes the pool counts for statsmon (stats_feed.h).
+    int tickRate = SIM_TICK_RATE;
+    bool lowLatency = false;
+    bool useStatsFeed = false;
+    int threads = JobSystemDefaultThreads();
+    int fixedQuality = -1;
+    double frameBudget = QUALITY_DEFAULT_BUDGET;
+
+    // --- Capacities ---
+    // How many bullets, enemies, stars and particles there is room for comes
+    // from space_shooter.cfg (if there is one) and flags like --max-particles=N
+    SimConfig config = SimDefaultConfig();
+    ConfigLoadFile(&config, CONFIG_DEFAULT_FILE);
+
+    for (int i = 1; i < argc; i++) {
+        if (ConfigParseFlag(&config, argv[i])) continue;
+        if (strncmp(argv[i], "--tick-rate=", 12) == 0) tickRate = atoi(argv[i] + 12);
+        if (strncmp(argv[i], "--threads=", 10) == 0) threads = atoi(argv[i] + 10);
+        if (strncmp(argv[i], "--record=", 9) == 0) replayPath = argv[i] + 9;
+        if (strcmp(argv[i], "--no-record") == 0) replayPath = NULL;
+        if (strncmp(argv[i], "--quality=", 10) == 0) fixedQuality = atoi(argv[i] + 10);
+        if (strncmp(argv[i], "--frame-budget=", 15) == 0) frameBudget = atof(argv[i] + 15) / 1000.0;
+        if (strcmp(argv[i], "--bot") == 0) autopilot = true;
+        if (strcmp(argv[i], "--low-latency") == 0) lowLatency = true;
+        if (strcmp(argv[i], "--stats-feed") == 0) useStatsFeed = true;
+    }
+    if (tickRate < 1) tickRate = SIM_TICK_RATE;
+
+    // All entity memory, in one allocation for the whole run, and the rewind history
+    // (plus three frames for the draw code, see LESSON 18)
+    if (!SimCreate(&sim, &config) ||
+        !SnapshotRingCreate(&history, &config, SNAPSHOT_DEFAULT_BYTES, SNAPSHOT_DEFAULT_ENTRIES) ||
+        !SimCreate(&frames[0].sim, &config) || !SimCreate(&frames[1].sim, &config) ||
+        !SimCreate(&frames[2].sim, &config)) {
+        fprintf(stderr, "Not enough memory for the configured capacities\n");
+        return 1;
+    }
+    tickDt = 1.0f / tickRate;
+    QualityInit(&quality, frameBudget);
+    if (fixedQuality >= 0) QualityLock(&quality, fixedQuality);
+    sim.particleScale = QualityCurrent(&quality)->particleScale;
+
     // --- Window creation ---
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Space Shooter - raylib Tutorial Project");
-    SetTargetFPS(60);   // Target frame rate
+    SetTargetFPS(0);    // The frame rate is kept by the pacer (latency.h) instead
+    UiLoad();           // Render textures need the window's OpenGL context
+    BackgroundLoad(sim.config.maxStars);   // Bake the star layers once
+    if (SpriteAtlasBuild(&atlas) && RenderAtlasLoad(&atlas)) sceneAtlas = &atlas;   // And the sprites
+    else fprintf(stderr, "Couldn't bake the sprite atlas, drawing shapes instead\n");
 
     // Initial state
     gameState = STATE_MENU;
-    InitGame(); // Initialize stars
+    sim.jobs = JobSystemCreate(threads);  // Kept by every InitGame()
+    InitGame();
+    RenderQueueInit(&renderQueue, renderCommands, renderOrder, RENDER_QUEUE_CAPACITY);
+
+    // Every frame starts as the menu, then the simulation takes over
+    TripleBufferInit(&frameBuffer);
+    for (int f = 0; f < 3; f++) {
+        SimCopyState(&frames[f].sim, &sim);
+        frames[f].state = gameState;
+        frames[f].time = 0.0;
+    }
+    InputQueueInit(&inputQueue);
+    JitterInit(&frameJitter, 1.0 / TARGET_FPS);
+    FramePacerInit(&pacer, ClockSystem(), 1.0 / TARGET_FPS, lowLatency);
+    LatencyInit(&latency);
+    StatsCounterInit(&poolStats);
+    if (useStatsFeed && !StatsFeedCreate(&statsFeed, STATS_FEED_NAME))
+        fprintf(stderr, "Couldn't create the stats feed %s\n", STATS_FEED_NAME);
+    if (!SimThreadStart(&simThread, tickDt, GameTick, NULL)) {
+        fprintf(stderr, "Couldn't start the simulation thread\n");
+        return 1;
+    }
 
     // =====================================================
     // MAIN GAME LOOP
     // =====================================================
     // WindowShouldClose() returns true when the window is closed
     while (!WindowShouldClose()) {
-        // --- Update phase ---
-        switch (gameState) {
-            case STATE_MENU:
-                // Menu input is handled inside DrawMenu
-                break;
-            case STATE_GAME:
-                UpdateGame();
-                if (IsKeyPressed(KEY_ESCAPE)) gameState = STATE_MENU;
-                break;
-            case STATE_GAMEOVER:
-                // Game over input is handled inside DrawGameOver
-                break;
+        PROFILE_FRAME_BEGIN();
+
+        // --- Input phase ---
+        // LESSON: The game itself no longer runs here (LESSON 18). The keys are
+        // sampled once per frame and sent to the simulation thread, which runs
+        // fixed-length ticks on its own clock. The quality level's burst size
+        // goes along, so the simulation thread is the only one touching sim.
+        //
+        // raylib reads new key events in EndDrawing. In low latency mode the
+        // pacer sleeps until just before the next tick, so the events are read
+        // again after it. Key presses are taken from both reads: a press only
+        // shows up in the one that saw it happen.
+        unsigned int commands = ReadCommands();
+        double sampled = FramePacerBeginFrame(&pacer, SimThreadNextTick(&simThread));
+        if (lowLatency) {
+            PollInputEvents();
+            commands |= ReadCommands();
+        }
+        JitterRecord(&frameJitter, sampled);
+        PROFILE_BEGIN("Input");
+        InputMessage message = { ReadInput(), sampled, commands, QualityCurrent(&quality)->particleScale };
+        InputQueuePush(&inputQueue, message);
+        PROFILE_END();
+
+        // The newest finished tick, and how far the clock has gone past it.
+        // In low latency mode: the tick that takes this input, drawn as it is
+        // (blending with the tick before would show it a tick late again).
+        const GameFrame *frame = &frames[TripleBufferReadSlot(&frameBuffer)];
+        if (lowLatency) {
+            FramePacerWaitForTick(&pacer, sampled, tickDt, NewestFrameInput, &frame);
+            renderAlpha = 1.0f;
+        } else {
+            renderAlpha = (float)((SimThreadNow() - frame->time) / tickDt);
+            if (renderAlpha < 0.0f) renderAlpha = 0.0f;
+            if (renderAlpha > 1.0f) renderAlpha = 1.0f;
         }
+        double frameStart = GetTime();
+
+#if defined(ENABLE_PROFILER)
+        if (commands & COMMAND_PROFILER) showProfiler = !showProfiler;
+        if (commands & COMMAND_CAPTURE) {
+            if (ProfilerCapturing()) ProfilerStopCapture();
+            else ProfilerStartCapture("profile_trace.json", "profile_frames.csv");
+        }
+#endif
 
         // --- Draw phase ---
+        PROFILE_BEGIN("Draw");
         BeginDrawing();
-        switch (gameState) {
-            case STATE_MENU:     DrawMenu();     break;
-            case STATE_GAME:     DrawGame();     break;
-            case STATE_GAMEOVER: DrawGameOver(); break;
+        switch (frame->state) {
+            case STATE_MENU:     DrawMenu(frame);     break;
+            case STATE_GAME:     DrawGame(frame);     break;
+            case STATE_GAMEOVER: DrawGameOver(frame); break;
         }
+#if defined(ENABLE_PROFILER)
+        if (showProfiler) DrawProfilerOverlay(frame);
+#endif
+        PROFILE_END();
+
+        // The governor looks at the work only: the wait in EndDrawing is idle time.
+        // A new level changes how big the next particle bursts are (never the game);
+        // it reaches the simulation with the next input message.
+        QualityUpdate(&quality, GetTime() - frameStart);
+
+        // Swapping buffers (waits for vsync, if it is on)
+        double submitted = SimThreadNow();
+        PROFILE_BEGIN("Present");
         EndDrawing();
+        PROFILE_END();
+        if (frame->inputTime > 0) {
+            LatencyFrame times = { frame->inputTime, frame->time, submitted, SimThreadNow() };
+            LatencyRecord(&latency, &times);
+        }
+
+        // Normal mode: wait for the next frame here (what SetTargetFPS did)
+        PROFILE_BEGIN("Wait");
+        FramePacerEndFrame(&pacer);
+        PROFILE_END();
+
+        PROFILE_FRAME_END();
     }
 
     // --- Cleanup ---
+#if defined(ENABLE_PROFILER)
+    ProfilerStopCapture();
+#endif
+    SimThreadStop(&simThread);  // Let the last tick finish; sim is ours again
+    StopRecording();     // Closing the window mid-game still leaves a replay
+    StatsFeedClose(&statsFeed);
+    JobSystemDestroy(sim.jobs);
+    SnapshotRingDestroy(&history);
+    SimDestroy(&sim);
+    for (int f = 0; f < 3; f++) SimDestroy(&frames[f].sim);
+    JitterStats ticks = JitterTotal(&simThread.jitter), draws = JitterTotal(&frameJitter);
+    printf("sim ticks: %ld, %.2f ms apart, jitter %.3f ms, worst %.2f ms off, %ld catch-ups\n",
+           ticks.samples, ticks.mean, ticks.stddev, ticks.worst, simThread.catchUps);
+    printf("frames: %ld, %.2f ms apart, jitter %.3f ms, worst %.2f ms off, %ld input messages dropped\n",
+           draws.samples, draws.mean, draws.stddev, draws.worst, inputQueue.dropped);
+    printf("%s mode\n", lowLatency ? "low latency" : "normal");
+    LatencyPrint(&latency, stdout);
+    for (int p = 0; p < STATS_POOL_COUNT; p++) {
+        const StatsPool *pool = &poolStats.record.pools[p];
+        printf("%s: peak %d of %d, %lld of %lld spawns dropped\n", statsPoolNames[p], pool->peak, pool->capacity,
+               (long long)pool->dropped, (long long)pool->attempts);
+    }
+    UiStats ui = UiGetStats();
+    printf("ui cache: %d hits, %d re-renders\n", ui.hits, ui.renders);
+    printf("quality: ended at %s, %ld of %ld frames over the %.1f ms budget, %d steps down, %d up\n",
+           QualityCurrent(&quality)->name, quality.overruns, quality.frames, quality.budget * 1000.0,
+           quality.stepsDown, quality.stepsUp);
+    UiUnload();
+    BackgroundUnload();
+    RenderAtlasUnload();
     CloseWindow();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,254 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - PARTICLE KERNELS
+*
+*   The particle pool (see ParticlePool in sim.h) keeps every field in its own array,
+*   so one integration step is the same few multiply-adds over long runs of numbers.
+*   The fields are 16-bit fixed point: a 16 byte register holds 8 particles' x
+*   values, and a big pool moves less than half the memory it did as floats.
+*   The kernels widen to float, do the math, and round back with saturation:
+*   16 particles per loop with AVX2, 8 with SSE2, and a plain loop everywhere else
+*   that rounds the same way. The right version is picked at compile time from
+*   the compiler's target flags (-mavx2 / -march=native).
+*
+********************************************************************************************/
+
+#include "sim.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define PARTICLE_KERNEL "avx2"
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PARTICLE_KERNEL "sse2"
+#else
+    #define PARTICLE_KERNEL "scalar"
+#endif
+
+const char *ParticleKernelName(void) {
+    return PARTICLE_KERNEL;
+}
+
+// =====================================================================
+// MEMORY
+// =====================================================================
+// Ten arrays of capacity entries each, taken from an arena
+
+size_t ParticlePoolArenaSize(int capacity) {
+    return 8 * ArenaAlignedSize((size_t)capacity * sizeof(int16_t)) +
+           2 * ArenaAlignedSize((size_t)capacity * sizeof(uint8_t));
+}
+
+bool ParticlePoolCarve(ParticlePool *pool, Arena *arena, int capacity) {
+    size_t shorts = (size_t)capacity * sizeof(int16_t);
+    pool->x = ArenaAlloc(arena, shorts);
+    pool->y = ArenaAlloc(arena, shorts);
+    pool->prev_x = ArenaAlloc(arena, shorts);
+    pool->prev_y = ArenaAlloc(arena, shorts);
+    pool->vx = ArenaAlloc(arena, shorts);
+    pool->vy = ArenaAlloc(arena, shorts);
+    pool->lifetime = ArenaAlloc(arena, shorts);
+    pool->max_lifetime = ArenaAlloc(arena, shorts);
+    pool->radius = ArenaAlloc(arena, (size_t)capacity);
+    pool->color = ArenaAlloc(arena, (size_t)capacity);
+    PoolInit(&pool->slots, capacity);
+    pool->originY = 0.0f;
+    return pool->color != NULL;     // The last one fails first
+}
+
+// =====================================================================
+// UPDATE
+// =====================================================================
+
+// Number of set bits in a SIMD compare mask
+static inline int PopCount(int mask) {
+    int n = 0;
+    for (; mask; mask &= mask - 1) n++;
+    return n;
+}
+
+// Float to int16 the way the SIMD loops do it: round to nearest (or truncate
+// toward zero), then saturate
+static inline int16_t Saturate(float value) {
+    if (value < -32768.0f) return INT16_MIN;
+    if (value > 32767.0f) return INT16_MAX;
+    return (int16_t)value;
+}
+
+// One particle: remember where it was, move it, age it, slow it down.
+// The SIMD loops below do exactly this for several particles at once.
+// step turns a velocity into a position change, lifeStep is dt in lifetime units.
+static inline int IntegrateOne(ParticlePool *pool, int i, float step, int lifeStep, float drag) {
+    pool->prev_x[i] = pool->x[i];
+    pool->prev_y[i] = pool->y[i];
+    pool->x[i] = Saturate(rintf(pool->x[i] + pool->vx[i] * step));
+    pool->y[i] = Saturate(rintf(pool->y[i] + pool->vy[i] * step));
+    pool->vx[i] = Saturate(pool->vx[i] * drag);
+    pool->vy[i] = Saturate(pool->vy[i] * drag);
+    int life = pool->lifetime[i] - lifeStep;
+    pool->lifetime[i] = (int16_t)(life < INT16_MIN ? INT16_MIN : life);
+    return pool->lifetime[i] <= 0;
+}
+
+#if defined(__AVX2__)
+// 16 int16 lanes to two registers of 8 floats, and back
+static inline void Widen256(__m256i v, __m256 *lo, __m256 *hi) {
+    *lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));
+    *hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));
+}
+
+// packs works inside each 128-bit half, the permute puts the lanes back in order
+static inline __m256i Narrow256(__m256i lo, __m256i hi) {
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+}
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+// 8 int16 lanes to two registers of 4 floats (sign extended by the shift)
+static inline void Widen128(__m128i v, __m128 *lo, __m128 *hi) {
+    *lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+    *hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+#endif
+
+// Returns how many particles ran out of lifetime, so the caller can skip
+// the compaction pass on the (common) ticks where nothing expired
+int ParticlePoolIntegrate(ParticlePool *pool, float dt, float drag) {
+    return ParticlePoolIntegrateRange(pool, 0, pool->slots.count, dt, drag);
+}
+
+// Particles don't affect each other, so disjoint ranges can run on different threads
+int ParticlePoolIntegrateRange(ParticlePool *pool, int begin, int end, float dt, float drag) {
+    int i = begin;
+    int n = end;
+    int expired = 0;
+    float step = dt * PARTICLE_POSITION_SCALE / PARTICLE_VELOCITY_SCALE;
+    int lifeStep = (int)lrintf(dt * PARTICLE_LIFETIME_SCALE);
+    if (lifeStep > INT16_MAX) lifeStep = INT16_MAX;
+
+#if defined(__AVX2__)
+    __m256 vstep = _mm256_set1_ps(step);
+    __m256 vdrag = _mm256_set1_ps(drag);
+    __m256i vlife = _mm256_set1_epi16((short)lifeStep);
+    __m256i one = _mm256_set1_epi16(1);
+    for (; i + 16 <= n; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&pool->x[i]);
+        __m256i y = _mm256_loadu_si256((const __m256i *)&pool->y[i]);
+        __m256i vx = _mm256_loadu_si256((const __m256i *)&pool->vx[i]);
+        __m256i vy = _mm256_loadu_si256((const __m256i *)&pool->vy[i]);
+        _mm256_storeu_si256((__m256i *)&pool->prev_x[i], x);
+        _mm256_storeu_si256((__m256i *)&pool->prev_y[i], y);
+
+        __m256 xl, xh, yl, yh, vxl, vxh, vyl, vyh;
+        Widen256(x, &xl, &xh);
+        Widen256(y, &yl, &yh);
+        Widen256(vx, &vxl, &vxh);
+        Widen256(vy, &vyl, &vyh);
+        xl = _mm256_add_ps(xl, _mm256_mul_ps(vxl, vstep));
+        xh = _mm256_add_ps(xh, _mm256_mul_ps(vxh, vstep));
+        yl = _mm256_add_ps(yl, _mm256_mul_ps(vyl, vstep));
+        yh = _mm256_add_ps(yh, _mm256_mul_ps(vyh, vstep));
+        _mm256_storeu_si256((__m256i *)&pool->x[i], Narrow256(_mm256_cvtps_epi32(xl), _mm256_cvtps_epi32(xh)));
+        _mm256_storeu_si256((__m256i *)&pool->y[i], Narrow256(_mm256_cvtps_epi32(yl), _mm256_cvtps_epi32(yh)));
+        _mm256_storeu_si256((__m256i *)&pool->vx[i], Narrow256(_mm256_cvttps_epi32(_mm256_mul_ps(vxl, vdrag)),
+                                                               _mm256_cvttps_epi32(_mm256_mul_ps(vxh, vdrag))));
+        _mm256_storeu_si256((__m256i *)&pool->vy[i], Narrow256(_mm256_cvttps_epi32(_mm256_mul_ps(vyl, vdrag)),
+                                                               _mm256_cvttps_epi32(_mm256_mul_ps(vyh, vdrag))));
+
+        __m256i life = _mm256_subs_epi16(_mm256_loadu_si256((const __m256i *)&pool->lifetime[i]), vlife);
+        _mm256_storeu_si256((__m256i *)&pool->lifetime[i], life);
+        expired += PopCount(_mm256_movemask_epi8(_mm256_cmpgt_epi16(one, life))) / 2;  // Two mask bits per lane
+    }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    __m128 vstep = _mm_set1_ps(step);
+    __m128 vdrag = _mm_set1_ps(drag);
+    __m128i vlife = _mm_set1_epi16((short)lifeStep);
+    __m128i one = _mm_set1_epi16(1);
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)&pool->x[i]);
+        __m128i y = _mm_loadu_si128((const __m128i *)&pool->y[i]);
+        __m128i vx = _mm_loadu_si128((const __m128i *)&pool->vx[i]);
+        __m128i vy = _mm_loadu_si128((const __m128i *)&pool->vy[i]);
+        _mm_storeu_si128((__m128i *)&pool->prev_x[i], x);
+        _mm_storeu_si128((__m128i *)&pool->prev_y[i], y);
+
+        __m128 xl, xh, yl, yh, vxl, vxh, vyl, vyh;
+        Widen128(x, &xl, &xh);
+        Widen128(y, &yl, &yh);
+        Widen128(vx, &vxl, &vxh);
+        Widen128(vy, &vyl, &vyh);
+        xl = _mm_add_ps(xl, _mm_mul_ps(vxl, vstep));
+        xh = _mm_add_ps(xh, _mm_mul_ps(vxh, vstep));
+        yl = _mm_add_ps(yl, _mm_mul_ps(vyl, vstep));
+        yh = _mm_add_ps(yh, _mm_mul_ps(vyh, vstep));
+        _mm_storeu_si128((__m128i *)&pool->x[i], _mm_packs_epi32(_mm_cvtps_epi32(xl), _mm_cvtps_epi32(xh)));
+        _mm_storeu_si128((__m128i *)&pool->y[i], _mm_packs_epi32(_mm_cvtps_epi32(yl), _mm_cvtps_epi32(yh)));
+        _mm_storeu_si128((__m128i *)&pool->vx[i], _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(vxl, vdrag)),
+                                                                  _mm_cvttps_epi32(_mm_mul_ps(vxh, vdrag))));
+        _mm_storeu_si128((__m128i *)&pool->vy[i], _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(vyl, vdrag)),
+                                                                  _mm_cvttps_epi32(_mm_mul_ps(vyh, vdrag))));
+
+        __m128i life = _mm_subs_epi16(_mm_loadu_si128((const __m128i *)&pool->lifetime[i]), vlife);
+        _mm_storeu_si128((__m128i *)&pool->lifetime[i], life);
+        expired += PopCount(_mm_movemask_epi8(_mm_cmplt_epi16(life, one))) / 2;   // Two mask bits per lane
+    }
+#endif
+
+    // Leftovers (and the whole pool on the scalar build)
+    for (; i < n; i++) expired += IntegrateOne(pool, i, step, lifeStep, drag);
+    return expired;
+}
+
+// Move the last live particle into each expired slot. Order changes, but
+// particles are independent of each other so nobody can tell.
+static inline void MoveParticle(ParticlePool *pool, int to, int from) {
+    pool->x[to] = pool->x[from];
+    pool->y[to] = pool->y[from];
+    pool->prev_x[to] = pool->prev_x[from];
+    pool->prev_y[to] = pool->prev_y[from];
+    pool->vx[to] = pool->vx[from];
+    pool->vy[to] = pool->vy[from];
+    pool->lifetime[to] = pool->lifetime[from];
+    pool->max_lifetime[to] = pool->max_lifetime[from];
+    pool->radius[to] = pool->radius[from];
+    pool->color[to] = pool->color[from];
+}
+
+void ParticlePoolRemoveExpired(ParticlePool *pool) {
+    int i = 0;
+    while (i < pool->slots.count) {
+        if (pool->lifetime[i] <= 0) {
+            MoveParticle(pool, i, PoolRemove(&pool->slots, i));
+        } else {
+            i++;
+        }
+    }
+}
+
+// The origin moves by whole pixels, so every particle moves by a whole number
+// of fixed-point steps and lands exactly where it was. One that would end up
+// out of range is clamped to the edge, far off screen, and burns out there.
+void ParticlePoolRebase(ParticlePool *pool, float originY) {
+    int shift = (int)((pool->originY - originY) * PARTICLE_POSITION_SCALE);
+    for (int i = 0; i < pool->slots.count; i++) {
+        pool->y[i] = Saturate((float)(pool->y[i] + shift));
+        pool->prev_y[i] = Saturate((float)(pool->prev_y[i] + shift));
+    }
+    pool->originY = originY;
+}
+
+void ParticlePoolCopy(ParticlePool *dst, const ParticlePool *src) {
+    size_t shorts = (size_t)src->slots.count * sizeof(int16_t);
+    memcpy(dst->x, src->x, shorts);
+    memcpy(dst->y, src->y, shorts);
+    memcpy(dst->prev_x, src->prev_x, shorts);
+    memcpy(dst->prev_y, src->prev_y, shorts);
+    memcpy(dst->vx, src->vx, shorts);
+    memcpy(dst->vy, src->vy, shorts);
+    memcpy(dst->lifetime, src->lifetime, shorts);
+    memcpy(dst->max_lifetime, src->max_lifetime, shorts);
+    memcpy(dst->radius, src->radius, (size_t)src->slots.count);
+    memcpy(dst->color, src->color, (size_t)src->slots.count);
+    dst->slots = src->slots;            // Count and counters (same capacity)
+    dst->originY = src->originY;
+}
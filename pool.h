@@ -0,0 +1,87 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - ENTITY POOLS
+*
+*   A Pool hands out slots in a fixed-capacity array and keeps every live entity packed
+*   at the front, in [0, count). Because of that packing the free slots are always the
+*   tail [count, capacity), so the "free list" is just the count itself:
+*
+*     - spawning takes the next slots at the end:          O(1), no searching
+*     - despawning moves the last live entity into the hole: O(1) ("swap-remove")
+*     - update and draw loops run over [0, count) and never see a dead slot
+*
+*   The pool only manages indices; the entity data stays in ordinary typed arrays, so
+*   it works for arrays of structs (bullets, enemies) and structures of arrays
+*   (particles) alike:
+*
+*     int i;
+*     if (PoolSpawn(&sim->bulletPool, 1, &i)) sim->bullets[i] = ...;
+*
+*     int last = PoolRemove(&sim->bulletPool, i);
+*     sim->bullets[i] = sim->bullets[last];
+*
+*   A full pool refuses spawns instead of growing, so every pool also counts what it
+*   was asked for and what it had to refuse: a game that drops shots or cuts
+*   explosions short shows up in the numbers (see stats_feed.h) instead of just
+*   looking a little off.
+*
+********************************************************************************************/
+
+#ifndef POOL_H
+#define POOL_H
+
+typedef struct {
+    int  count;     // Live entities, packed into [0, count)
+    int  capacity;  // Size of the backing array
+    int  peak;      // Highest count so far (the high-water mark)
+    long attempts;  // Entities asked for by PoolSpawn and PoolRefuse
+    long dropped;   // Of those, how many didn't get a slot
+} Pool;
+
+// Also resets the counters: they count since the pool was (re)initialized
+static inline void PoolInit(Pool *pool, int capacity) {
+    pool->count = 0;
+    pool->capacity = capacity;
+    pool->peak = 0;
+    pool->attempts = 0;
+    pool->dropped = 0;
+}
+
+// Reserve up to n consecutive slots in one go. Returns how many were granted
+// (less than n when the pool is nearly full); *first is the first new index.
+static inline int PoolSpawn(Pool *pool, int n, int *first) {
+    int available = pool->capacity - pool->count;
+    int granted = n < available ? n : available;
+    if (granted < 0) granted = 0;
+    if (n > 0) {
+        pool->attempts += n;
+        pool->dropped += n - granted;
+    }
+    *first = pool->count;
+    pool->count += granted;
+    if (pool->count > pool->peak) pool->peak = pool->count;
+    return granted;
+}
+
+// Count n entities that were refused without calling PoolSpawn (a caller that
+// checks for room first, before doing any work for the new entity)
+static inline void PoolRefuse(Pool *pool, int n) {
+    pool->attempts += n;
+    pool->dropped += n;
+}
+
+// Free slot index. Returns the index of the entity that must be moved into the
+// hole (the old last one); when that equals index, nothing needs to move.
+// A loop that removes while iterating must look at the same index again.
+static inline int PoolRemove(Pool *pool, int index) {
+    (void)index;    // Only here so call sites read naturally
+    pool->count--;
+    return pool->count;
+}
+
+// Remove everything at once (e.g. for a new game): O(1)
+static inline void PoolClear(Pool *pool) {
+    pool->count = 0;
+}
+
+#endif // POOL_H
@@ -0,0 +1,388 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - FRAME PROFILER
+*
+*   See profiler.h. Everything here is compiled out without -DENABLE_PROFILER.
+*
+********************************************************************************************/
+
+#include "profiler.h"
+
+#if defined(ENABLE_PROFILER)
+
+#include "timer.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char *name;
+    int         parent;                     // Zone index, -1 at the top
+    int         thread;                     // Whose top level zone it is (or is under)
+    int         depth;
+    double      frameTime;                  // Seconds so far this frame
+    double      totalTime;                  // Seconds since the last ProfilerReset
+    int         frameCalls;
+    float       history[PROFILER_HISTORY];  // Milliseconds per frame, ring buffer
+    int         lastCalls;
+} Zone;
+
+// A thread's own zone: the same (name, parent) pairs, numbered by that thread
+typedef struct {
+    const char *name;
+    int         parent;                     // Local zone, -1 at the top
+} LocalZone;
+
+// One closed zone instance (a local zone of the thread that closed it)
+typedef struct {
+    int    zone;
+    double start;
+    double end;
+} ZoneEvent;
+
+// Everything one thread needs to open and close zones without a lock. The ring
+// has one writer (the thread) and one reader (the merge in ProfilerFrameEnd).
+typedef struct {
+    LocalZone   zones[PROFILER_MAX_ZONES];
+    int         zoneCount;
+    int         stack[PROFILER_MAX_DEPTH];  // Open zones
+    double      stackStart[PROFILER_MAX_DEPTH];
+    int         depth;
+    int         overflow;                   // Zones opened past PROFILER_MAX_DEPTH
+    ZoneEvent   events[PROFILER_MAX_EVENTS];
+    _Atomic unsigned long long head;        // Events written
+    _Atomic unsigned long long tail;        // Events merged
+    const char *name;
+    atomic_bool ready;
+
+    // Only the merge touches these
+    int         global[PROFILER_MAX_ZONES]; // Its local zones in profiler.zones (-1: not looked up)
+    bool        traced;                     // Named in the current trace
+} ProfilerThread;
+
+static struct {
+    Zone           zones[PROFILER_MAX_ZONES];   // In tree order
+    int            zoneCount;
+
+    ProfilerThread threads[PROFILER_MAX_THREADS];
+    atomic_int     threadCount;
+
+    long           frame;                   // Frames completed
+    double         frameStart;
+
+    FILE          *trace;
+    FILE          *csv;
+    double         captureStart;
+    bool           firstTraceEvent;
+} profiler;
+
+static _Thread_local ProfilerThread *self;  // NULL until the thread's first zone
+static _Thread_local bool noSlot;           // More threads than PROFILER_MAX_THREADS: left out
+
+static ProfilerThread *Self(void) {
+    if (self || noSlot) return self;
+    int slot = atomic_fetch_add(&profiler.threadCount, 1);
+    if (slot >= PROFILER_MAX_THREADS) {
+        noSlot = true;
+        return NULL;
+    }
+    self = &profiler.threads[slot];
+    for (int z = 0; z < PROFILER_MAX_ZONES; z++) self->global[z] = -1;
+    atomic_store_explicit(&self->ready, true, memory_order_release);
+    return self;
+}
+
+// Trace row of a thread
+static int ThreadId(const ProfilerThread *thread) {
+    return (int)(thread - profiler.threads) + 1;
+}
+
+void ProfilerNameThread(const char *name) {
+    ProfilerThread *thread = Self();
+    if (thread) thread->name = name;
+}
+
+// =====================================================================
+// ANY THREAD: OPENING AND CLOSING ZONES
+// =====================================================================
+
+static int FindLocalZone(ProfilerThread *thread, const char *name, int parent) {
+    for (int z = 0; z < thread->zoneCount; z++) {
+        const LocalZone *zone = &thread->zones[z];
+        if (zone->parent == parent && (zone->name == name || strcmp(zone->name, name) == 0)) return z;
+    }
+    if (thread->zoneCount == PROFILER_MAX_ZONES) return -1;
+    // Written before any event that uses it is published (release in ProfilerEndZone)
+    thread->zones[thread->zoneCount] = (LocalZone){ name, parent };
+    return thread->zoneCount++;
+}
+
+void ProfilerBeginZone(const char *name) {
+    ProfilerThread *thread = Self();
+    if (!thread) return;
+    if (thread->depth == PROFILER_MAX_DEPTH) {
+        thread->overflow++;
+        return;
+    }
+    // -2: out of zones. Its children are left out too, instead of becoming top level zones.
+    int parent = thread->depth > 0 ? thread->stack[thread->depth - 1] : -1;
+    int zone = parent == -2 ? -1 : FindLocalZone(thread, name, parent);
+    thread->stack[thread->depth] = zone < 0 ? -2 : zone;
+    thread->stackStart[thread->depth] = TimerNow();
+    thread->depth++;
+}
+
+void ProfilerEndZone(void) {
+    ProfilerThread *thread = Self();
+    if (!thread) return;
+    double now = TimerNow();
+    if (thread->overflow > 0) {
+        thread->overflow--;
+        return;
+    }
+    if (thread->depth == 0) return;     // Unbalanced END
+
+    thread->depth--;
+    int z = thread->stack[thread->depth];
+    if (z < 0) return;
+
+    // A full ring (nobody has ended a frame for a while) drops the event
+    unsigned long long head = atomic_load_explicit(&thread->head, memory_order_relaxed);
+    unsigned long long tail = atomic_load_explicit(&thread->tail, memory_order_acquire);
+    if (head - tail == PROFILER_MAX_EVENTS) return;
+    thread->events[head % PROFILER_MAX_EVENTS] = (ZoneEvent){ z, thread->stackStart[thread->depth], now };
+    atomic_store_explicit(&thread->head, head + 1, memory_order_release);
+}
+
+// =====================================================================
+// MAIN THREAD: FRAMES AND MERGING
+// =====================================================================
+
+// Registered, with its merge-side state set up
+static bool ThreadReady(int t) {
+    return t < atomic_load_explicit(&profiler.threadCount, memory_order_acquire) &&
+           atomic_load_explicit(&profiler.threads[t].ready, memory_order_acquire);
+}
+
+// The same name under a different parent is a different zone, so the tree
+// keeps "Stars" in the update apart from "Stars" in the drawing. A new zone goes
+// in after its parent's last descendant, so the list stays in tree order.
+static int FindZone(const char *name, int parent, int thread) {
+    for (int z = 0; z < profiler.zoneCount; z++) {
+        const Zone *zone = &profiler.zones[z];
+        if (zone->parent == parent && zone->thread == thread &&
+            (zone->name == name || strcmp(zone->name, name) == 0)) return z;
+    }
+    if (profiler.zoneCount == PROFILER_MAX_ZONES) return -1;
+
+    int at = profiler.zoneCount;
+    if (parent >= 0) {
+        for (at = parent + 1; at < profiler.zoneCount && profiler.zones[at].depth > profiler.zones[parent].depth; at++) {}
+    }
+    memmove(&profiler.zones[at + 1], &profiler.zones[at], (size_t)(profiler.zoneCount - at) * sizeof(Zone));
+    profiler.zoneCount++;
+    for (int z = 0; z < profiler.zoneCount; z++) {
+        if (z != at && profiler.zones[z].parent >= at) profiler.zones[z].parent++;
+    }
+    for (int t = 0; t < PROFILER_MAX_THREADS; t++) {
+        if (!ThreadReady(t)) continue;
+        for (int l = 0; l < PROFILER_MAX_ZONES; l++) {
+            if (profiler.threads[t].global[l] >= at) profiler.threads[t].global[l]++;
+        }
+    }
+
+    Zone *zone = &profiler.zones[at];
+    memset(zone, 0, sizeof(*zone));
+    zone->name = name;
+    zone->parent = parent;
+    zone->thread = thread;
+    zone->depth = parent < 0 ? 0 : profiler.zones[parent].depth + 1;
+    return at;
+}
+
+// A thread's local zone in profiler.zones, its parents first
+static int GlobalZone(ProfilerThread *thread, int local) {
+    if (thread->global[local] >= 0) return thread->global[local];
+    int parent = -1;
+    if (thread->zones[local].parent >= 0) {
+        parent = GlobalZone(thread, thread->zones[local].parent);
+        if (parent < 0) return -1;
+    }
+    thread->global[local] = FindZone(thread->zones[local].name, parent, ThreadId(thread));
+    return thread->global[local];
+}
+
+// Move a thread's closed zones into the frame's totals (and the trace)
+static void MergeThread(ProfilerThread *thread) {
+    unsigned long long head = atomic_load_explicit(&thread->head, memory_order_acquire);
+    unsigned long long tail = atomic_load_explicit(&thread->tail, memory_order_relaxed);
+    if (profiler.trace && !thread->traced && head != tail) {
+        // Metadata event: the thread's row gets its name
+        fprintf(profiler.trace, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                ThreadId(thread), thread->name ? thread->name : "Thread");
+        thread->traced = true;
+    }
+    for (; tail != head; tail++) {
+        const ZoneEvent *ev = &thread->events[tail % PROFILER_MAX_EVENTS];
+        int z = GlobalZone(thread, ev->zone);
+        if (z < 0) continue;
+        profiler.zones[z].frameTime += ev->end - ev->start;
+        profiler.zones[z].totalTime += ev->end - ev->start;
+        profiler.zones[z].frameCalls++;
+        if (profiler.trace) {
+            fprintf(profiler.trace, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    profiler.zones[z].name, ThreadId(thread),
+                    (ev->start - profiler.captureStart) * 1e6, (ev->end - ev->start) * 1e6);
+        }
+    }
+    atomic_store_explicit(&thread->tail, tail, memory_order_release);
+}
+
+void ProfilerFrameBegin(void) {
+    ProfilerThread *thread = Self();
+    profiler.frameStart = TimerNow();
+    if (!thread) return;
+    if (!thread->name) thread->name = "Main";
+    thread->depth = 0;
+    thread->overflow = 0;
+}
+
+static void WriteCsv(double frameEnd) {
+    fprintf(profiler.csv, "%ld,Frame,0,1,%.4f\n", profiler.frame, (frameEnd - profiler.frameStart) * 1e3);
+    for (int z = 0; z < profiler.zoneCount; z++) {
+        const Zone *zone = &profiler.zones[z];
+        if (zone->frameCalls == 0) continue;
+        fprintf(profiler.csv, "%ld,%s,%d,%d,%.4f\n", profiler.frame, zone->name,
+                zone->depth + 1, zone->frameCalls, zone->frameTime * 1e3);
+    }
+}
+
+void ProfilerFrameEnd(void) {
+    double now = TimerNow();
+    if (profiler.trace) {
+        // Complete ("X") events, timestamps in microseconds since the capture began
+        fprintf(profiler.trace, "%s{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%ld}}",
+                profiler.firstTraceEvent ? "" : ",\n", self ? ThreadId(self) : 1,
+                (profiler.frameStart - profiler.captureStart) * 1e6,
+                (now - profiler.frameStart) * 1e6, profiler.frame);
+        profiler.firstTraceEvent = false;
+    }
+    for (int t = 0; t < PROFILER_MAX_THREADS; t++) {
+        if (ThreadReady(t)) MergeThread(&profiler.threads[t]);
+    }
+    if (profiler.csv) WriteCsv(now);
+
+    // Zones that didn't run this frame count as 0 ms
+    int slot = (int)(profiler.frame % PROFILER_HISTORY);
+    for (int z = 0; z < profiler.zoneCount; z++) {
+        Zone *zone = &profiler.zones[z];
+        zone->history[slot] = (float)(zone->frameTime * 1e3);
+        zone->lastCalls = zone->frameCalls;
+        zone->frameTime = 0;
+        zone->frameCalls = 0;
+    }
+    profiler.frame++;
+}
+
+int ProfilerFindZone(const char *name, int parent) {
+    for (int z = 0; z < profiler.zoneCount; z++) {
+        if (profiler.zones[z].parent == parent && strcmp(profiler.zones[z].name, name) == 0) return z;
+    }
+    return -1;
+}
+
+double ProfilerZoneTotal(int zone) {
+    return zone >= 0 ? profiler.zones[zone].totalTime : 0.0;
+}
+
+// Zones closed before the reset are thrown away, and every thread's zones are
+// looked up again
+void ProfilerReset(void) {
+    profiler.zoneCount = 0;
+    profiler.frame = 0;
+    for (int t = 0; t < PROFILER_MAX_THREADS; t++) {
+        if (!ThreadReady(t)) continue;
+        ProfilerThread *thread = &profiler.threads[t];
+        for (int z = 0; z < PROFILER_MAX_ZONES; z++) thread->global[z] = -1;
+        atomic_store_explicit(&thread->tail, atomic_load_explicit(&thread->head, memory_order_acquire),
+                              memory_order_release);
+    }
+    if (self) {
+        self->depth = 0;
+        self->overflow = 0;
+    }
+}
+
+int ProfilerZoneCount(void) { return profiler.zoneCount; }
+const char *ProfilerZoneName(int zone) { return profiler.zones[zone].name; }
+int ProfilerZoneDepth(int zone) { return profiler.zones[zone].depth; }
+long ProfilerFrameCount(void) { return profiler.frame; }
+
+static int CompareFloats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+ProfilerStats ProfilerZoneStats(int zone) {
+    const Zone *z = &profiler.zones[zone];
+    ProfilerStats stats = { 0 };
+    int n = profiler.frame < PROFILER_HISTORY ? (int)profiler.frame : PROFILER_HISTORY;
+    if (n == 0) return stats;
+
+    float sorted[PROFILER_HISTORY];
+    memcpy(sorted, z->history, (size_t)n * sizeof(float));
+    qsort(sorted, (size_t)n, sizeof(float), CompareFloats);
+
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += sorted[i];
+    stats.last = z->history[(profiler.frame - 1) % PROFILER_HISTORY];
+    stats.min = sorted[0];
+    stats.avg = (float)(sum / n);
+    stats.p99 = sorted[(n * 99) / 100 < n ? (n * 99) / 100 : n - 1];
+    stats.calls = z->lastCalls;
+    return stats;
+}
+
+bool ProfilerStartCapture(const char *tracePath, const char *csvPath) {
+    ProfilerStopCapture();
+    if (tracePath) {
+        profiler.trace = fopen(tracePath, "w");
+        if (!profiler.trace) return false;
+        fputs("{\"traceEvents\":[\n", profiler.trace);
+        profiler.firstTraceEvent = true;
+    }
+    if (csvPath) {
+        profiler.csv = fopen(csvPath, "w");
+        if (!profiler.csv) {
+            ProfilerStopCapture();
+            return false;
+        }
+        fputs("frame,zone,depth,calls,ms\n", profiler.csv);
+    }
+    for (int t = 0; t < PROFILER_MAX_THREADS; t++) profiler.threads[t].traced = false;
+    profiler.captureStart = TimerNow();
+    return true;
+}
+
+void ProfilerStopCapture(void) {
+    if (profiler.trace) {
+        fputs("\n],\"displayTimeUnit\":\"ms\"}\n", profiler.trace);
+        fclose(profiler.trace);
+        profiler.trace = NULL;
+    }
+    if (profiler.csv) {
+        fclose(profiler.csv);
+        profiler.csv = NULL;
+    }
+}
+
+bool ProfilerCapturing(void) {
+    return profiler.trace || profiler.csv;
+}
+
+#else
+
+typedef int ProfilerDisabled;   // ISO C doesn't allow an empty file
+
+#endif // ENABLE_PROFILER
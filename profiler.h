@@ -0,0 +1,98 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - FRAME PROFILER
+*
+*   Named timing zones that nest, so a frame can be broken down as a tree:
+*
+*     PROFILE_FRAME_BEGIN();
+*     PROFILE_BEGIN("Update");
+*         PROFILE_BEGIN("Collision"); ... PROFILE_END();
+*     PROFILE_END();
+*     PROFILE_FRAME_END();
+*
+*   For every zone the profiler keeps the time per frame over the last
+*   PROFILER_HISTORY frames (min / avg / p99 for the overlay in main.c), and it can
+*   record frames to a Chrome trace (chrome://tracing or ui.perfetto.dev) and to a
+*   CSV log with one row per zone per frame.
+*
+*   All of it only exists when compiled with -DENABLE_PROFILER. Otherwise the
+*   PROFILE_* macros expand to nothing and profiler.c is empty, so the release
+*   build doesn't even read the clock.
+*
+*   Zones can be opened on any thread; each thread has its own stack of open
+*   zones and its own ring of closed ones, so zones never need a lock. The thread
+*   that ends frames (the main thread) merges every thread's ring in
+*   ProfilerFrameEnd: a zone counts in the frame in which it closed, and the
+*   trace shows each thread on its own row. A thread's top level zones are its
+*   own, so the simulation thread's "Input" is not the main thread's "Input".
+*   Everything except opening and closing zones (frames, statistics, captures)
+*   belongs to the main thread. The job system's workers run inside the zone
+*   that started them and open none of their own.
+*
+********************************************************************************************/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+#define PROFILER_MAX_ZONES      64      // Distinct (name, parent) pairs
+#define PROFILER_MAX_DEPTH      16
+#define PROFILER_MAX_EVENTS     4096    // Closed zones a thread can hold until the next merge
+#define PROFILER_MAX_THREADS    4       // Threads that ever open a zone
+#define PROFILER_HISTORY        240     // Frames the rolling statistics cover
+
+#if defined(ENABLE_PROFILER)
+    #define PROFILE_FRAME_BEGIN()   ProfilerFrameBegin()
+    #define PROFILE_FRAME_END()     ProfilerFrameEnd()
+    #define PROFILE_BEGIN(name)     ProfilerBeginZone(name)
+    #define PROFILE_END()           ProfilerEndZone()
+    #define PROFILE_THREAD(name)    ProfilerNameThread(name)
+#else
+    #define PROFILE_FRAME_BEGIN()   ((void)0)
+    #define PROFILE_FRAME_END()     ((void)0)
+    #define PROFILE_BEGIN(name)     ((void)0)
+    #define PROFILE_END()           ((void)0)
+    #define PROFILE_THREAD(name)    ((void)0)
+#endif
+
+// Milliseconds a zone took per frame (summed over all its calls in that frame)
+typedef struct {
+    float last;
+    float min;
+    float avg;
+    float p99;
+    int   calls;        // Calls in the last frame
+} ProfilerStats;
+
+#if defined(ENABLE_PROFILER)
+
+// Use the macros above; these are what they call
+void ProfilerFrameBegin(void);
+void ProfilerFrameEnd(void);
+void ProfilerBeginZone(const char *name);   // name must stay valid (a string literal)
+void ProfilerEndZone(void);
+void ProfilerNameThread(const char *name);  // Its row in the trace; call before its first zone
+
+// Zones in the order they were first seen, which is tree order
+int           ProfilerZoneCount(void);
+const char   *ProfilerZoneName(int zone);
+int           ProfilerZoneDepth(int zone);
+ProfilerStats ProfilerZoneStats(int zone);
+long          ProfilerFrameCount(void);
+
+// For benchmarks: look a zone up (parent -1 for top level zones; returns -1 if
+// it never ran), read its total time since the last reset, or forget everything
+int           ProfilerFindZone(const char *name, int parent);
+double        ProfilerZoneTotal(int zone);  // Seconds
+void          ProfilerReset(void);
+
+// Record every following frame until ProfilerStopCapture. Either path may be
+// NULL. Returns false if a file couldn't be opened.
+bool ProfilerStartCapture(const char *tracePath, const char *csvPath);
+void ProfilerStopCapture(void);
+bool ProfilerCapturing(void);
+
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,59 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - ADAPTIVE QUALITY
+*
+*   The quality levels and the governor that picks one (see quality.h).
+*
+********************************************************************************************/
+
+#include "quality.h"
+
+const QualitySettings qualityLevels[QUALITY_LEVEL_COUNT] = {
+    //                  particles  bullet glow  particle glow  star layers
+    [QUALITY_HIGH]    = { "high",    1.0f,  2, true,  4 },
+    [QUALITY_MEDIUM]  = { "medium",  0.6f,  1, true,  4 },
+    [QUALITY_LOW]     = { "low",     0.35f, 1, false, 3 },
+    [QUALITY_MINIMAL] = { "minimal", 0.15f, 0, false, 2 },
+};
+
+void QualityInit(QualityGovernor *governor, double budget) {
+    *governor = (QualityGovernor){ 0 };
+    governor->budget = budget > 0 ? budget : QUALITY_DEFAULT_BUDGET;
+    governor->level = QUALITY_HIGH;
+}
+
+void QualityLock(QualityGovernor *governor, int level) {
+    if (level < 0) level = 0;
+    if (level >= QUALITY_LEVEL_COUNT) level = QUALITY_LEVEL_COUNT - 1;
+    governor->level = level;
+    governor->locked = true;
+}
+
+bool QualityUpdate(QualityGovernor *g, double frameTime) {
+    g->frames++;
+    if (frameTime > g->budget) g->overruns++;
+
+    // The first frame seeds the average instead of being blended into 0
+    if (g->frames == 1) g->average = frameTime;
+    else g->average += (frameTime - g->average) * QUALITY_AVERAGE_WEIGHT;
+
+    g->overFrames = g->average > g->budget ? g->overFrames + 1 : 0;
+    g->underFrames = g->average < g->budget * QUALITY_UP_HEADROOM ? g->underFrames + 1 : 0;
+    if (g->locked) return false;
+
+    int level = g->level;
+    if (g->overFrames >= QUALITY_DOWN_FRAMES && level < QUALITY_LEVEL_COUNT - 1) {
+        level++;
+        g->stepsDown++;
+    } else if (g->underFrames >= QUALITY_UP_FRAMES && level > 0) {
+        level--;
+        g->stepsUp++;
+    }
+    if (level == g->level) return false;
+
+    // Start counting again: the new level gets a full hold time before the next step
+    g->level = level;
+    g->overFrames = 0;
+    g->underFrames = 0;
+    return true;
+}
@@ -0,0 +1,79 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - ADAPTIVE QUALITY
+*
+*   On a slow machine the first things to go should be the ones that only look nice:
+*   the glow rings around bullets and particles, the size of explosion bursts and the
+*   density of the star background. The governor watches how long each frame's work
+*   takes (update and draw, not the wait for vsync) and moves between a few quality
+*   levels:
+*
+*     - one step down when the rolling average stays over the budget for a while,
+*     - one step up only after a much longer stretch well under the budget.
+*
+*   The two thresholds and hold times are far apart (hysteresis), so a frame time
+*   near the budget doesn't make the level flicker back and forth.
+*
+*   Nothing here changes the game: particles draw their randomness from their own
+*   generator (see sim.c), so a burst of 10 particles instead of 40 leaves every
+*   enemy, bullet and score exactly where it would have been. Pure C, no raylib.
+*
+********************************************************************************************/
+
+#ifndef QUALITY_H
+#define QUALITY_H
+
+#include <stdbool.h>
+
+#define QUALITY_DEFAULT_BUDGET  (1.0 / 60.0)    // Seconds of work per frame
+#define QUALITY_AVERAGE_WEIGHT  0.1             // Weight of a new frame in the rolling average
+#define QUALITY_DOWN_FRAMES     30              // Average over budget this long: step down
+#define QUALITY_UP_FRAMES       180             // Average under QUALITY_UP_HEADROOM this long: step up
+#define QUALITY_UP_HEADROOM     0.6             // Fraction of the budget
+
+typedef enum {
+    QUALITY_HIGH,
+    QUALITY_MEDIUM,
+    QUALITY_LOW,
+    QUALITY_MINIMAL,
+    QUALITY_LEVEL_COUNT
+} QualityLevel;
+
+// What a level turns on
+typedef struct {
+    const char *name;
+    float       particleScale;      // Multiplies every particle burst
+    int         bulletGlow;         // Glow rings around each bullet (0..2)
+    bool        particleGlow;       // Soft second circle around each particle
+    int         starLayers;         // Parallax layers drawn, the nearest ones first
+} QualitySettings;
+
+extern const QualitySettings qualityLevels[QUALITY_LEVEL_COUNT];
+
+typedef struct {
+    double budget;
+    double average;         // Rolling frame work time
+    int    level;           // QualityLevel
+    bool   locked;          // Fixed level (--quality=N): watch, but never change
+    int    overFrames;      // Frames in a row with the average over budget
+    int    underFrames;     // Frames in a row with it under the headroom
+    long   frames;
+    long   overruns;        // Frames that took longer than the budget
+    int    stepsDown;
+    int    stepsUp;
+} QualityGovernor;
+
+// Start at QUALITY_HIGH with this frame budget (seconds)
+void QualityInit(QualityGovernor *governor, double budget);
+
+// Pin a level (e.g. from the command line); the stats keep counting
+void QualityLock(QualityGovernor *governor, int level);
+
+// Report how long a frame's work took. Returns true if the level changed.
+bool QualityUpdate(QualityGovernor *governor, double frameTime);
+
+static inline const QualitySettings *QualityCurrent(const QualityGovernor *governor) {
+    return &qualityLevels[governor->level];
+}
+
+#endif // QUALITY_H
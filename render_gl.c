@@ -0,0 +1,129 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - RENDER QUEUE SUBMISSION
+*
+*   The only part of the render queue that talks to the GPU. Each batch becomes one
+*   rlBegin(RL_TRIANGLES) ... rlEnd(), so rlgl keeps appending to the same draw call
+*   until the blend mode changes (or its vertex buffer fills up, in which case
+*   rlCheckRenderBatchLimit flushes it for us).
+*
+*   Once the sprite atlas is baked (sprites.h), every batch is drawn with the atlas
+*   texture: sprites take their frame from it, plain shapes its white square. Without
+*   it the default white texture is used, as before.
+*
+*   Colors are drawn as premultiplied alpha (BLEND_ALPHA_PREMULTIPLY, the vertex
+*   color multiplied by its own alpha here). The atlas is baked through this same
+*   path onto a transparent texture, so it holds premultiplied pixels too, and a
+*   half transparent part (the engine flame) looks the same from the atlas as it
+*   did drawn directly. Additive batches are unchanged.
+*
+********************************************************************************************/
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "render_queue.h"
+#include "sprites.h"
+
+#define ATLAS_BAKE_COMMANDS 64      // Shapes in one frame of the atlas
+
+static RenderTexture2D atlasTexture;
+static bool            atlasLoaded = false;
+static float           atlasWidth, atlasHeight;
+static float           whiteU, whiteV;     // The middle of the white square
+
+static Color Premultiply(Color color) {
+    color.r = (unsigned char)(color.r * color.a / 255);
+    color.g = (unsigned char)(color.g * color.a / 255);
+    color.b = (unsigned char)(color.b * color.a / 255);
+    return color;
+}
+
+// Texture coordinates of a sprite's quad, in RenderCommandTessellate's vertex order.
+// Render textures are stored upside down, so v counts from the bottom.
+static void SpriteCoords(const RenderCommand *cmd, Vector2 *uv) {
+    float u0 = cmd->v[2] / atlasWidth, u1 = (cmd->v[2] + cmd->v[4]) / atlasWidth;
+    float top = 1.0f - cmd->v[3] / atlasHeight, bottom = 1.0f - (cmd->v[3] + cmd->v[5]) / atlasHeight;
+    uv[0] = (Vector2){ u0, top };    uv[1] = (Vector2){ u0, bottom }; uv[2] = (Vector2){ u1, bottom };
+    uv[3] = (Vector2){ u0, top };    uv[4] = (Vector2){ u1, bottom }; uv[5] = (Vector2){ u1, top };
+}
+
+void RenderQueueSubmit(const RenderQueue *queue) {
+    Vector2 vertices[RENDER_MAX_SHAPE_VERTICES];
+    Vector2 coords[6];
+
+    for (int b = 0; b < queue->batchCount; b++) {
+        const RenderBatch *batch = &queue->batches[b];
+        bool additive = batch->blend == RENDER_BLEND_ADDITIVE;
+
+        BeginBlendMode(additive ? BLEND_ADDITIVE : BLEND_ALPHA_PREMULTIPLY);
+        if (atlasLoaded) rlSetTexture(atlasTexture.texture.id);
+        rlBegin(RL_TRIANGLES);
+        for (int k = batch->first; k < batch->first + batch->count; k++) {
+            const RenderCommand *cmd = &queue->commands[queue->order[k]];
+            int n = RenderCommandTessellate(cmd, vertices);
+            Color color = additive ? cmd->color : Premultiply(cmd->color);
+
+            rlCheckRenderBatchLimit(n);
+            rlColor4ub(color.r, color.g, color.b, color.a);
+            if (cmd->shape == SHAPE_SPRITE && atlasLoaded) {
+                SpriteCoords(cmd, coords);
+                for (int i = 0; i < n; i++) {
+                    rlTexCoord2f(coords[i].x, coords[i].y);
+                    rlVertex2f(vertices[i].x, vertices[i].y);
+                }
+            } else {
+                for (int i = 0; i < n; i++) {
+                    if (atlasLoaded) rlTexCoord2f(whiteU, whiteV);
+                    rlVertex2f(vertices[i].x, vertices[i].y);
+                }
+            }
+        }
+        rlEnd();
+        if (atlasLoaded) rlSetTexture(0);
+        EndBlendMode();
+    }
+}
+
+// =====================================================================
+// SPRITE ATLAS
+// =====================================================================
+
+bool RenderAtlasLoad(const SpriteAtlas *atlas) {
+    static RenderCommand commands[ATLAS_BAKE_COMMANDS];
+    static int order[ATLAS_BAKE_COMMANDS];
+
+    RenderAtlasUnload();
+    atlasTexture = LoadRenderTexture(atlas->width, atlas->height);
+    if (atlasTexture.id == 0) return false;
+
+    // Every frame is drawn by RenderQueueSubmit itself, centered in its cell,
+    // while atlasLoaded is still false (so with the default white texture)
+    RenderQueue queue;
+    RenderQueueInit(&queue, commands, order, ATLAS_BAKE_COMMANDS);
+    BeginTextureMode(atlasTexture);
+    ClearBackground(BLANK);
+    DrawRectangle(atlas->whiteX, atlas->whiteY, 2, 2, WHITE);
+    for (int f = 0; f < atlas->frameCount; f++) {
+        const SpriteKind *kind = &atlas->kinds[SpriteFrameKind(atlas, f)];
+        Vector2 center = { atlas->frames[f].x + kind->width / 2.0f, atlas->frames[f].y + kind->height / 2.0f };
+
+        RenderQueueBegin(&queue);
+        SpritePushShapes(&queue, atlas, f, center);
+        RenderQueueSort(&queue);
+        RenderQueueSubmit(&queue);
+    }
+    EndTextureMode();
+
+    atlasWidth = (float)atlas->width;
+    atlasHeight = (float)atlas->height;
+    whiteU = (atlas->whiteX + 1.0f) / atlasWidth;
+    whiteV = 1.0f - (atlas->whiteY + 1.0f) / atlasHeight;
+    atlasLoaded = true;
+    return true;
+}
+
+void RenderAtlasUnload(void) {
+    if (!atlasLoaded) return;
+    UnloadRenderTexture(atlasTexture);
+    atlasLoaded = false;
+}
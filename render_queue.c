@@ -0,0 +1,257 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - RENDER COMMAND QUEUE
+*
+*   Queueing, sorting, batching and tessellation. No raylib calls in here (see
+*   render_queue.h); the vertex order of every shape matches what raylib's own
+*   DrawCircleV / DrawTriangle / DrawPoly / DrawRectanglePro emit, so back-face
+*   culling treats them exactly the same way.
+*
+********************************************************************************************/
+
+#include "render_queue.h"
+#include <math.h>
+#include <stddef.h>
+
+#define DEG2RAD_F   (PI / 180.0f)
+
+Color ColorWithAlpha(Color color, float alpha) {
+    if (alpha < 0.0f) alpha = 0.0f;
+    else if (alpha > 1.0f) alpha = 1.0f;
+    color.a = (unsigned char)(255.0f * alpha);
+    return color;
+}
+
+void RenderQueueInit(RenderQueue *queue, RenderCommand *commands, int *order, int capacity) {
+    queue->commands = commands;
+    queue->order = order;
+    queue->capacity = capacity;
+    RenderQueueBegin(queue);
+}
+
+void RenderQueueBegin(RenderQueue *queue) {
+    queue->count = 0;
+    queue->batchCount = 0;
+    queue->layer = LAYER_BULLETS;
+    queue->blend = RENDER_BLEND_ALPHA;
+    queue->stats = (RenderQueueStats){ 0 };
+}
+
+void RenderQueueSetLayer(RenderQueue *queue, RenderLayer layer, RenderBlend blend) {
+    queue->layer = (unsigned char)layer;
+    queue->blend = (unsigned char)blend;
+}
+
+// =====================================================================
+// PUSHING COMMANDS
+// =====================================================================
+
+static RenderCommand *Push(RenderQueue *queue, RenderShape shape, Color color) {
+    if (queue->count >= queue->capacity) {
+        queue->stats.dropped++;
+        return NULL;
+    }
+    RenderCommand *cmd = &queue->commands[queue->count++];
+    cmd->shape = (unsigned char)shape;
+    cmd->layer = queue->layer;
+    cmd->blend = queue->blend;
+    cmd->sides = 0;
+    cmd->color = color;
+    return cmd;
+}
+
+// Fewer segments for small circles: keep the edge within half a pixel of a
+// true circle (the same rule raylib uses when it picks segments itself),
+// capped at the 36 segments DrawCircleV() always uses
+static int CircleSegments(float radius) {
+    if (radius <= 0.5f) return 4;
+    float th = acosf(2.0f * powf(1.0f - 0.5f / radius, 2.0f) - 1.0f);
+    int segments = (int)ceilf(2.0f * PI / th);
+    if (segments < 6) segments = 6;
+    if (segments > 36) segments = 36;
+    return segments;
+}
+
+void RenderPushCircle(RenderQueue *queue, Vector2 center, float radius, Color color) {
+    RenderCommand *cmd = Push(queue, SHAPE_CIRCLE, color);
+    if (!cmd) return;
+    cmd->sides = (unsigned char)CircleSegments(radius);
+    cmd->v[0] = center.x; cmd->v[1] = center.y; cmd->v[2] = radius;
+}
+
+void RenderPushTriangle(RenderQueue *queue, Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+    RenderCommand *cmd = Push(queue, SHAPE_TRIANGLE, color);
+    if (!cmd) return;
+    cmd->v[0] = v1.x; cmd->v[1] = v1.y;
+    cmd->v[2] = v2.x; cmd->v[3] = v2.y;
+    cmd->v[4] = v3.x; cmd->v[5] = v3.y;
+}
+
+void RenderPushTriangleLines(RenderQueue *queue, Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+    RenderCommand *cmd = Push(queue, SHAPE_TRIANGLE_LINES, color);
+    if (!cmd) return;
+    cmd->v[0] = v1.x; cmd->v[1] = v1.y;
+    cmd->v[2] = v2.x; cmd->v[3] = v2.y;
+    cmd->v[4] = v3.x; cmd->v[5] = v3.y;
+}
+
+void RenderPushPoly(RenderQueue *queue, Vector2 center, int sides, float radius, float rotation, Color color) {
+    RenderCommand *cmd = Push(queue, SHAPE_POLY, color);
+    if (!cmd) return;
+    cmd->sides = (unsigned char)(sides < 3 ? 3 : (sides > 36 ? 36 : sides));
+    cmd->v[0] = center.x; cmd->v[1] = center.y;
+    cmd->v[2] = radius; cmd->v[3] = rotation;
+}
+
+void RenderPushRect(RenderQueue *queue, Vector2 center, Vector2 size, float rotation, Color color) {
+    RenderCommand *cmd = Push(queue, SHAPE_RECT, color);
+    if (!cmd) return;
+    cmd->v[0] = center.x; cmd->v[1] = center.y;
+    cmd->v[2] = size.x; cmd->v[3] = size.y;
+    cmd->v[4] = rotation;
+}
+
+void RenderPushSprite(RenderQueue *queue, Vector2 center, Vector2 source, Vector2 size) {
+    RenderCommand *cmd = Push(queue, SHAPE_SPRITE, (Color){ 255, 255, 255, 255 });
+    if (!cmd) return;
+    cmd->v[0] = center.x; cmd->v[1] = center.y;
+    cmd->v[2] = source.x; cmd->v[3] = source.y;
+    cmd->v[4] = size.x; cmd->v[5] = size.y;
+}
+
+// =====================================================================
+// TESSELLATION
+// =====================================================================
+
+// Fan of triangles around a center, in DrawCircleSector / DrawPoly order
+static int Fan(Vector2 *out, float cx, float cy, float radius, int sides, float startAngle) {
+    float step = 2.0f * PI / sides;
+    float angle = startAngle;
+    int n = 0;
+    for (int i = 0; i < sides; i++) {
+        out[n++] = (Vector2){ cx, cy };
+        out[n++] = (Vector2){ cx + cosf(angle + step) * radius, cy + sinf(angle + step) * radius };
+        out[n++] = (Vector2){ cx + cosf(angle) * radius, cy + sinf(angle) * radius };
+        angle += step;
+    }
+    return n;
+}
+
+// A 1 px wide line as two triangles, wound so they always face the camera
+static int LineQuad(Vector2 *out, Vector2 a, Vector2 b) {
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len <= 0.0f) return 0;
+    float nx = -dy / len * 0.5f, ny = dx / len * 0.5f;
+
+    Vector2 p0 = { a.x + nx, a.y + ny }, p1 = { a.x - nx, a.y - ny };
+    Vector2 p2 = { b.x - nx, b.y - ny }, p3 = { b.x + nx, b.y + ny };
+    // Screen space has y pointing down: visible triangles have a negative cross product
+    float cross = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+    if (cross > 0) { Vector2 t = p1; p1 = p3; p3 = t; }
+
+    out[0] = p0; out[1] = p1; out[2] = p2;
+    out[3] = p0; out[4] = p2; out[5] = p3;
+    return 6;
+}
+
+int RenderCommandTessellate(const RenderCommand *cmd, Vector2 *out) {
+    const float *v = cmd->v;
+    switch (cmd->shape) {
+        case SHAPE_CIRCLE:
+            return Fan(out, v[0], v[1], v[2], cmd->sides, 0.0f);
+
+        case SHAPE_TRIANGLE:
+            out[0] = (Vector2){ v[0], v[1] };
+            out[1] = (Vector2){ v[2], v[3] };
+            out[2] = (Vector2){ v[4], v[5] };
+            return 3;
+
+        case SHAPE_TRIANGLE_LINES: {
+            Vector2 a = { v[0], v[1] }, b = { v[2], v[3] }, c = { v[4], v[5] };
+            int n = LineQuad(out, a, b);
+            n += LineQuad(out + n, b, c);
+            n += LineQuad(out + n, c, a);
+            return n;
+        }
+
+        case SHAPE_POLY:
+            return Fan(out, v[0], v[1], v[2], cmd->sides, v[3] * DEG2RAD_F);
+
+        case SHAPE_RECT: {
+            // Rotated around its center, corners in DrawRectanglePro order
+            float c = cosf(v[4] * DEG2RAD_F), s = sinf(v[4] * DEG2RAD_F);
+            float hw = v[2] / 2.0f, hh = v[3] / 2.0f;
+            Vector2 tl = { v[0] - hw * c + hh * s, v[1] - hw * s - hh * c };
+            Vector2 tr = { v[0] + hw * c + hh * s, v[1] + hw * s - hh * c };
+            Vector2 bl = { v[0] - hw * c - hh * s, v[1] - hw * s + hh * c };
+            Vector2 br = { v[0] + hw * c - hh * s, v[1] + hw * s + hh * c };
+            out[0] = tl; out[1] = bl; out[2] = br;
+            out[3] = tl; out[4] = br; out[5] = tr;
+            return 6;
+        }
+
+        case SHAPE_SPRITE: {
+            float left = v[0] - v[4] / 2.0f, top = v[1] - v[5] / 2.0f;
+            Vector2 tl = { left, top }, tr = { left + v[4], top };
+            Vector2 bl = { left, top + v[5] }, br = { left + v[4], top + v[5] };
+            out[0] = tl; out[1] = bl; out[2] = br;
+            out[3] = tl; out[4] = br; out[5] = tr;
+            return 6;
+        }
+    }
+    return 0;
+}
+
+static int VertexCount(const RenderCommand *cmd) {
+    switch (cmd->shape) {
+        case SHAPE_CIRCLE:         return cmd->sides * 3;
+        case SHAPE_TRIANGLE:       return 3;
+        case SHAPE_TRIANGLE_LINES: return 18;
+        case SHAPE_POLY:           return cmd->sides * 3;
+        case SHAPE_RECT:           return 6;
+        case SHAPE_SPRITE:         return 6;
+    }
+    return 0;
+}
+
+// =====================================================================
+// SORTING AND BATCHING
+// =====================================================================
+// A counting sort on the layer is O(n) and stable, so commands keep the
+// order they were pushed in within their layer. The blend mode is not part
+// of the key: sorting on it would draw every alpha command of a layer before
+// every additive one, whatever order they were pushed in.
+
+void RenderQueueSort(RenderQueue *queue) {
+    int start[LAYER_COUNT + 1] = { 0 };
+
+    for (int i = 0; i < queue->count; i++) start[queue->commands[i].layer + 1]++;
+    for (int l = 0; l < LAYER_COUNT; l++) start[l + 1] += start[l];
+    for (int i = 0; i < queue->count; i++) queue->order[start[queue->commands[i].layer]++] = i;
+
+    // Merge consecutive commands with the same blend mode into one batch,
+    // even across layers. Each blend switch inside a layer starts a new one;
+    // past RENDER_QUEUE_MAX_BATCHES the rest of the frame counts as dropped.
+    queue->batchCount = 0;
+    queue->stats.vertices = 0;
+    RenderBatch *batch = NULL;
+    for (int k = 0; k < queue->count; k++) {
+        const RenderCommand *cmd = &queue->commands[queue->order[k]];
+        if (!batch || batch->blend != cmd->blend) {
+            if (queue->batchCount == RENDER_QUEUE_MAX_BATCHES) {
+                queue->stats.dropped += queue->count - k;
+                break;
+            }
+            batch = &queue->batches[queue->batchCount++];
+            *batch = (RenderBatch){ k, 0, 0, cmd->blend };
+        }
+        int vertices = VertexCount(cmd);
+        batch->count++;
+        batch->vertices += vertices;
+        queue->stats.vertices += vertices;
+    }
+
+    queue->stats.commands = queue->count;
+    queue->stats.batches = queue->batchCount;
+}
@@ -0,0 +1,116 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - RENDER COMMAND QUEUE
+*
+*   Instead of calling DrawCircleV() & co. directly (every call is a separate trip into
+*   rlgl), game code pushes small draw commands into a queue. Each command carries a
+*   layer (what is drawn on top of what) and a blend mode. Before the frame ends the
+*   queue is sorted by layer, keeping submission order inside a layer, and cut into
+*   batches: maximal runs of commands that share a blend mode. The blend mode never
+*   reorders anything; alpha and additive commands interleaved inside a layer just
+*   cost one batch per switch. Every shape is turned
+*   into plain triangles, so one batch becomes one rlBegin(RL_TRIANGLES)...rlEnd().
+*
+*   This module never calls raylib, so the command list, the batches and the counters
+*   can be inspected in a headless build. The GPU side lives in render_gl.c.
+*
+********************************************************************************************/
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "sim.h"        // Vector2 / Color
+
+// Draw order, back to front (the star background is drawn before the queue)
+typedef enum {
+    LAYER_BULLETS,
+    LAYER_ENEMIES,
+    LAYER_PLAYER,
+    LAYER_PARTICLES,
+    LAYER_COUNT
+} RenderLayer;
+
+// Same values as raylib's BLEND_ALPHA / BLEND_ADDITIVE
+typedef enum {
+    RENDER_BLEND_ALPHA,
+    RENDER_BLEND_ADDITIVE,
+    RENDER_BLEND_COUNT
+} RenderBlend;
+
+typedef enum {
+    SHAPE_CIRCLE,           // v: center x, y, radius
+    SHAPE_TRIANGLE,         // v: three vertices
+    SHAPE_TRIANGLE_LINES,   // v: three vertices, drawn as 1 px outline
+    SHAPE_POLY,             // v: center x, y, radius, rotation (degrees); sides
+    SHAPE_RECT,             // v: center x, y, width, height, rotation (degrees)
+    SHAPE_SPRITE            // v: center x, y, atlas x, y, width, height (pixels, see sprites.h)
+} RenderShape;
+
+// One queued shape: 32 bytes
+typedef struct {
+    unsigned char shape;    // RenderShape
+    unsigned char layer;    // RenderLayer
+    unsigned char blend;    // RenderBlend
+    unsigned char sides;    // Polygon sides or circle segments
+    Color         color;
+    float         v[6];
+} RenderCommand;
+
+// A run of sorted commands that can go to the GPU in one draw call
+typedef struct {
+    int first;              // Index into RenderQueue.order
+    int count;
+    int vertices;
+    int blend;
+} RenderBatch;
+
+// Per-frame counters (valid after RenderQueueSort)
+typedef struct {
+    int commands;           // Shapes pushed this frame
+    int batches;            // Draw calls they were merged into
+    int vertices;           // Triangle vertices generated
+    int dropped;            // Commands lost because the queue or the batches were full
+} RenderQueueStats;
+
+#define RENDER_QUEUE_MAX_BATCHES    64
+#define RENDER_MAX_SHAPE_VERTICES   (36 * 3)    // Worst case: a 36 segment circle
+
+typedef struct {
+    RenderCommand   *commands;
+    int             *order;         // Command indices in draw order (after sorting)
+    int              count;
+    int              capacity;
+    unsigned char    layer;         // Layer and blend given to the next pushes
+    unsigned char    blend;
+    RenderBatch      batches[RENDER_QUEUE_MAX_BATCHES];
+    int              batchCount;
+    RenderQueueStats stats;
+} RenderQueue;
+
+// commands and order must both hold capacity entries
+void RenderQueueInit(RenderQueue *queue, RenderCommand *commands, int *order, int capacity);
+void RenderQueueBegin(RenderQueue *queue);
+void RenderQueueSetLayer(RenderQueue *queue, RenderLayer layer, RenderBlend blend);
+
+void RenderPushCircle(RenderQueue *queue, Vector2 center, float radius, Color color);
+void RenderPushTriangle(RenderQueue *queue, Vector2 v1, Vector2 v2, Vector2 v3, Color color);
+void RenderPushTriangleLines(RenderQueue *queue, Vector2 v1, Vector2 v2, Vector2 v3, Color color);
+void RenderPushPoly(RenderQueue *queue, Vector2 center, int sides, float radius, float rotation, Color color);
+void RenderPushRect(RenderQueue *queue, Vector2 center, Vector2 size, float rotation, Color color);
+void RenderPushSprite(RenderQueue *queue, Vector2 center, Vector2 source, Vector2 size);
+
+// Sort by layer, build batches and fill in stats
+void RenderQueueSort(RenderQueue *queue);
+
+// Turn one command into triangle vertices (3 per triangle); returns how many.
+// A sprite is a quad: top left, bottom left, bottom right, top left, bottom right, top right.
+int RenderCommandTessellate(const RenderCommand *command, Vector2 *out);
+
+// Draw all batches with rlgl (render_gl.c, needs raylib). Colors are blended as
+// premultiplied alpha, so shapes baked into a texture look the same drawn from it.
+void RenderQueueSubmit(const RenderQueue *queue);
+
+// raylib's Fade(): same color with alpha replaced
+Color ColorWithAlpha(Color color, float alpha);
+
+#endif // RENDER_QUEUE_H
@@ -0,0 +1,329 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - INPUT REPLAYS
+*
+*   Writing, reading and verifying replay files (format in replay.h).
+*
+********************************************************************************************/
+
+#include "replay.h"
+#include "timer.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAGIC        "SSRP"
+#define BUTTON_MASK         0x1F    // InputButton fits in the low 5 bits of a record byte
+
+typedef enum {
+    RECORD_RUN        = 0,
+    RECORD_CHECKPOINT = 1,
+    RECORD_END        = 2
+} RecordType;
+
+// FNV-1a, the same hash SimChecksum uses
+static unsigned int Fnv(unsigned int hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+unsigned int ReplayBuildHash(void) {
+    unsigned int h = Fnv(2166136261u, SIM_BUILD_ID, strlen(SIM_BUILD_ID));
+    int format[] = { REPLAY_VERSION, SIM_TICK_RATE };
+    h = Fnv(h, format, sizeof(format));
+    // Every number that decides how an enemy plays, and the difficulty curve
+    // (replays are always played back with the default one)
+    for (int t = 0; t < ENEMY_TYPE_COUNT; t++) {
+        const EnemyArchetype *a = &enemyArchetypes[t];
+        float balance[] = { (float)a->spawnChance, a->size.x, a->size.y, a->speed, a->speedPerWave,
+                            (float)a->health, (float)a->points };
+        h = Fnv(h, balance, sizeof(balance));
+    }
+    SimTuning tuning = SimDefaultTuning();
+    float curve[] = { tuning.spawnInterval, tuning.difficultyPeriod, tuning.wavePeriod };
+    h = Fnv(h, curve, sizeof(curve));
+    return h;
+}
+
+ReplayHeader ReplayHeaderFor(const Simulation *sim, unsigned int seed, float dt) {
+    return (ReplayHeader){ ReplayBuildHash(), seed, dt, REPLAY_CHECK_INTERVAL, sim->config };
+}
+
+// =====================================================================
+// WRITING
+// =====================================================================
+
+static void Flush(ReplayWriter *w) {
+    if (w->used > 0 && !w->failed && fwrite(w->buffer, 1, (size_t)w->used, w->file) != (size_t)w->used)
+        w->failed = true;
+    w->used = 0;
+}
+
+static void PutByte(ReplayWriter *w, unsigned char byte) {
+    if (w->used == REPLAY_BUFFER_SIZE) Flush(w);
+    w->buffer[w->used++] = byte;
+}
+
+static void PutVarint(ReplayWriter *w, unsigned long value) {
+    while (value >= 0x80) {
+        PutByte(w, (unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    PutByte(w, (unsigned char)value);
+}
+
+// Little endian, whatever the machine
+static void PutU32(ReplayWriter *w, unsigned int value) {
+    for (int i = 0; i < 4; i++) PutByte(w, (unsigned char)(value >> (8 * i)));
+}
+
+static void PutFloat(ReplayWriter *w, float value) {
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    PutU32(w, bits);
+}
+
+// Write out the current run: what changed since the last one, and for how long
+static void EndRun(ReplayWriter *w) {
+    if (w->run == 0) return;
+    PutByte(w, (unsigned char)(RECORD_RUN << 5 | ((w->buttons ^ w->previous) & BUTTON_MASK)));
+    PutVarint(w, (unsigned long)w->run);
+    w->previous = w->buttons;
+    w->run = 0;
+}
+
+bool ReplayWriterOpen(ReplayWriter *writer, const char *path, const ReplayHeader *header) {
+    memset(writer, 0, sizeof(*writer));
+    writer->file = fopen(path, "wb");
+    if (!writer->file) return false;
+    writer->checkInterval = header->checkInterval;
+
+    for (const char *c = REPLAY_MAGIC; *c; c++) PutByte(writer, (unsigned char)*c);
+    PutByte(writer, REPLAY_VERSION);
+    PutU32(writer, header->buildHash);
+    PutVarint(writer, header->seed);
+    PutFloat(writer, header->dt);
+    PutVarint(writer, (unsigned long)header->checkInterval);
+    PutVarint(writer, (unsigned long)header->config.maxBullets);
+    PutVarint(writer, (unsigned long)header->config.maxEnemies);
+    PutVarint(writer, (unsigned long)header->config.maxStars);
+    PutVarint(writer, (unsigned long)header->config.maxParticles);
+    PutVarint(writer, (unsigned long)header->config.maxFrozenEnemies);
+    PutVarint(writer, (unsigned long)header->config.worldHeight);
+    return true;
+}
+
+void ReplayWriterTick(ReplayWriter *writer, SimInput input, const Simulation *sim) {
+    if (!writer->file) return;
+
+    unsigned int buttons = input.buttons & BUTTON_MASK;
+    if (writer->run > 0 && buttons != writer->buttons) EndRun(writer);
+    writer->buttons = buttons;
+    writer->run++;
+    writer->ticks++;
+
+    if (writer->checkInterval > 0 && writer->ticks % writer->checkInterval == 0) {
+        EndRun(writer);
+        PutByte(writer, RECORD_CHECKPOINT << 5);
+        PutVarint(writer, (unsigned long)writer->ticks);
+        PutU32(writer, SimChecksum(sim));
+    }
+}
+
+bool ReplayWriterClose(ReplayWriter *writer, const Simulation *sim) {
+    if (!writer->file) return false;
+    EndRun(writer);
+    PutByte(writer, RECORD_END << 5);
+    PutVarint(writer, (unsigned long)writer->ticks);
+    PutVarint(writer, (unsigned long)sim->player.score);
+    PutVarint(writer, (unsigned long)sim->wave);
+    PutFloat(writer, sim->gameTime);
+    PutU32(writer, SimChecksum(sim));
+    Flush(writer);
+
+    bool ok = !writer->failed;
+    if (fclose(writer->file) != 0) ok = false;
+    writer->file = NULL;
+    return ok;
+}
+
+// =====================================================================
+// READING
+// =====================================================================
+
+typedef struct {
+    FILE         *file;
+    unsigned char buffer[REPLAY_BUFFER_SIZE];
+    int           pos;
+    int           len;
+    bool          eof;          // Read past the end of the file
+} ReplayReader;
+
+static int GetByte(ReplayReader *r) {
+    if (r->pos == r->len) {
+        r->len = (int)fread(r->buffer, 1, REPLAY_BUFFER_SIZE, r->file);
+        r->pos = 0;
+        if (r->len == 0) {
+            r->eof = true;
+            return 0;
+        }
+    }
+    return r->buffer[r->pos++];
+}
+
+// Bits past an unsigned long (32 of them where long is 32 bits) are dropped:
+// the writer never has more, and shifting further would be undefined
+static unsigned long GetVarint(ReplayReader *r) {
+    unsigned long value = 0;
+    for (int shift = 0; shift < (int)(sizeof(value) * CHAR_BIT); shift += 7) {
+        int byte = GetByte(r);
+        value |= (unsigned long)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    return value;
+}
+
+static unsigned int GetU32(ReplayReader *r) {
+    unsigned int value = 0;
+    for (int i = 0; i < 4; i++) value |= (unsigned int)GetByte(r) << (8 * i);
+    return value;
+}
+
+static float GetFloat(ReplayReader *r) {
+    unsigned int bits = GetU32(r);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool ReadHeader(ReplayReader *r, ReplayHeader *header) {
+    for (const char *c = REPLAY_MAGIC; *c; c++) {
+        if (GetByte(r) != *c) return false;
+    }
+    int version = GetByte(r);
+    if (version < 1 || version > REPLAY_VERSION) return false;
+    header->buildHash = GetU32(r);
+    header->seed = (unsigned int)GetVarint(r);
+    header->dt = GetFloat(r);
+    header->checkInterval = (int)GetVarint(r);
+    header->config.maxBullets = (int)GetVarint(r);
+    header->config.maxEnemies = (int)GetVarint(r);
+    header->config.maxStars = (int)GetVarint(r);
+    header->config.maxParticles = (int)GetVarint(r);
+    if (version >= 2) {
+        header->config.maxFrozenEnemies = (int)GetVarint(r);
+        header->config.worldHeight = (int)GetVarint(r);
+    } else {
+        header->config.maxFrozenEnemies = DEFAULT_MAX_FROZEN_ENEMIES;
+        header->config.worldHeight = DEFAULT_WORLD_HEIGHT;
+    }
+    return !r->eof;
+}
+
+static ReplayResult ResultOf(const Simulation *sim, long ticks) {
+    return (ReplayResult){ ticks, sim->player.score, sim->wave, sim->gameTime, SimChecksum(sim) };
+}
+
+// =====================================================================
+// VERIFYING
+// =====================================================================
+// The replay goes through the same SimStep the game's UpdateGame() calls,
+// one tick per recorded tick, with nothing drawn.
+
+ReplayReport ReplayVerify(const char *path, JobSystem *jobs, long printEvery) {
+    ReplayReport report = { 0 };
+    report.firstBadTick = -1;
+
+    ReplayReader *reader = calloc(1, sizeof(ReplayReader));
+    Simulation *sim = calloc(1, sizeof(Simulation));
+    if (!reader || !sim) {
+        report.error = "out of memory";
+        goto done;
+    }
+    reader->file = fopen(path, "rb");
+    if (!reader->file) {
+        report.error = "can't open file";
+        goto done;
+    }
+    if (!ReadHeader(reader, &report.header)) {
+        report.error = "not a replay file (or another version)";
+        goto done;
+    }
+    report.buildMatches = report.header.buildHash == ReplayBuildHash();
+    if (!SimCreate(sim, &report.header.config)) {
+        report.error = "out of memory for the recorded capacities";
+        goto done;
+    }
+    sim->jobs = jobs;
+    SimInit(sim, report.header.seed);
+
+    unsigned int buttons = 0;
+    long tick = 0;
+    bool ended = false;
+    double start = TimerNow();
+    while (!ended) {
+        int byte = GetByte(reader);
+        if (reader->eof) {
+            report.error = "file ends before the END record";
+            break;
+        }
+
+        switch (byte >> 5) {
+            case RECORD_RUN: {
+                buttons ^= (unsigned int)(byte & BUTTON_MASK);
+                long run = (long)GetVarint(reader);
+                for (long k = 0; k < run; k++) {
+                    SimStep(sim, (SimInput){ buttons }, report.header.dt);
+                    tick++;
+                    if (printEvery > 0 && tick % printEvery == 0)
+                        printf("  tick %8ld  %08x\n", tick, SimChecksum(sim));
+                }
+            } break;
+
+            case RECORD_CHECKPOINT: {
+                long at = (long)GetVarint(reader);
+                unsigned int checksum = GetU32(reader);
+                report.checkpoints++;
+                if (at == tick && checksum == SimChecksum(sim)) {
+                    if (report.firstBadTick < 0) report.lastGoodTick = at;
+                } else if (report.firstBadTick < 0) {
+                    report.firstBadTick = at;
+                }
+            } break;
+
+            case RECORD_END:
+                report.recorded.ticks = (long)GetVarint(reader);
+                report.recorded.score = (int)GetVarint(reader);
+                report.recorded.wave = (int)GetVarint(reader);
+                report.recorded.gameTime = GetFloat(reader);
+                report.recorded.checksum = GetU32(reader);
+                if (reader->eof) report.error = "truncated END record";
+                ended = true;
+                break;
+
+            default:
+                report.error = "unknown record";
+                ended = true;
+                break;
+        }
+    }
+    report.elapsed = TimerNow() - start;
+    report.replayed = ResultOf(sim, tick);
+
+    if (!report.error) {
+        const ReplayResult *a = &report.recorded, *b = &report.replayed;
+        report.ok = report.firstBadTick < 0 && a->ticks == b->ticks && a->score == b->score &&
+                    a->wave == b->wave && a->gameTime == b->gameTime && a->checksum == b->checksum;
+    }
+
+done:
+    if (reader && reader->file) fclose(reader->file);
+    if (sim) SimDestroy(sim);
+    free(sim);
+    free(reader);
+    return report;
+}
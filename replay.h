@@ -0,0 +1,109 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - INPUT REPLAYS
+*
+*   The simulation is deterministic: the same seed, capacities, tick length and buttons
+*   always produce the same game. So a game can be stored as just its inputs, and a
+*   bug report or a balance change can be checked by simulating it again.
+*
+*   File layout (all integers are LEB128 varints unless noted):
+*
+*     "SSRP"  version (byte)  build hash (u32)  seed  tick dt (f32)  check interval
+*     max bullets  max enemies  max stars  max particles
+*     max frozen enemies  world height                     (version 2 and up)
+*     records...
+*
+*   Every record starts with one byte: the record type in the top 3 bits and, for
+*   input runs, the buttons that changed (XOR with the previous run) in the low 5 bits.
+*
+*     RUN         changed buttons, then the number of ticks they are held for
+*     CHECKPOINT  tick count, then SimChecksum() after that tick (u32)
+*     END         ticks, score, wave, game time (f32), final SimChecksum() (u32)
+*
+*   Holding fire and moving for a second is a handful of bytes, so even long games
+*   stay a few kilobytes. Checkpoints every check interval ticks let the verifier say
+*   between which two ticks a replay stopped matching; replayer --checksums=N prints
+*   the state hash every N ticks, so two builds can be narrowed down to the exact tick.
+*
+*   Writing and reading both go through a 64 KB buffer: one fwrite/fread per buffer,
+*   never one per tick. Pure C, no raylib.
+*
+********************************************************************************************/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "sim.h"
+#include <stdio.h>
+
+#define REPLAY_VERSION          2           // Version 1 files (one-screen worlds) still play
+#define REPLAY_BUFFER_SIZE      (64 * 1024)
+#define REPLAY_CHECK_INTERVAL   600         // Ticks between checkpoints (10 s at 60 Hz)
+#define REPLAY_DEFAULT_FILE     "last_game.rpl"
+
+// Identifies the game rules a replay was recorded with. Build with
+// -DSIM_BUILD_ID=\"$(git rev-parse --short HEAD)\" to tell builds apart;
+// the enemy archetype stats are always part of the hash.
+#if !defined(SIM_BUILD_ID)
+    #define SIM_BUILD_ID "dev"
+#endif
+
+typedef struct {
+    unsigned int buildHash;
+    unsigned int seed;
+    float        dt;
+    int          checkInterval;
+    SimConfig    config;
+} ReplayHeader;
+
+typedef struct {
+    long         ticks;
+    int          score;
+    int          wave;
+    float        gameTime;
+    unsigned int checksum;
+} ReplayResult;
+
+typedef struct {
+    FILE         *file;
+    unsigned char buffer[REPLAY_BUFFER_SIZE];
+    int           used;
+    unsigned int  buttons;      // Buttons of the current run...
+    long          run;          // ...and how many ticks it has lasted so far
+    unsigned int  previous;     // Buttons of the last run written
+    long          ticks;
+    int           checkInterval;
+    bool          failed;       // A write failed; the rest is dropped
+} ReplayWriter;
+
+// Outcome of ReplayVerify
+typedef struct {
+    ReplayHeader header;
+    ReplayResult recorded;
+    ReplayResult replayed;
+    int          checkpoints;       // Checkpoints compared
+    long         lastGoodTick;      // Last checkpoint that matched (0: none)
+    long         firstBadTick;      // First checkpoint that didn't (-1: none)
+    bool         buildMatches;      // Same build hash as this program
+    bool         ok;                // Every checkpoint and the final state matched
+    double       elapsed;           // Seconds spent simulating
+    const char  *error;             // Not NULL if the file couldn't be read
+} ReplayReport;
+
+// Hash of SIM_BUILD_ID and the game balance (see above)
+unsigned int ReplayBuildHash(void);
+
+// A header for recording sim from its next tick on (sim was just SimInit'ed with seed)
+ReplayHeader ReplayHeaderFor(const Simulation *sim, unsigned int seed, float dt);
+
+// Recording: open, one ReplayWriterTick per SimStep (after the step), then close.
+// Close writes the END record with sim's final state. All return false on I/O errors.
+bool ReplayWriterOpen(ReplayWriter *writer, const char *path, const ReplayHeader *header);
+void ReplayWriterTick(ReplayWriter *writer, SimInput input, const Simulation *sim);
+bool ReplayWriterClose(ReplayWriter *writer, const Simulation *sim);
+
+// Simulate a replay again and compare it with what was recorded. jobs may be NULL.
+// With printEvery > 0 the tick and SimChecksum are printed every printEvery ticks.
+ReplayReport ReplayVerify(const char *path, JobSystem *jobs, long printEvery);
+
+#endif // REPLAY_H
@@ -0,0 +1,101 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - REPLAY VERIFIER
+*
+*   Simulates recorded games again as fast as the machine allows, without a window, and
+*   checks that every checkpoint and the final state match the recording (replay.h).
+*   The game records every game to last_game.rpl; headless --record=FILE records one
+*   from the scripted pilot.
+*
+*   Use it to check that a change didn't alter gameplay: record a few games, make the
+*   change, and replay them. A mismatch reports the last checkpoint that still agreed
+*   and the first one that didn't; --checksums=N prints the state hash every N ticks so
+*   the output of two builds can be diffed down to the exact tick.
+*
+*   To compile:
+*     gcc replayer.c replay.c sim.c particles.c jobs.c -O2 -o replayer -lm -lpthread
+*
+*   Usage:
+*     ./replayer [--threads=N] [--checksums=N] FILE...
+*
+*   Exits with 1 if any replay doesn't match.
+*
+********************************************************************************************/
+
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Returns the value part of "--name=value", or NULL if arg is not that flag
+static const char *FlagValue(const char *arg, const char *name) {
+    size_t len = strlen(name);
+    if (strncmp(arg, name, len) == 0 && arg[len] == '=') return arg + len + 1;
+    return NULL;
+}
+
+static void PrintResult(const char *label, const ReplayResult *r) {
+    printf("  %-9s %ld ticks, score %d, wave %d, time %.2f s, checksum %08x\n",
+           label, r->ticks, r->score, r->wave, r->gameTime, r->checksum);
+}
+
+int main(int argc, char **argv) {
+    int threads = 1;
+    long printEvery = 0;
+    int files = 0, failed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if ((v = FlagValue(argv[i], "--threads"))) threads = atoi(v);
+        else if ((v = FlagValue(argv[i], "--checksums"))) printEvery = atol(v);
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [--threads=N] [--checksums=N] FILE...\n", argv[0]);
+            return 1;
+        }
+    }
+
+    JobSystem *jobs = JobSystemCreate(threads);
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-') continue;
+        files++;
+
+        printf("%s\n", argv[i]);
+        ReplayReport report = ReplayVerify(argv[i], jobs, printEvery);
+        if (report.error) {
+            printf("  ERROR     %s\n", report.error);
+            failed++;
+            continue;
+        }
+        if (!report.buildMatches)
+            printf("  warning:  recorded with another build (hash %08x, this one %08x)\n",
+                   report.header.buildHash, ReplayBuildHash());
+
+        const ReplayHeader *h = &report.header;
+        printf("  seed %u, dt %.4f, capacities %d/%d/%d\n", h->seed, h->dt,
+               h->config.maxBullets, h->config.maxEnemies, h->config.maxParticles);
+        PrintResult("recorded", &report.recorded);
+        PrintResult("replayed", &report.replayed);
+        printf("  simulated in %.3f s (%.0fx realtime), %d checkpoints\n", report.elapsed,
+               report.elapsed > 0 ? report.replayed.ticks * h->dt / report.elapsed : 0.0,
+               report.checkpoints);
+
+        if (report.ok) {
+            printf("  OK\n");
+        } else {
+            failed++;
+            if (report.firstBadTick >= 0)
+                printf("  MISMATCH: diverged between tick %ld and tick %ld\n",
+                       report.lastGoodTick, report.firstBadTick);
+            else
+                printf("  MISMATCH: diverged after tick %ld\n", report.lastGoodTick);
+        }
+    }
+    JobSystemDestroy(jobs);
+
+    if (files == 0) {
+        fprintf(stderr, "usage: %s [--threads=N] [--checksums=N] FILE...\n", argv[0]);
+        return 1;
+    }
+    if (files > 1) printf("%d of %d replays match\n", files - failed, files);
+    return failed > 0 ? 1 : 0;
+}
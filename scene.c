@@ -0,0 +1,130 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SCENE BUILDING
+*
+*   The shapes here are the ones the game always drew with DrawTriangle / DrawPoly /
+*   DrawCircleV, now pushed into a RenderQueue (see render_queue.h). The player and
+*   the enemies are one sprite each from the atlas (sprites.h); their shapes live
+*   in sprites.c, which bakes them.
+*
+********************************************************************************************/
+
+#include "scene.h"
+#include "profiler.h"
+#include <math.h>
+
+// Blend between the last two simulation ticks
+static Vector2 Interpolate(Vector2 prev, Vector2 current, float alpha) {
+    return (Vector2){
+        prev.x + (current.x - prev.x) * alpha,
+        prev.y + (current.y - prev.y) * alpha
+    };
+}
+
+// Does a shape reaching reach pixels up and down from y show in the view?
+// Everything spans the view's whole width, so only y is checked.
+static inline bool InView(Rectangle view, float y, float reach) {
+    return y + reach >= view.y && y - reach <= view.y + view.height;
+}
+
+Rectangle SceneView(const Simulation *sim, float alpha) {
+    float playerY = Interpolate(sim->player.prev_position, sim->player.position, alpha).y;
+    return (Rectangle){ 0, SimViewTop(sim, playerY), SCREEN_WIDTH, SCREEN_HEIGHT };
+}
+
+// Particles fade and shrink over their lifetime. In game they get a soft glow.
+void PushParticles(RenderQueue *queue, const ParticlePool *pool, const SimPalette *palette, float alpha, bool glow,
+                   Rectangle view) {
+    RenderQueueSetLayer(queue, LAYER_PARTICLES, RENDER_BLEND_ALPHA);
+    const float toPixels = 1.0f / PARTICLE_POSITION_SCALE;
+    for (int i = 0; i < pool->slots.count; i++) {
+        float ratio = (float)pool->lifetime[i] / pool->max_lifetime[i];
+        float r = pool->radius[i] * (ratio / PARTICLE_RADIUS_SCALE);
+        Vector2 pos = Interpolate((Vector2){ pool->prev_x[i] * toPixels, pool->prev_y[i] * toPixels },
+                                  (Vector2){ pool->x[i] * toPixels, pool->y[i] * toPixels }, alpha);
+        pos.y += pool->originY;
+        if (!InView(view, pos.y, r * 2)) continue;
+
+        Color color = palette->colors[pool->color[i]];
+        color.a = (unsigned char)(255 * ratio);
+        if (glow) RenderPushCircle(queue, pos, r * 2, ColorWithAlpha(color, 0.2f));
+        RenderPushCircle(queue, pos, r, color);
+    }
+}
+
+// The player ship: one sprite, or its triangles when there is no atlas
+void PushPlayer(RenderQueue *queue, const Player *player, float alpha, double time, const SpriteAtlas *atlas) {
+    if (!player->active) return;
+
+    // Flash when damaged
+    if (player->damage_timer > 0 && (int)(player->damage_timer * 10) % 2 == 0)
+        return;
+
+    Vector2 pos = Interpolate(player->prev_position, player->position, alpha);
+    RenderQueueSetLayer(queue, LAYER_PLAYER, RENDER_BLEND_ALPHA);
+    if (atlas) SpritePush(queue, atlas, SpritePlayerFrame(atlas, time), pos);
+    else SpritePushPlayerShapes(queue, pos, sinf((float)time * SPRITE_FLAME_SPEED) * SPRITE_FLAME_HEIGHT);
+}
+
+// Enemy: one sprite, or its archetype's parts when there is no atlas
+static void PushEnemyOfType(RenderQueue *queue, const EnemyArchetype *arch, const Enemy *e, float alpha,
+                            const SpriteAtlas *atlas) {
+    Vector2 pos = Interpolate(e->prev_position, e->position, alpha);
+    if (atlas) {
+        SpritePush(queue, atlas, SpriteEnemyFrame(atlas, e), pos);
+        return;
+    }
+    const EnemyPart *first = &arch->parts[0];
+    float rotation = sinf(e->move_angle) * first->wobble + e->move_angle * first->spin;
+    SpritePushEnemyShapes(queue, arch, pos, rotation, e->health);
+}
+
+void PushEnemy(RenderQueue *queue, const Enemy *e, float alpha, const SpriteAtlas *atlas) {
+    RenderQueueSetLayer(queue, LAYER_ENEMIES, RENDER_BLEND_ALPHA);
+    PushEnemyOfType(queue, &enemyArchetypes[e->type], e, alpha, atlas);
+}
+
+void BuildGameScene(RenderQueue *queue, const Simulation *sim, float alpha, double time,
+                    const QualitySettings *quality, const SpriteAtlas *atlas) {
+    if (!quality) quality = &qualityLevels[QUALITY_HIGH];
+    Rectangle view = SceneView(sim, alpha);
+
+    // Bullets with a glow effect: the outer ring goes first when quality drops
+    PROFILE_BEGIN("Bullets");
+    RenderQueueSetLayer(queue, LAYER_BULLETS, RENDER_BLEND_ALPHA);
+    for (int i = 0; i < sim->bulletPool.count; i++) {
+        const Bullet *b = &sim->bullets[i];
+        Color color = sim->palette.colors[b->color];
+        Vector2 pos = Interpolate(b->prev_position, b->position, alpha);
+        if (!InView(view, pos.y, b->radius * 3)) continue;
+        if (quality->bulletGlow >= 2) RenderPushCircle(queue, pos, b->radius * 3, ColorWithAlpha(color, 0.15f));
+        if (quality->bulletGlow >= 1) RenderPushCircle(queue, pos, b->radius * 1.5f, ColorWithAlpha(color, 0.4f));
+        RenderPushCircle(queue, pos, b->radius, color);
+    }
+    PROFILE_END();
+
+    // Enemies, one type at a time. A turned shape reaches at most its size from
+    // the center, the health dots a little further up.
+    PROFILE_BEGIN("Enemies");
+    RenderQueueSetLayer(queue, LAYER_ENEMIES, RENDER_BLEND_ALPHA);
+    for (int t = 0; t < ENEMY_TYPE_COUNT; t++) {
+        const EnemyArchetype *arch = &enemyArchetypes[t];
+        float reach = (arch->size.x > arch->size.y ? arch->size.x : arch->size.y) + 12.0f;
+        for (int i = sim->enemyBucket[t]; i < sim->enemyBucket[t + 1]; i++) {
+            const Enemy *e = &sim->enemies[i];
+            if (!InView(view, e->prev_position.y + (e->position.y - e->prev_position.y) * alpha, reach)) continue;
+            PushEnemyOfType(queue, arch, e, alpha, atlas);
+        }
+    }
+    PROFILE_END();
+
+    // Player
+    PROFILE_BEGIN("Player");
+    PushPlayer(queue, &sim->player, alpha, time, atlas);
+    PROFILE_END();
+
+    // Particles
+    PROFILE_BEGIN("Particles");
+    PushParticles(queue, &sim->particles, &sim->palette, alpha, quality->particleGlow, view);
+    PROFILE_END();
+}
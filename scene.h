@@ -0,0 +1,38 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SCENE BUILDING
+*
+*   Turns the simulation state into render queue commands: bullets, enemies, the
+*   player and particles. Positions are blended between the last two ticks with
+*   alpha (0 = previous tick, 1 = current tick). Pure C, so a headless build can
+*   build full frames and look at the resulting commands and batches.
+*
+*   Commands are in world coordinates; the caller draws them through a camera
+*   looking at SceneView. Whatever is entirely outside the view isn't pushed.
+*
+********************************************************************************************/
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "sim.h"
+#include "render_queue.h"
+#include "quality.h"
+#include "sprites.h"
+
+// The part of the world on screen for this blend of the last two ticks
+Rectangle SceneView(const Simulation *sim, float alpha);
+
+// The whole in-game picture (everything except the star background and the HUD).
+// quality decides the glow effects (NULL: everything on, see quality.h). With an
+// atlas the player and every enemy are one sprite each; NULL builds their shapes.
+void BuildGameScene(RenderQueue *queue, const Simulation *sim, float alpha, double time,
+                    const QualitySettings *quality, const SpriteAtlas *atlas);
+
+// Pieces of the game scene (the game over screen reuses the particles)
+void PushParticles(RenderQueue *queue, const ParticlePool *pool, const SimPalette *palette, float alpha, bool glow,
+                   Rectangle view);
+void PushPlayer(RenderQueue *queue, const Player *player, float alpha, double time, const SpriteAtlas *atlas);
+void PushEnemy(RenderQueue *queue, const Enemy *e, float alpha, const SpriteAtlas *atlas);
+
+#endif // SCENE_H
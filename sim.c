@@ -0,0 +1,1227 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SIMULATION CORE
+*
+*   Game logic only: no window, no input polling, no drawing. See sim.h.
+*
+********************************************************************************************/
+
+#include "sim.h"
+#include "profiler.h"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// How many elements one job takes at a time (see jobs.h). Smaller loops than
+// one chunk simply run on the calling thread.
+#define CHUNK_PARTICLES     4096
+#define CHUNK_BULLETS       1024
+#define CHUNK_ENEMIES       512
+#define CHUNK_COLLISIONS    64
+
+// =====================================================================
+// LESSON 3: UTILITY FUNCTIONS
+// =====================================================================
+// The simulation keeps its own random generator (xorshift32) instead of
+// calling GetRandomValue(), so a game can be replayed from its seed.
+// Particles have a second one: how many of them there are (see particleScale)
+// must not change the numbers the game itself draws.
+
+static unsigned int NextRandom(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int RandomInt(unsigned int *state, int min, int max) {
+    if (min > max) { int tmp = max; max = min; min = tmp; }
+    unsigned int range = (unsigned int)(max - min) + 1u;
+    return min + (int)(NextRandom(state) % range);
+}
+
+// Random integer in [min, max], both included (like GetRandomValue)
+int SimRandomInt(Simulation *sim, int min, int max) {
+    return RandomInt(&sim->rngState, min, max);
+}
+
+// Generate a random floating point number
+float SimRandomFloat(Simulation *sim, float min, float max) {
+    return min + (float)SimRandomInt(sim, 0, 10000) / 10000.0f * (max - min);
+}
+
+static float ParticleRandomFloat(Simulation *sim, float min, float max) {
+    return min + (float)RandomInt(&sim->particleRng, 0, 10000) / 10000.0f * (max - min);
+}
+
+static Vector2 Vector2Subtract(Vector2 a, Vector2 b) {
+    return (Vector2){ a.x - b.x, a.y - b.y };
+}
+
+// LESSON: Testing only where things are at the end of a tick misses anything
+// that passed through something else during the tick (a bullet moving 25 px per
+// tick at 20 Hz jumps right over a 20 px enemy). The swept versions below look
+// at the whole step instead. Both objects move in a straight line during a tick,
+// so we can hold one still and move the other by the difference: the question
+// becomes "when does a moving point first enter a shape?", t in [0, 1].
+
+// Earliest t in [0, 1] at which start + delta * t lies in the box around the
+// origin with half extents `half` (slab test: clip the segment axis by axis)
+static bool SegmentBox(Vector2 start, Vector2 delta, Vector2 half, float *t) {
+    float s[2] = { start.x, start.y }, d[2] = { delta.x, delta.y }, h[2] = { half.x, half.y };
+    float enter = 0.0f, leave = 1.0f;
+    for (int axis = 0; axis < 2; axis++) {
+        if (d[axis] == 0.0f) {
+            if (fabsf(s[axis]) > h[axis]) return false;
+            continue;
+        }
+        float t0 = (-h[axis] - s[axis]) / d[axis];
+        float t1 = (h[axis] - s[axis]) / d[axis];
+        if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+        if (t0 > enter) enter = t0;
+        if (t1 < leave) leave = t1;
+        if (enter > leave) return false;
+    }
+    *t = enter;
+    return true;
+}
+
+// Earliest t in [0, 1] at which start + delta * t is within radius of center
+static bool SegmentCircle(Vector2 start, Vector2 delta, Vector2 center, float radius, float *t) {
+    float mx = start.x - center.x, my = start.y - center.y;
+    float c = mx * mx + my * my - radius * radius;
+    if (c <= 0.0f) { *t = 0.0f; return true; }     // Already inside
+    float a = delta.x * delta.x + delta.y * delta.y;
+    float b = mx * delta.x + my * delta.y;
+    if (a == 0.0f || b >= 0.0f) return false;       // Not moving, or moving away
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) return false;
+    float hit = (-b - sqrtf(discriminant)) / a;
+    if (hit > 1.0f) return false;
+    *t = hit;
+    return true;
+}
+
+// Where exactly a circle moving from start (relative to the center of a box
+// with half extents `half`) first touches it. A circle touches the box when its
+// center is inside the box grown by the radius with rounded corners: two crossed
+// boxes plus a circle on each corner. The earliest entry into any of them is the
+// time of impact.
+static bool RoundedBoxImpact(Vector2 start, Vector2 motion, Vector2 half, float radius, float *toi) {
+    float t;
+    if (!SegmentBox(start, motion, (Vector2){ half.x + radius, half.y + radius }, &t)) return false;
+
+    float best = 2.0f;
+    if (SegmentBox(start, motion, (Vector2){ half.x + radius, half.y }, &t) && t < best) best = t;
+    if (SegmentBox(start, motion, (Vector2){ half.x, half.y + radius }, &t) && t < best) best = t;
+    for (int corner = 0; corner < 4; corner++) {
+        Vector2 c = { (corner & 1) ? half.x : -half.x, (corner & 2) ? half.y : -half.y };
+        if (SegmentCircle(start, motion, c, radius, &t) && t < best) best = t;
+    }
+    if (best > 1.0f) return false;
+    *toi = best;
+    return true;
+}
+
+// Swept version of raylib's CheckCollisionCircleRec() (kept free of raylib so
+// the simulation doesn't link against it): the circle starts at center and
+// moves by motion while rec stays put.
+static inline bool SweepCircleRec(Vector2 center, Vector2 motion, float radius, Rectangle rec, float *toi) {
+    Vector2 half = { rec.width / 2.0f, rec.height / 2.0f };
+    Vector2 start = { center.x - (rec.x + half.x), center.y - (rec.y + half.y) };
+
+    // Most pairs are nowhere near each other, which a look at the box around
+    // the path settles without a single division
+    Vector2 outer = { half.x + radius, half.y + radius };
+    Vector2 end = { start.x + motion.x, start.y + motion.y };
+    if ((start.x > outer.x && end.x > outer.x) || (start.x < -outer.x && end.x < -outer.x)) return false;
+    if ((start.y > outer.y && end.y > outer.y) || (start.y < -outer.y && end.y < -outer.y)) return false;
+    return RoundedBoxImpact(start, motion, half, radius, toi);
+}
+
+// Swept CheckCollisionRecs(): does b, moving by motion relative to a, touch a during the step?
+static inline bool SweepRecs(Rectangle a, Rectangle b, Vector2 motion) {
+    Vector2 start = { (b.x + b.width / 2) - (a.x + a.width / 2), (b.y + b.height / 2) - (a.y + a.height / 2) };
+    Vector2 half = { (a.width + b.width) / 2, (a.height + b.height) / 2 };
+    Vector2 end = { start.x + motion.x, start.y + motion.y };
+    if ((start.x > half.x && end.x > half.x) || (start.x < -half.x && end.x < -half.x)) return false;
+    if ((start.y > half.y && end.y > half.y) || (start.y < -half.y && end.y < -half.y)) return false;
+    float t;
+    return SegmentBox(start, motion, half, &t);
+}
+
+// FNV-1a over raw bytes: simple, and any changed bit changes the result
+static unsigned int HashBytes(unsigned int hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static unsigned int HashFloat(unsigned int hash, float value) {
+    return HashBytes(hash, &value, sizeof(value));
+}
+
+static unsigned int HashInt(unsigned int hash, int value) {
+    return HashBytes(hash, &value, sizeof(value));
+}
+
+// One flag per entity, 32 to a word (the dead bitsets in CollisionScratch)
+#define BITSET_WORDS(count) (((size_t)(count) + 31) / 32)
+
+static inline void BitSet(uint32_t *bits, int i) {
+    bits[i >> 5] |= 1u << (i & 31);
+}
+
+static inline bool BitTest(const uint32_t *bits, int i) {
+    return (bits[i >> 5] >> (i & 31)) & 1u;
+}
+
+// Fields are hashed one by one: struct padding holds garbage
+unsigned int SimChecksum(const Simulation *sim) {
+    unsigned int h = 2166136261u;
+    const Player *p = &sim->player;
+    h = HashFloat(h, p->position.x);
+    h = HashFloat(h, p->position.y);
+    h = HashInt(h, p->health);
+    h = HashInt(h, p->score);
+    h = HashFloat(h, p->shoot_timer);
+    h = HashFloat(h, p->damage_timer);
+    h = HashInt(h, p->active);
+
+    h = HashInt(h, sim->bulletPool.count);
+    for (int i = 0; i < sim->bulletPool.count; i++) {
+        h = HashFloat(h, sim->bullets[i].position.x);
+        h = HashFloat(h, sim->bullets[i].position.y);
+    }
+    h = HashInt(h, sim->enemyPool.count);
+    for (int i = 0; i < sim->enemyPool.count; i++) {
+        const Enemy *e = &sim->enemies[i];
+        h = HashFloat(h, e->position.x);
+        h = HashFloat(h, e->position.y);
+        h = HashInt(h, e->health);
+        h = HashInt(h, e->type);
+    }
+    // Only worlds that froze someone hash the frozen pool: one-screen games keep their hashes
+    if (sim->frozenPool.count > 0) {
+        h = HashInt(h, sim->frozenPool.count);
+        for (int i = 0; i < sim->frozenPool.count; i++) {
+            const Enemy *e = &sim->frozen[i];
+            h = HashFloat(h, e->position.x);
+            h = HashFloat(h, e->position.y);
+            h = HashInt(h, e->health);
+            h = HashInt(h, e->type);
+        }
+    }
+    h = HashFloat(h, sim->gameTime);
+    h = HashFloat(h, sim->enemyTimer);
+    h = HashInt(h, sim->wave);
+    h = HashBytes(h, &sim->rngState, sizeof(sim->rngState));
+    return h;
+}
+
+// =====================================================================
+// LESSON 19: A WORLD BIGGER THAN THE SCREEN
+// =====================================================================
+// The screen shows one SCREEN_HEIGHT tall window (the view) of a world that can
+// be many screens tall; it follows the player, keeping them in the lower part
+// of the screen. Simulating the whole world every tick would make a tick cost
+// whatever the world holds, so the world is cut into rows of chunks and only the
+// ones near the view run at full rate (see SimWorld in sim.h). Enemies that drift
+// into a frozen chunk move to a separate pool, grouped by chunk, and come back
+// when the view gets near again: a tick costs what is around the view.
+
+float SimViewTop(const Simulation *sim, float playerY) {
+    float top = playerY - SCREEN_HEIGHT * 0.75f;
+    float bottom = (float)(sim->config.worldHeight - SCREEN_HEIGHT);
+    return top < 0.0f ? 0.0f : (top > bottom ? bottom : top);
+}
+
+int SimChunkOf(const Simulation *sim, float y) {
+    int c = (int)floorf(y / SIM_CHUNK_HEIGHT) + 1;
+    return c < 0 ? 0 : (c >= sim->world.chunkCount ? sim->world.chunkCount - 1 : c);
+}
+
+static bool ChunkAwake(const SimWorld *world, int c) {
+    return c >= world->awakeFirst && c <= world->awakeLast;
+}
+
+// World y covered by chunks [first, last], for loops that would rather compare
+// than call SimChunkOf per entity. The first and last chunk reach past the
+// world's edges (SimChunkOf clamps), so when they are in so is everything beyond.
+static void ChunkRange(const SimWorld *world, int first, int last, float *top, float *bottom) {
+    *top = first == 0 ? -INFINITY : (float)((first - 1) * SIM_CHUNK_HEIGHT);
+    *bottom = last == world->chunkCount - 1 ? INFINITY : (float)(last * SIM_CHUNK_HEIGHT);
+}
+
+static void UpdateWorld(Simulation *sim) {
+    SimWorld *world = &sim->world;
+    world->chunkCount = SimChunkCount(&sim->config);
+    world->viewTop = SimViewTop(sim, sim->player.position.y);
+    float viewBottom = world->viewTop + SCREEN_HEIGHT;
+    world->activeFirst = SimChunkOf(sim, world->viewTop - SIM_ACTIVE_MARGIN);
+    world->activeLast = SimChunkOf(sim, viewBottom + SIM_ACTIVE_MARGIN);
+    world->awakeFirst = SimChunkOf(sim, world->viewTop - SIM_REDUCED_MARGIN);
+    world->awakeLast = SimChunkOf(sim, viewBottom + SIM_REDUCED_MARGIN);
+}
+
+// =====================================================================
+// LESSON 4: GAME INITIALIZATION
+// =====================================================================
+// All entity arrays come out of one arena, allocated once at startup with
+// the capacities from the config. A new game doesn't clear any of them: it
+// empties the pools and resets the arena. Slots past a pool's count are
+// never read, and a spawn writes every field of the slot it gets.
+
+SimConfig SimDefaultConfig(void) {
+    return (SimConfig){
+        DEFAULT_MAX_BULLETS,
+        DEFAULT_MAX_ENEMIES,
+        DEFAULT_MAX_STARS,
+        DEFAULT_MAX_PARTICLES,
+        DEFAULT_MAX_FROZEN_ENEMIES,
+        DEFAULT_WORLD_HEIGHT
+    };
+}
+
+SimTuning SimDefaultTuning(void) {
+    SimTuning tuning = { 2.0f, 30.0f, 20.0f, { 0 } };
+    for (int t = 0; t < ENEMY_TYPE_COUNT; t++) tuning.spawnChance[t] = enemyArchetypes[t].spawnChance;
+    return tuning;
+}
+
+// Every bullet hits at most once and every enemy dies at most once per tick,
+// plus the player's damage and death
+static size_t EventCapacity(const SimConfig *config) {
+    return (size_t)config->maxBullets + (size_t)config->maxEnemies + 2;
+}
+
+// Chunks above, in and below the world (see SimWorld)
+int SimChunkCount(const SimConfig *config) {
+    int height = config->worldHeight > SCREEN_HEIGHT ? config->worldHeight : SCREEN_HEIGHT;
+    return (height + SIM_CHUNK_HEIGHT - 1) / SIM_CHUNK_HEIGHT + 2;
+}
+
+size_t SimArenaSize(const SimConfig *config) {
+    size_t bullets = (size_t)config->maxBullets;
+    size_t enemies = (size_t)config->maxEnemies;
+    return ARENA_ALIGNMENT +
+           ArenaAlignedSize(bullets * sizeof(Bullet)) +
+           ArenaAlignedSize(enemies * sizeof(Enemy)) +
+           ArenaAlignedSize((size_t)config->maxFrozenEnemies * sizeof(Enemy)) +
+           ArenaAlignedSize((size_t)(SimChunkCount(config) + 1) * sizeof(int)) +     // Frozen starts
+           ParticlePoolArenaSize(config->maxParticles) +
+           3 * ArenaAlignedSize(bullets * sizeof(int)) +      // Grid items, bullet owners, hit list
+           ArenaAlignedSize((enemies + 1) * sizeof(int)) +    // Hit starts
+           ArenaAlignedSize(enemies) +                        // Touches player
+           ArenaAlignedSize(BITSET_WORDS(bullets) * 4) +      // Dead bullets
+           ArenaAlignedSize(BITSET_WORDS(enemies) * 4) +      // Dead enemies
+           ArenaAlignedSize(EventCapacity(config) * sizeof(SimEvent));
+}
+
+// Hand out every array, in a fixed order, from the start of the arena
+static bool CarveArrays(Simulation *sim) {
+    const SimConfig *config = &sim->config;
+    Arena *arena = &sim->arena;
+    size_t bullets = (size_t)config->maxBullets;
+    size_t enemies = (size_t)config->maxEnemies;
+
+    ArenaReset(arena);
+    sim->bullets = ArenaAlloc(arena, bullets * sizeof(Bullet));
+    sim->enemies = ArenaAlloc(arena, enemies * sizeof(Enemy));
+    sim->frozen = ArenaAlloc(arena, (size_t)config->maxFrozenEnemies * sizeof(Enemy));
+    sim->frozenStart = ArenaAlloc(arena, (size_t)(SimChunkCount(config) + 1) * sizeof(int));
+    bool ok = ParticlePoolCarve(&sim->particles, arena, config->maxParticles);
+    sim->bulletGrid.items = ArenaAlloc(arena, bullets * sizeof(int));
+    sim->collision.bulletOwner = ArenaAlloc(arena, bullets * sizeof(int));
+    sim->collision.hitList = ArenaAlloc(arena, bullets * sizeof(int));
+    sim->collision.hitStart = ArenaAlloc(arena, (enemies + 1) * sizeof(int));
+    sim->collision.touchesPlayer = ArenaAlloc(arena, enemies);
+    sim->collision.deadBullets = ArenaAlloc(arena, BITSET_WORDS(bullets) * 4);
+    sim->collision.deadEnemies = ArenaAlloc(arena, BITSET_WORDS(enemies) * 4);
+    sim->events.items = ArenaAlloc(arena, EventCapacity(config) * sizeof(SimEvent));
+    sim->events.capacity = (int)EventCapacity(config);
+    sim->events.count = 0;
+
+    PoolInit(&sim->bulletPool, config->maxBullets);
+    PoolInit(&sim->enemyPool, config->maxEnemies);
+    memset(sim->enemyBucket, 0, sizeof(sim->enemyBucket));
+    PoolInit(&sim->frozenPool, config->maxFrozenEnemies);
+    if (sim->frozenStart) memset(sim->frozenStart, 0, (size_t)(SimChunkCount(config) + 1) * sizeof(int));
+    return ok && sim->events.items != NULL;  // The last one fails first
+}
+
+bool SimCreate(Simulation *sim, const SimConfig *config) {
+    memset(sim, 0, sizeof(*sim));
+    sim->config = *config;
+    sim->particleScale = 1.0f;
+    sim->tuning = SimDefaultTuning();
+    if (sim->config.maxBullets < 0) sim->config.maxBullets = 0;
+    if (sim->config.maxEnemies < 0) sim->config.maxEnemies = 0;
+    if (sim->config.maxEnemies > 1 << 24) sim->config.maxEnemies = 1 << 24;  // See HIT_INDEX_BITS
+    if (sim->config.maxStars < 0) sim->config.maxStars = 0;
+    if (sim->config.maxParticles < 0) sim->config.maxParticles = 0;
+    if (sim->config.maxFrozenEnemies < 0) sim->config.maxFrozenEnemies = 0;
+    if (sim->config.worldHeight < SCREEN_HEIGHT) sim->config.worldHeight = SCREEN_HEIGHT;
+
+    size_t size = SimArenaSize(&sim->config);
+    ArenaInit(&sim->arena, malloc(size), size);
+    if (!sim->arena.base || !CarveArrays(sim)) {
+        SimDestroy(sim);
+        return false;
+    }
+    return true;
+}
+
+void SimDestroy(Simulation *sim) {
+    free(sim->arena.base);
+    ArenaInit(&sim->arena, NULL, 0);
+}
+
+// We reset all objects every time a new game starts.
+void SimInit(Simulation *sim, unsigned int seed) {
+    sim->rngState = seed ? seed : 0x9E3779B9u; // xorshift must not start at zero
+    sim->particleRng = sim->rngState ^ 0x5BD1E995u;
+    if (sim->particleRng == 0) sim->particleRng = 0x9E3779B9u;
+
+    // Player initial values
+    Player *player = &sim->player;
+    player->position = (Vector2){ SCREEN_WIDTH / 2.0f, sim->config.worldHeight - 80.0f };
+    player->prev_position = player->position;
+    player->size = (Vector2){ 40.0f, 40.0f };
+    player->speed = 300.0f;
+    player->health = 5;
+    player->score = 0;
+    player->shoot_timer = 0;
+    player->active = true;
+    player->damage_timer = 0;
+
+    // No bullets, enemies or particles yet: O(1), nothing is cleared slot by slot
+    // (only the frozen pool's chunk starts, one number per chunk)
+    CarveArrays(sim);
+    sim->palette.count = 0;
+    sim->ticks = 0;
+    UpdateWorld(sim);
+    sim->particles.originY = floorf(sim->world.viewTop);
+
+    sim->gameTime = 0;
+    sim->enemyTimer = 0;
+    sim->wave = 1;
+    sim->difficultyMultiplier = 1.0f;
+    sim->broadphase = true;
+}
+
+void SimCopyState(Simulation *dst, const Simulation *src) {
+    dst->player = src->player;
+    memcpy(dst->bullets, src->bullets, (size_t)src->bulletPool.count * sizeof(Bullet));
+    dst->bulletPool = src->bulletPool;         // Same capacity: this copies the count and counters
+    memcpy(dst->enemies, src->enemies, (size_t)src->enemyPool.count * sizeof(Enemy));
+    dst->enemyPool = src->enemyPool;
+    memcpy(dst->enemyBucket, src->enemyBucket, sizeof(dst->enemyBucket));
+    dst->world = src->world;
+    dst->ticks = src->ticks;
+    ParticlePoolCopy(&dst->particles, &src->particles);     // Its origin too
+    dst->palette = src->palette;
+
+    dst->gameTime = src->gameTime;
+    dst->enemyTimer = src->enemyTimer;
+    dst->wave = src->wave;
+    dst->difficultyMultiplier = src->difficultyMultiplier;
+    dst->rngState = src->rngState;
+    dst->particleRng = src->particleRng;
+    dst->particleScale = src->particleScale;
+    dst->tuning = src->tuning;
+    dst->broadphase = src->broadphase;
+
+    int events = src->events.count < src->events.capacity ? src->events.count : src->events.capacity;
+    memcpy(dst->events.items, src->events.items, (size_t)events * sizeof(SimEvent));
+    dst->events.count = events;
+    dst->events.dropped = src->events.dropped;
+}
+
+// =====================================================================
+// LESSON 6: PARTICLE SYSTEM
+// =====================================================================
+// Particle system for explosions and effects.
+// Each particle has a lifetime, velocity, and color.
+
+// A game uses a handful of colors, so a short linear search is all it takes.
+// Indices are handed out in first-use order, which the seed fixes.
+int SimPaletteIndex(Simulation *sim, Color color) {
+    SimPalette *palette = &sim->palette;
+    for (int i = 0; i < palette->count; i++) {
+        Color c = palette->colors[i];
+        if (c.r == color.r && c.g == color.g && c.b == color.b && c.a == color.a) return i;
+    }
+    if (palette->count < SIM_PALETTE_SIZE) {
+        palette->colors[palette->count] = color;
+        return palette->count++;
+    }
+
+    int best = 0, bestDistance = INT_MAX;
+    for (int i = 0; i < palette->count; i++) {
+        Color c = palette->colors[i];
+        int dr = c.r - color.r, dg = c.g - color.g, db = c.b - color.b, da = c.a - color.a;
+        int distance = dr * dr + dg * dg + db * db + da * da;
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// A particle field in its fixed-point form (see ParticlePool in sim.h). Shifted
+// to be positive, truncating rounds to nearest: no libm call, no sign branch.
+static int16_t ParticleFixed(float value, float scale) {
+    value *= scale;
+    if (value < -32768.0f) value = -32768.0f;
+    if (value > 32767.0f) value = 32767.0f;
+    return (int16_t)((int)(value + 32768.5f) - 32768);
+}
+
+// One explosion reserves all of its particles with a single PoolSpawn call;
+// if the pool is nearly full the burst is cut short (the rest counts as dropped). particleScale (the quality
+// level) shrinks every burst, but never below one particle.
+void SimSpawnParticles(Simulation *sim, Vector2 position, Color color, int count) {
+    ParticlePool *pool = &sim->particles;
+    if (sim->particleScale != 1.0f && count > 0) {
+        int scaled = (int)(count * sim->particleScale + 0.5f);
+        count = scaled > 0 ? scaled : 1;
+    }
+    int first;
+    int granted = PoolSpawn(&pool->slots, count, &first);
+    if (granted == 0) return;
+
+    uint8_t paletteIndex = (uint8_t)SimPaletteIndex(sim, color);
+    int16_t x = ParticleFixed(position.x, PARTICLE_POSITION_SCALE);
+    int16_t y = ParticleFixed(position.y - pool->originY, PARTICLE_POSITION_SCALE);
+    for (int i = first; i < first + granted; i++) {
+        pool->x[i] = pool->prev_x[i] = x;
+        pool->y[i] = pool->prev_y[i] = y;
+        // Spread in random directions
+        float angle = ParticleRandomFloat(sim, 0, 2.0f * PI);
+        float spd = ParticleRandomFloat(sim, 50.0f, 250.0f);
+        // These ranges fit the fixed-point types as they are: no clamping needed
+        pool->vx[i] = (int16_t)(cosf(angle) * spd * PARTICLE_VELOCITY_SCALE);
+        pool->vy[i] = (int16_t)(sinf(angle) * spd * PARTICLE_VELOCITY_SCALE);
+        pool->radius[i] = (uint8_t)(ParticleRandomFloat(sim, 2.0f, 6.0f) * PARTICLE_RADIUS_SCALE);
+        pool->lifetime[i] = (int16_t)(ParticleRandomFloat(sim, 0.3f, 0.8f) * PARTICLE_LIFETIME_SCALE);
+        pool->max_lifetime[i] = pool->lifetime[i];
+        pool->color[i] = paletteIndex;
+    }
+}
+
+typedef struct {
+    ParticlePool *pool;
+    float         dt;
+    float         drag;
+    int           expired;
+} ParticleJob;
+
+static void IntegrateParticlesJob(void *context, int begin, int end) {
+    ParticleJob *job = context;
+    int expired = ParticlePoolIntegrateRange(job->pool, begin, end, job->dt, job->drag);
+    if (expired > 0) JobAtomicAdd(&job->expired, expired);
+}
+
+void SimUpdateParticles(Simulation *sim, float dt) {
+    // Drag used to be 0.98 per frame; scale it by dt so the tick rate doesn't matter
+    ParticleJob job = { &sim->particles, dt, powf(0.98f, dt * 60.0f), 0 };
+
+    JobParallelFor(sim->jobs, sim->particles.slots.count, CHUNK_PARTICLES, IntegrateParticlesJob, &job);
+    if (job.expired > 0) ParticlePoolRemoveExpired(&sim->particles);
+}
+
+// =====================================================================
+// LESSON 7: SHOOTING BULLETS
+// =====================================================================
+// Take the next free bullet slot from the pool (O(1), no searching).
+// When all config.maxBullets are in flight the shot is dropped (and counted
+// in bulletPool.dropped).
+
+void SimShootBullet(Simulation *sim, Vector2 position, Vector2 velocity, Color color) {
+    int i;
+    if (!PoolSpawn(&sim->bulletPool, 1, &i)) return;
+
+    Bullet *b = &sim->bullets[i];
+    b->position = position;
+    b->prev_position = position;
+    b->velocity = velocity;
+    b->radius = 4.0f;
+    b->color = (uint8_t)SimPaletteIndex(sim, color);
+}
+
+// =====================================================================
+// LESSON 8: SPAWNING ENEMIES
+// =====================================================================
+// Different enemy types: normal, fast, strong. Instead of an if/else chain
+// in every function that cares about the type, each type is one row of
+// data: stats for spawning, score and explosion for kills, and the shapes
+// it is drawn with (baked into sprites by sprites.c).
+
+const EnemyArchetype enemyArchetypes[ENEMY_TYPE_COUNT] = {
+    [ENEMY_NORMAL] = {
+        // Deep red-purple square, red burst
+        .name = "Normal", .spawnChance = 60,
+        .size = { 30.0f, 30.0f }, .speed = 80.0f, .speedPerWave = 10.0f,
+        .health = 1, .points = 100,
+        .explosion = { { { 255, 60, 30, 255 }, 10 }, { { 255, 160, 50, 255 }, 6 } },
+        .parts = {
+            { .shape = ENEMY_PART_RECT, .scale = 1.0f, .wobble = 15.0f, .color = { 180, 20, 80, 255 } },
+            { .shape = ENEMY_PART_RECT, .scale = 0.6f, .wobble = 15.0f, .color = { 240, 60, 130, 255 } },
+        },
+        .partCount = 2,
+    },
+    [ENEMY_FAST] = {
+        // Magenta triangle pointing down (clockwise for raylib screen coords)
+        // with a bright outline so it's always visible; cyan/white flash
+        .name = "Fast", .spawnChance = 25,
+        .size = { 20.0f, 20.0f }, .speed = 150.0f, .speedPerWave = 15.0f,
+        .health = 1, .points = 150,
+        .explosion = { { { 0, 230, 255, 255 }, 10 }, { { 255, 255, 255, 255 }, 5 } },
+        .parts = {
+            { .shape = ENEMY_PART_TRIANGLE, .v = { { 0, -13 }, { 14, 13 }, { -14, 13 } }, .color = { 220, 0, 120, 255 } },
+            { .shape = ENEMY_PART_TRIANGLE, .v = { { 0, -6 }, { 7, 6 }, { -7, 6 } }, .color = { 255, 80, 180, 255 } },
+            { .shape = ENEMY_PART_TRIANGLE_LINES, .v = { { 0, -13 }, { 14, 13 }, { -14, 13 } }, .color = { 255, 150, 220, 255 } },
+        },
+        .partCount = 3,
+    },
+    [ENEMY_STRONG] = {
+        // Bright purple hexagon with health dots, purple + magenta blast
+        .name = "Strong", .spawnChance = 15,
+        .size = { 40.0f, 40.0f }, .speed = 50.0f, .speedPerWave = 5.0f,
+        .health = 3, .points = 300,
+        .explosion = { { { 200, 0, 255, 255 }, 15 }, { { 255, 80, 200, 255 }, 8 } },
+        .parts = {
+            { .shape = ENEMY_PART_POLY, .sides = 6, .scale = 1.0f / 2, .spin = 10.0f, .color = { 140, 0, 200, 255 } },
+            { .shape = ENEMY_PART_POLY, .sides = 6, .scale = 1.0f / 3, .spin = 10.0f, .color = { 200, 60, 255, 255 } },
+        },
+        .partCount = 2,
+        .pips = { 255, 80, 180, 255 },
+    },
+};
+
+// Keeping the buckets contiguous costs one move per bucket after the one
+// that changes, never a shift of the whole array:
+//
+//   insert into t:  the first enemy of every later bucket moves to that
+//                   bucket's end, opening a slot at the end of bucket t
+//   remove from t:  the hole is filled from the end of bucket t, and the new
+//                   hole from the end of every later bucket in turn
+//
+// Everything that moves comes from a higher index, so a loop that removes
+// while iterating works just like with a plain pool: look at i again.
+
+static int InsertEnemySlot(Simulation *sim, EnemyType type) {
+    int slot;
+    if (!PoolSpawn(&sim->enemyPool, 1, &slot)) return -1;
+
+    int *bucket = sim->enemyBucket;
+    for (int t = ENEMY_TYPE_COUNT - 1; t > (int)type; t--) {
+        sim->enemies[bucket[t + 1]] = sim->enemies[bucket[t]];
+        bucket[t + 1]++;
+    }
+    slot = bucket[type + 1]++;
+    return slot;
+}
+
+static void RemoveEnemy(Simulation *sim, int i) {
+    int *bucket = sim->enemyBucket;
+    int t = sim->enemies[i].type;
+    int hole = i;
+    for (; t < ENEMY_TYPE_COUNT; t++) {
+        int last = --bucket[t + 1];             // Bucket t now ends one earlier...
+        sim->enemies[hole] = sim->enemies[last];
+        hole = last;                            // ...and bucket t + 1 starts there
+    }
+    PoolRemove(&sim->enemyPool, i);
+}
+
+// Frozen enemies (LESSON 19) are grouped by chunk exactly like live ones are
+// grouped by type, so freezing or waking one costs one move per later chunk.
+// A full frozen pool drops the enemy (counted in frozenPool.dropped).
+static bool FreezeEnemy(Simulation *sim, const Enemy *e) {
+    int slot;
+    if (!PoolSpawn(&sim->frozenPool, 1, &slot)) return false;
+
+    int chunk = SimChunkOf(sim, e->position.y);
+    int *start = sim->frozenStart;
+    for (int c = sim->world.chunkCount - 1; c > chunk; c--) {
+        sim->frozen[start[c + 1]] = sim->frozen[start[c]];
+        start[c + 1]++;
+    }
+    sim->frozen[start[chunk + 1]++] = *e;
+    return true;
+}
+
+// Take the last frozen enemy of a chunk out of the frozen pool
+static Enemy ThawEnemy(Simulation *sim, int chunk) {
+    int *start = sim->frozenStart;
+    int hole = start[chunk + 1] - 1;
+    Enemy e = sim->frozen[hole];
+    for (int c = chunk; c < sim->world.chunkCount; c++) {
+        int last = --start[c + 1];
+        sim->frozen[hole] = sim->frozen[last];
+        hole = last;
+    }
+    PoolRemove(&sim->frozenPool, hole);
+    return e;
+}
+
+// Bring back the frozen enemies of chunk c while the live pool has room.
+// False once it is full.
+static bool WakeChunk(Simulation *sim, int c) {
+    while (sim->frozenStart[c + 1] > sim->frozenStart[c]) {
+        if (sim->enemyPool.count >= sim->enemyPool.capacity) return false;
+        Enemy e = ThawEnemy(sim, c);
+        int i = InsertEnemySlot(sim, (EnemyType)e.type);
+        e.prev_position = e.position;
+        sim->enemies[i] = e;
+    }
+    return true;
+}
+
+// Wake the chunks of [first, last] nearest the view first: the ones it overlaps,
+// then one more above and one more below at a time
+static bool WakeRange(Simulation *sim, int first, int last) {
+    const SimWorld *world = &sim->world;
+    int top = SimChunkOf(sim, world->viewTop);
+    int bottom = SimChunkOf(sim, world->viewTop + SCREEN_HEIGHT - 1);
+    for (int c = top > first ? top : first; c <= bottom && c <= last; c++) {
+        if (!WakeChunk(sim, c)) return false;
+    }
+    for (int d = 1; top - d >= first || bottom + d <= last; d++) {
+        if (top - d >= first && top - d <= last && !WakeChunk(sim, top - d)) return false;
+        if (bottom + d <= last && bottom + d >= first && !WakeChunk(sim, bottom + d)) return false;
+    }
+    return true;
+}
+
+// Bring back the frozen enemies of every awake chunk while the live pool has
+// room: the active chunks first, then the reduced-rate ring, nearest the view
+// first, so a full pool is spent on what is on screen. Only the awake chunks
+// are looked at. Enemies that don't fit wait in sim->frozen for a later tick;
+// while they wait they are neither drawn nor hit, even inside the view. Live
+// enemies keep their slots anywhere in the awake chunks, so a live pool smaller
+// than what is near the view still leaves holes on screen.
+static void WakeEnemies(Simulation *sim) {
+    const SimWorld *world = &sim->world;
+    if (sim->frozenPool.count == 0) return;
+    if (WakeRange(sim, world->activeFirst, world->activeLast))
+        WakeRange(sim, world->awakeFirst, world->awakeLast);    // The active chunks are empty by now
+}
+
+int SimSpawnEnemyType(Simulation *sim, EnemyType type, Vector2 position) {
+    // A place far from the view goes straight into the frozen pool
+    bool awake = ChunkAwake(&sim->world, SimChunkOf(sim, position.y));
+    if (awake && sim->enemyPool.count >= sim->enemyPool.capacity) {
+        PoolRefuse(&sim->enemyPool, 1);
+        return -1;
+    }
+
+    const EnemyArchetype *arch = &enemyArchetypes[type];
+    Enemy e;
+    e.position = position;
+    e.prev_position = position;
+    e.type = type;
+    e.size = arch->size;
+    e.speed = arch->speed + sim->wave * arch->speedPerWave;
+    e.health = arch->health;
+    e.move_angle = SimRandomFloat(sim, 0, 2.0f * PI);
+    if (!awake) {
+        FreezeEnemy(sim, &e);
+        return -1;
+    }
+
+    int i = InsertEnemySlot(sim, type);
+    sim->enemies[i] = e;
+    return i;
+}
+
+int SimSpawnEnemy(Simulation *sim) {
+    // Checked before the random numbers are drawn, so a full pool doesn't change the game
+    if (sim->enemyPool.count >= sim->enemyPool.capacity) {
+        PoolRefuse(&sim->enemyPool, 1);
+        return -1;
+    }
+
+    Vector2 position = { (float)SimRandomInt(sim, 40, SCREEN_WIDTH - 40), sim->world.viewTop - 40.0f };
+
+    // Determine type (harder enemies appear as waves progress)
+    int typeChance = SimRandomInt(sim, 0, 100);
+    int type = 0;
+    for (int limit = sim->tuning.spawnChance[0];
+         type < ENEMY_TYPE_COUNT - 1 && typeChance >= limit;
+         limit += sim->tuning.spawnChance[++type]) {}
+
+    return SimSpawnEnemyType(sim, (EnemyType)type, position);
+}
+
+// Despawn with swap-remove: the last live entity fills the hole
+static void RemoveBullet(Simulation *sim, int i) {
+    sim->bullets[i] = sim->bullets[PoolRemove(&sim->bulletPool, i)];
+}
+
+// =====================================================================
+// LESSON 15: SPATIAL GRID BROADPHASE
+// =====================================================================
+// Testing every enemy against every bullet costs enemies x bullets checks.
+// Instead we sort the bullets into a uniform grid once per tick (a counting
+// sort, so each cell lists its bullets in ascending index order) and each
+// enemy only looks at the cells its rectangle touches.
+
+static int GridColumn(float x) {
+    int c = (int)floorf(x / GRID_CELL_SIZE);
+    return c < 0 ? 0 : (c >= GRID_COLS ? GRID_COLS - 1 : c);
+}
+
+// Rows start at the top of the view (LESSON 19), which is where every bullet is
+static int GridRow(const BulletGrid *grid, float y) {
+    int r = (int)floorf((y - grid->top) / GRID_CELL_SIZE);
+    return r < 0 ? 0 : (r >= GRID_ROWS ? GRID_ROWS - 1 : r);
+}
+
+// Positions outside the playfield clamp to the border cells, which keeps
+// "rectangles overlap => cell ranges overlap" true everywhere.
+static int GridCell(const BulletGrid *grid, Vector2 p) {
+    return GridRow(grid, p.y) * GRID_COLS + GridColumn(p.x);
+}
+
+static void BuildBulletGrid(Simulation *sim) {
+    BulletGrid *grid = &sim->bulletGrid;
+    memset(grid->cellStart, 0, sizeof(grid->cellStart));
+    grid->maxRadius = 0;
+    grid->maxTravel = (Vector2){ 0, 0 };
+    grid->top = sim->world.viewTop;
+
+    // Count bullets per cell (only upward bullets can hit enemies). A bullet is
+    // filed where it ended the step; maxTravel says how far back along its path
+    // a query has to look to still find it.
+    for (int j = 0; j < sim->bulletPool.count; j++) {
+        const Bullet *b = &sim->bullets[j];
+        if (b->velocity.y >= 0) continue;
+        grid->cellStart[GridCell(grid, b->position) + 1]++;
+        if (b->radius > grid->maxRadius) grid->maxRadius = b->radius;
+        float dx = fabsf(b->position.x - b->prev_position.x), dy = fabsf(b->position.y - b->prev_position.y);
+        if (dx > grid->maxTravel.x) grid->maxTravel.x = dx;
+        if (dy > grid->maxTravel.y) grid->maxTravel.y = dy;
+    }
+
+    // Prefix sum turns counts into start offsets
+    for (int c = 0; c < GRID_CELLS; c++) {
+        grid->cellStart[c + 1] += grid->cellStart[c];
+        grid->cellFill[c] = grid->cellStart[c];
+    }
+
+    for (int j = 0; j < sim->bulletPool.count; j++) {
+        const Bullet *b = &sim->bullets[j];
+        if (b->velocity.y >= 0) continue;
+        grid->items[grid->cellFill[GridCell(grid, b->position)]++] = j;
+    }
+}
+
+static Rectangle EnemyRect(const Enemy *e, Vector2 position) {
+    return (Rectangle){
+        position.x - e->size.x / 2,
+        position.y - e->size.y / 2,
+        e->size.x,
+        e->size.y
+    };
+}
+
+// =====================================================================
+// LESSON 16: PARALLEL COLLISIONS
+// =====================================================================
+// Enemies used to be checked one after another, each one consuming the
+// bullets it touched. The outcome of that loop is easy to describe: a
+// bullet is used up by the enemy with the lowest index that it overlaps,
+// and an enemy touching the player rams it if the player can still take
+// damage at that point. So collisions are split in two phases:
+//
+//   DETECT  (all threads)  every enemy tests its bullets and the player,
+//                          and claims each bullet with JobAtomicMin(), so
+//                          the lowest index wins whichever thread is first
+//   RESOLVE (one thread)   enemies go through their hits in index order and
+//                          write down what happens as events (see below)
+//
+// The result is the same as the old one-by-one loop, for any thread count.
+//
+// Since the tests became swept (see SweepCircleRec), "first" means first in
+// time: a bullet belongs to the enemy it reaches earliest during the step, and
+// the lowest index only breaks ties. Both go into one int so a single
+// JobAtomicMin still decides it: the time of impact, rounded to 1/HIT_TIME_STEPS
+// of a tick, in the high bits and the enemy index in the low HIT_INDEX_BITS.
+// Enemy motion inside a step is taken as a straight line, which is what
+// MoveEnemiesJob does up to the small wave added on top.
+
+#define HIT_INDEX_BITS  24                  // Enough for CONFIG_MAX_CAPACITY enemies
+#define HIT_INDEX_MASK  ((1 << HIT_INDEX_BITS) - 1)
+#define HIT_TIME_STEPS  126                 // 126 << 24 | index stays below HIT_NONE
+#define HIT_NONE        INT_MAX
+
+static int HitKey(float toi, int enemy) {
+    return (int)(toi * HIT_TIME_STEPS) << HIT_INDEX_BITS | enemy;
+}
+
+static void DetectCollisionsJob(void *context, int begin, int end) {
+    Simulation *sim = context;
+    CollisionScratch *col = &sim->collision;
+    const Player *player = &sim->player;
+    Rectangle playerRect = {
+        player->prev_position.x - player->size.x / 2,
+        player->prev_position.y - player->size.y / 2,
+        player->size.x,
+        player->size.y
+    };
+    Vector2 playerMotion = Vector2Subtract(player->position, player->prev_position);
+    float toi;
+
+    for (int i = begin; i < end; i++) {
+        const Enemy *e = &sim->enemies[i];
+        // Everything is measured from where the enemy started the step, with
+        // the other object moving by the difference of the two motions
+        Rectangle enemyRect = EnemyRect(e, e->prev_position);
+        Vector2 enemyMotion = Vector2Subtract(e->position, e->prev_position);
+
+        // --- COLLISION DETECTION: Bullet vs Enemy ---
+        // LESSON: AABB (Axis-Aligned Bounding Box) collision check, swept over the step
+        if (sim->broadphase) {
+            // The cells the enemy covers anywhere during the step, grown by how
+            // far a bullet can be from the point where it touched
+            const BulletGrid *grid = &sim->bulletGrid;
+            float rx = grid->maxRadius + grid->maxTravel.x, ry = grid->maxRadius + grid->maxTravel.y;
+            Vector2 lo = e->prev_position, hi = e->position;
+            if (lo.x > hi.x) { float tmp = lo.x; lo.x = hi.x; hi.x = tmp; }
+            if (lo.y > hi.y) { float tmp = lo.y; lo.y = hi.y; hi.y = tmp; }
+            float x0 = lo.x - e->size.x / 2, x1 = hi.x + e->size.x / 2;
+            float y0 = lo.y - e->size.y / 2, y1 = hi.y + e->size.y / 2;
+            int c0 = GridColumn(x0 - rx), c1 = GridColumn(x1 + rx);
+            int r0 = GridRow(grid, y0 - ry), r1 = GridRow(grid, y1 + ry);
+
+            for (int row = r0; row <= r1; row++) {
+                for (int c = c0; c <= c1; c++) {
+                    int cell = row * GRID_COLS + c;
+                    for (int k = grid->cellStart[cell]; k < grid->cellStart[cell + 1]; k++) {
+                        int j = grid->items[k];
+                        const Bullet *b = &sim->bullets[j];
+                        Vector2 motion = Vector2Subtract(Vector2Subtract(b->position, b->prev_position), enemyMotion);
+                        if (SweepCircleRec(b->prev_position, motion, b->radius, enemyRect, &toi))
+                            JobAtomicMin(&col->bulletOwner[j], HitKey(toi, i));
+                    }
+                }
+            }
+        } else {
+            for (int j = 0; j < sim->bulletPool.count; j++) {
+                const Bullet *b = &sim->bullets[j];
+                if (b->velocity.y >= 0) continue; // Only upward bullets
+
+                Vector2 motion = Vector2Subtract(Vector2Subtract(b->position, b->prev_position), enemyMotion);
+                if (SweepCircleRec(b->prev_position, motion, b->radius, enemyRect, &toi))
+                    JobAtomicMin(&col->bulletOwner[j], HitKey(toi, i));
+            }
+        }
+
+        // --- COLLISION: Enemy vs Player ---
+        col->touchesPlayer[i] = SweepRecs(playerRect, enemyRect, Vector2Subtract(enemyMotion, playerMotion));
+    }
+}
+
+// Add an event to this tick's list (LESSON 17)
+static void EmitEvent(Simulation *sim, SimEventType type, int enemyType, int bullet, int enemy, Vector2 position) {
+    SimEventQueue *q = &sim->events;
+    int slot = JobAtomicAdd(&q->count, 1);     // Claims a slot: safe from any job
+    if (slot >= q->capacity) {
+        JobAtomicAdd(&q->dropped, 1);
+        return;
+    }
+    q->items[slot] = (SimEvent){ (unsigned char)type, (unsigned char)enemyType, bullet, enemy, position };
+}
+
+static void ResolveCollisions(Simulation *sim) {
+    CollisionScratch *col = &sim->collision;
+    int enemies = sim->enemyPool.count;
+
+    // Counting sort of the claimed bullets by enemy. Filling from the last
+    // bullet backwards leaves every enemy's bullets in ascending order.
+    memset(col->hitStart, 0, (size_t)(enemies + 1) * sizeof(int));
+    for (int j = 0; j < sim->bulletPool.count; j++) {
+        if (col->bulletOwner[j] != HIT_NONE) col->hitStart[col->bulletOwner[j] & HIT_INDEX_MASK]++;
+    }
+    for (int i = 1; i <= enemies; i++) col->hitStart[i] += col->hitStart[i - 1];
+    for (int j = sim->bulletPool.count - 1; j >= 0; j--) {
+        if (col->bulletOwner[j] != HIT_NONE) col->hitList[--col->hitStart[col->bulletOwner[j] & HIT_INDEX_MASK]] = j;
+    }
+
+    // Still plain index order, one type bucket after the other. Nothing is
+    // changed here: how many hits an enemy takes and whether the player can
+    // still be hurt are counted locally.
+    const Player *player = &sim->player;
+    bool playerHurt = !player->active || player->damage_timer > 0;
+    for (int t = 0; t < ENEMY_TYPE_COUNT; t++) {
+        for (int i = sim->enemyBucket[t]; i < sim->enemyBucket[t + 1]; i++) {
+            const Enemy *e = &sim->enemies[i];
+            for (int k = col->hitStart[i]; k < col->hitStart[i + 1]; k++) {
+                int j = col->hitList[k];
+                EmitEvent(sim, SIM_EVENT_BULLET_HIT, t, j, i, sim->bullets[j].position);
+                // Bullets after the deadly one are still used up, but score nothing
+                if (k - col->hitStart[i] + 1 == e->health)
+                    EmitEvent(sim, SIM_EVENT_ENEMY_KILLED, t, j, i, e->position);
+            }
+            if (col->touchesPlayer[i] && !playerHurt) {
+                playerHurt = true;      // 1 second of invincibility starts now
+                EmitEvent(sim, SIM_EVENT_PLAYER_DAMAGED, t, -1, i, player->position);
+                if (player->health <= 1)
+                    EmitEvent(sim, SIM_EVENT_PLAYER_DIED, t, -1, i, player->position);
+            }
+        }
+    }
+}
+
+// =====================================================================
+// LESSON 17: GAMEPLAY EVENTS
+// =====================================================================
+// Collisions don't change the game themselves. They add small records to
+// sim->events ("bullet 12 hit enemy 3", "enemy 3 was killed") and a
+// separate step applies them, in the order they were written: damage,
+// score, kills and particles. Detection stays read-only, however many
+// threads run it, and everything else that cares about what happened
+// (sound, statistics, achievements) reads the same list after SimStep
+// instead of adding code to the collision loop.
+
+static void ApplyEvents(Simulation *sim) {
+    SimEventQueue *q = &sim->events;
+    if (q->count > q->capacity) q->count = q->capacity;
+    Player *player = &sim->player;
+
+    for (int n = 0; n < q->count; n++) {
+        const SimEvent *ev = &q->items[n];
+        const EnemyArchetype *arch = &enemyArchetypes[ev->enemyType];
+
+        switch (ev->type) {
+        case SIM_EVENT_BULLET_HIT: {
+            Enemy *e = &sim->enemies[ev->enemy];
+            BitSet(sim->collision.deadBullets, ev->bullet);
+            // Took damage but didn't die — light grey sparks
+            if (--e->health > 0) SimSpawnParticles(sim, ev->position, (Color){ 200, 200, 200, 255 }, 4);
+        } break;
+        case SIM_EVENT_ENEMY_KILLED:
+            BitSet(sim->collision.deadEnemies, ev->enemy);
+            // Explosion effect — unique colors per enemy type
+            for (int k = 0; k < ENEMY_MAX_BURSTS; k++)
+                SimSpawnParticles(sim, ev->position, arch->explosion[k].color, arch->explosion[k].count);
+            player->score += arch->points;
+            break;
+        case SIM_EVENT_PLAYER_DAMAGED:
+            BitSet(sim->collision.deadEnemies, ev->enemy);
+            player->health--;
+            player->damage_timer = 1.0f; // 1 second of invincibility
+            // Player hit — blue sparks
+            SimSpawnParticles(sim, ev->position, (Color){ 0, 180, 255, 255 }, 12);
+            SimSpawnParticles(sim, ev->position, (Color){ 255, 255, 255, 255 }, 6);
+            break;
+        case SIM_EVENT_PLAYER_DIED:
+            player->active = false;
+            // Player death — big multi-color explosion
+            SimSpawnParticles(sim, ev->position, (Color){ 0, 180, 255, 255 }, 30);
+            SimSpawnParticles(sim, ev->position, (Color){ 255, 255, 255, 255 }, 20);
+            SimSpawnParticles(sim, ev->position, (Color){ 100, 220, 255, 255 }, 15);
+            break;
+        }
+    }
+}
+
+// Moving a bullet or an enemy never touches any other entity
+typedef struct {
+    Simulation *sim;
+    float       dt;
+    float       activeTop;      // Enemies outside [activeTop, activeBottom) are in reduced-rate
+    float       activeBottom;   // chunks (LESSON 19)...
+    bool        reducedTick;    // ...and only move on some ticks
+} MoveJob;
+
+static void MoveBulletsJob(void *context, int begin, int end) {
+    MoveJob *job = context;
+    for (int i = begin; i < end; i++) {
+        Bullet *b = &job->sim->bullets[i];
+        b->prev_position = b->position;
+        b->position.x += b->velocity.x * job->dt;
+        b->position.y += b->velocity.y * job->dt;
+    }
+}
+
+static void MoveEnemiesJob(void *context, int begin, int end) {
+    MoveJob *job = context;
+    for (int i = begin; i < end; i++) {
+        Enemy *e = &job->sim->enemies[i];
+        e->prev_position = e->position;
+
+        // Away from the view, one step in SIM_REDUCED_STEP covers them all
+        float dt = job->dt;
+        if (e->position.y < job->activeTop || e->position.y >= job->activeBottom) {
+            if (!job->reducedTick) continue;
+            dt *= SIM_REDUCED_STEP;
+        }
+
+        // Move downward + wavy horizontal movement
+        e->move_angle += dt * 3.0f;
+        e->position.y += e->speed * dt;
+        e->position.x += sinf(e->move_angle) * 50.0f * dt;
+    }
+}
+
+// =====================================================================
+// LESSON 9: UPDATE - Game Logic
+// =====================================================================
+// Called once per tick. Updates all objects.
+
+bool SimStep(Simulation *sim, SimInput input, float dt) {
+    Player *player = &sim->player;
+    sim->gameTime += dt;
+    player->prev_position = player->position;
+    sim->events.count = 0;
+    sim->events.dropped = 0;
+
+    // --- PLAYER MOVEMENT ---
+    PROFILE_BEGIN("Input");
+    // LESSON: The front end turns IsKeyDown() results into input.buttons
+    if (player->active) {
+        if (input.buttons & INPUT_LEFT)  player->position.x -= player->speed * dt;
+        if (input.buttons & INPUT_RIGHT) player->position.x += player->speed * dt;
+        if (input.buttons & INPUT_UP)    player->position.y -= player->speed * dt;
+        if (input.buttons & INPUT_DOWN)  player->position.y += player->speed * dt;
+
+        // World boundary clamping
+        if (player->position.x < player->size.x / 2)
+            player->position.x = player->size.x / 2;
+        if (player->position.x > SCREEN_WIDTH - player->size.x / 2)
+            player->position.x = SCREEN_WIDTH - player->size.x / 2;
+        if (player->position.y < player->size.y / 2)
+            player->position.y = player->size.y / 2;
+        if (player->position.y > sim->config.worldHeight - player->size.y / 2)
+            player->position.y = sim->config.worldHeight - player->size.y / 2;
+
+        // --- SHOOTING ---
+        // LESSON: We limit fire rate using a cooldown system
+        player->shoot_timer -= dt;
+        if ((input.buttons & INPUT_FIRE) && player->shoot_timer <= 0) {
+            // Fire double bullets
+            SimShootBullet(sim,
+                (Vector2){ player->position.x - 12, player->position.y - 20 },
+                (Vector2){ 0, -500.0f },
+                (Color){ 0, 200, 255, 255 }
+            );
+            SimShootBullet(sim,
+                (Vector2){ player->position.x + 12, player->position.y - 20 },
+                (Vector2){ 0, -500.0f },
+                (Color){ 0, 200, 255, 255 }
+            );
+            player->shoot_timer = 0.15f; // 0.15 second cooldown
+        }
+    }
+
+    // Update damage animation
+    if (player->damage_timer > 0)
+        player->damage_timer -= dt;
+    PROFILE_END();
+
+    // --- THE VIEW FOLLOWS THE PLAYER ---
+    // Chunks that came near the view get their enemies back, and the particles'
+    // origin follows along so they never run out of range
+    PROFILE_BEGIN("World");
+    UpdateWorld(sim);
+    WakeEnemies(sim);
+    if (fabsf(sim->world.viewTop - sim->particles.originY) > PARTICLE_REBASE_DISTANCE)
+        ParticlePoolRebase(&sim->particles, floorf(sim->world.viewTop));
+    PROFILE_END();
+
+    // --- UPDATE BULLETS AND ENEMIES ---
+    // Everything moves first (in parallel), then the enemies that went off screen
+    // are removed. A removed one is replaced by the last one, so the same index
+    // is looked at again. Enemies that went into a frozen chunk are put away.
+    // Bullets that left the view stay until after the collisions (see below).
+    MoveJob move = { sim, dt, 0, 0, sim->ticks % SIM_REDUCED_STEP == 0 };
+    ChunkRange(&sim->world, sim->world.activeFirst, sim->world.activeLast, &move.activeTop, &move.activeBottom);
+    sim->ticks++;
+    float viewTop = sim->world.viewTop;
+
+    PROFILE_BEGIN("Bullets");
+    JobParallelFor(sim->jobs, sim->bulletPool.count, CHUNK_BULLETS, MoveBulletsJob, &move);
+    PROFILE_END();
+
+    PROFILE_BEGIN("EnemyMove");
+    JobParallelFor(sim->jobs, sim->enemyPool.count, CHUNK_ENEMIES, MoveEnemiesJob, &move);
+    float awakeTop, awakeBottom, removeBelow = sim->config.worldHeight + 50.0f;
+    ChunkRange(&sim->world, sim->world.awakeFirst, sim->world.awakeLast, &awakeTop, &awakeBottom);
+    for (int i = 0; i < sim->enemyPool.count; ) {
+        const Enemy *e = &sim->enemies[i];
+        if (e->position.y > removeBelow) {
+            RemoveEnemy(sim, i);
+        } else if (e->position.y < awakeTop || e->position.y >= awakeBottom) {
+            FreezeEnemy(sim, e);
+            RemoveEnemy(sim, i);
+        } else {
+            i++;
+        }
+    }
+    PROFILE_END();
+
+    // --- COLLISIONS ---
+    // An enemy that just left the screen is already too far down to touch a
+    // bullet or the player, so removing those first changes nothing.
+    // Hits only set a bit in the dead bitsets; indices have to stay put until
+    // every enemy has been resolved, then the dead are swap-removed in one sweep.
+    PROFILE_BEGIN("Collision");
+    if (sim->broadphase) BuildBulletGrid(sim);
+    memset(sim->collision.deadBullets, 0, BITSET_WORDS(sim->bulletPool.count) * 4);
+    memset(sim->collision.deadEnemies, 0, BITSET_WORDS(sim->enemyPool.count) * 4);
+
+    for (int j = 0; j < sim->bulletPool.count; j++)
+        sim->collision.bulletOwner[j] = HIT_NONE;   // Nobody yet
+    JobParallelFor(sim->jobs, sim->enemyPool.count, CHUNK_COLLISIONS, DetectCollisionsJob, sim);
+    ResolveCollisions(sim);
+    ApplyEvents(sim);
+
+    // Back to front: whatever a removal moves into slot i comes from a higher
+    // index, which was already looked at and is alive, so the bits stay valid.
+    // Bullets that left the view go in the same sweep, after they were tested:
+    // one that passed through an enemy above the screen on its way out (a long
+    // tick, an enemy that just spawned) still hits it.
+    for (int i = sim->bulletPool.count - 1; i >= 0; i--) {
+        const Bullet *b = &sim->bullets[i];
+        if (BitTest(sim->collision.deadBullets, i) ||
+            b->position.y < viewTop - 10 || b->position.y > viewTop + SCREEN_HEIGHT + 10) {
+            RemoveBullet(sim, i);
+        }
+    }
+    for (int i = sim->enemyPool.count - 1; i >= 0; i--) {
+        if (BitTest(sim->collision.deadEnemies, i)) RemoveEnemy(sim, i);
+    }
+    PROFILE_END();
+
+    // --- UPDATE PARTICLES ---
+    PROFILE_BEGIN("Particles");
+    SimUpdateParticles(sim, dt);
+    PROFILE_END();
+
+    // --- ENEMY WAVE SYSTEM ---
+    PROFILE_BEGIN("Waves");
+    sim->enemyTimer += dt;
+    float spawnInterval = sim->tuning.spawnInterval / sim->difficultyMultiplier; // More frequent as difficulty increases
+    if (sim->enemyTimer >= spawnInterval) {
+        sim->enemyTimer = 0;
+        SimSpawnEnemy(sim);
+    }
+
+    // Difficulty increases every 30 seconds (with the default tuning)
+    sim->difficultyMultiplier = 1.0f + sim->gameTime / sim->tuning.difficultyPeriod;
+    sim->wave = 1 + (int)(sim->gameTime / sim->tuning.wavePeriod);
+    PROFILE_END();
+
+    return player->active;
+}
@@ -0,0 +1,454 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SIMULATION CORE
+*   ===============================
+*
+*   All of the game logic (player, bullets, enemies, particles and the wave system)
+*   lives here. Nothing in this module opens a window, polls the keyboard or
+*   asks raylib for the frame time: every tick receives an explicit SimInput and dt.
+*   That way the exact same code drives the game (main.c) and the headless benchmark
+*   (headless.c), which can run on machines without a display or GPU.
+*
+*   If raylib.h is included before this header, its Vector2/Rectangle/Color types are
+*   reused. Otherwise minimal compatible definitions are provided, the same way
+*   raymath.h and rlgl.h do it, so a headless build only needs a C compiler and libm.
+*
+********************************************************************************************/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pool.h"
+#include "arena.h"
+#include "jobs.h"
+
+#if !defined(RL_VECTOR2_TYPE)
+typedef struct Vector2 {
+    float x;
+    float y;
+} Vector2;
+#define RL_VECTOR2_TYPE
+#endif
+
+#if !defined(RL_RECTANGLE_TYPE)
+typedef struct Rectangle {
+    float x;
+    float y;
+    float width;
+    float height;
+} Rectangle;
+#define RL_RECTANGLE_TYPE
+#endif
+
+#if !defined(RL_COLOR_TYPE)
+typedef struct Color {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+} Color;
+#define RL_COLOR_TYPE
+#endif
+
+#ifndef PI
+    #define PI 3.14159265358979323846f
+#endif
+
+// =====================================================================
+// LESSON 1: CONSTANTS AND STRUCTS
+// =====================================================================
+// In raylib, we define game objects using structs.
+// Each object has a position (Vector2), size, speed, and state.
+
+#define SCREEN_WIDTH    800
+#define SCREEN_HEIGHT   600
+// Default capacities. The real ones are picked at startup (see SimConfig)
+#define DEFAULT_MAX_BULLETS     50
+#define DEFAULT_MAX_ENEMIES     20
+#define DEFAULT_MAX_STARS       100
+#define DEFAULT_MAX_PARTICLES   200
+#define DEFAULT_MAX_FROZEN_ENEMIES 256
+#define DEFAULT_WORLD_HEIGHT    SCREEN_HEIGHT   // One screen: the original game
+
+// The simulation always advances in fixed steps of 1/SIM_TICK_RATE seconds,
+// independent of how fast the screen is drawn (see main.c)
+#define SIM_TICK_RATE   60
+
+// The world is SCREEN_WIDTH wide and config.worldHeight tall, cut into rows of
+// SIM_CHUNK_HEIGHT pixels. How often a chunk is simulated depends on how far it
+// is from the part of the world on screen (the view, see SimWorld):
+#define SIM_CHUNK_HEIGHT    200
+#define SIM_ACTIVE_MARGIN   200     // Chunks this close to the view: every tick
+#define SIM_REDUCED_MARGIN  600     // This close: every SIM_REDUCED_STEP ticks. Farther: frozen
+#define SIM_REDUCED_STEP    4
+
+// Player ship
+typedef struct {
+    Vector2 position;       // x,y position on screen
+    Vector2 prev_position;  // Position at the previous tick (for interpolation)
+    Vector2 size;           // Width and height
+    float   speed;          // Movement speed (pixels/second)
+    int     health;         // Remaining health
+    int     score;          // Total score
+    float   shoot_timer;    // Last shot time (for cooldown)
+    bool    active;         // Is the player active?
+    float   damage_timer;   // For damage animation
+} Player;
+
+// Bullet. Whether it is spent lives in a bitset (see CollisionScratch) and its
+// color is an index into the palette (see SimPalette), which saves 4 bytes.
+typedef struct {
+    Vector2 position;
+    Vector2 prev_position;
+    Vector2 velocity;
+    float   radius;
+    uint8_t color;          // Palette index
+} Bullet;
+
+// Enemy, ordered widest first so there are no padding holes
+typedef struct {
+    Vector2 position;
+    Vector2 prev_position;
+    Vector2 size;
+    float   speed;
+    float   move_angle;     // For wavy movement
+    int16_t health;
+    uint8_t type;           // EnemyType
+} Enemy;
+
+// Enemy archetypes. Everything that differs between enemy types is a row in
+// enemyArchetypes[] (sim.c): a new type is a new enum value plus a new row.
+typedef enum {
+    ENEMY_NORMAL,
+    ENEMY_FAST,
+    ENEMY_STRONG,
+    ENEMY_TYPE_COUNT
+} EnemyType;
+
+typedef enum {
+    ENEMY_PART_RECT,            // size * scale, centered
+    ENEMY_PART_TRIANGLE,        // Corners v[0..2]
+    ENEMY_PART_TRIANGLE_LINES,  // Same, 1 px outline
+    ENEMY_PART_POLY             // sides, radius size.x * scale
+} EnemyPartShape;
+
+// One shape of an enemy's picture. Offsets are from the enemy's center;
+// rotation is sinf(move_angle) * wobble + move_angle * spin, in degrees.
+// All parts of an enemy turn together, by the first part's wobble and spin
+// (its frames are baked that way, see sprites.h).
+typedef struct {
+    int     shape;              // EnemyPartShape
+    int     sides;
+    float   scale;
+    float   wobble;
+    float   spin;
+    Vector2 v[3];
+    Color   color;
+} EnemyPart;
+
+typedef struct {
+    Color color;
+    int   count;
+} ParticleBurst;
+
+#define ENEMY_MAX_PARTS     4
+#define ENEMY_MAX_BURSTS    2
+
+typedef struct {
+    const char   *name;
+    int           spawnChance;      // Percent of spawns (the default, see SimTuning)
+    Vector2       size;
+    float         speed;            // Pixels/second at wave 0...
+    float         speedPerWave;     // ...plus this much per wave
+    int           health;
+    int           points;
+    ParticleBurst explosion[ENEMY_MAX_BURSTS];
+    EnemyPart     parts[ENEMY_MAX_PARTS];   // Drawn in order
+    int           partCount;
+    Color         pips;             // One dot per hit point left (alpha 0: none)
+} EnemyArchetype;
+
+extern const EnemyArchetype enemyArchetypes[ENEMY_TYPE_COUNT];
+
+// Colors used by bullets and particles. An entity stores a one byte index
+// instead of a four byte Color; SimPaletteIndex adds new colors as they come.
+#define SIM_PALETTE_SIZE    256
+
+typedef struct {
+    Color colors[SIM_PALETTE_SIZE];
+    int   count;
+} SimPalette;
+
+// Particle effects, stored as a structure of arrays: all x values together,
+// all y values together, and so on. Live particles are packed at the front
+// (see pool.h), so the update loop never skips dead slots and can process
+// 8 or 16 particles per instruction (see particles.c).
+// Every field is a small fixed-point integer: a particle is 18 bytes instead
+// of 40 as floats, and at big counts the update is bound by memory, not math.
+// A value v is stored as v * PARTICLE_*_SCALE, rounded.
+#define PARTICLE_POSITION_SCALE 16.0f   // 1/16 px, -2048 to 2047 px
+#define PARTICLE_VELOCITY_SCALE 8.0f    // 1/8 px/s, up to 4096 px/s
+#define PARTICLE_LIFETIME_SCALE 2048.0f // 1/2048 s, up to 16 s
+#define PARTICLE_RADIUS_SCALE   32.0f   // 1/32 px, up to 7.9 px
+
+// Every array holds slots.capacity entries.
+typedef struct {
+    int16_t *x;
+    int16_t *y;
+    int16_t *prev_x;                    // Position at the previous tick (for interpolation)
+    int16_t *prev_y;
+    int16_t *vx;
+    int16_t *vy;
+    int16_t *lifetime;                  // Remaining lifetime
+    int16_t *max_lifetime;
+    uint8_t *radius;
+    uint8_t *color;                     // Palette index
+    Pool     slots;                     // Live particles are [0, slots.count)
+    float    originY;                   // World y of y = 0 (whole pixels, moves with the view)
+} ParticlePool;
+
+// Particle positions only reach 2048 px from their origin; the simulation moves
+// the origin along once the view is this far from it (ParticlePoolRebase)
+#define PARTICLE_REBASE_DISTANCE 512.0f
+
+// Buttons held during a tick. The game fills this from the keyboard and mouse,
+// the headless runner fills it from a script.
+typedef enum {
+    INPUT_LEFT  = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_UP    = 1 << 2,
+    INPUT_DOWN  = 1 << 3,
+    INPUT_FIRE  = 1 << 4
+} InputButton;
+
+typedef struct {
+    unsigned int buttons;   // Combination of InputButton flags
+} SimInput;
+
+// Uniform grid over the view that bullets are sorted into each tick,
+// so an enemy only tests the bullets in the cells it overlaps (see sim.c)
+#define GRID_CELL_SIZE  32
+#define GRID_COLS       ((SCREEN_WIDTH + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_ROWS       ((SCREEN_HEIGHT + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_CELLS      (GRID_COLS * GRID_ROWS)
+
+typedef struct {
+    int     cellStart[GRID_CELLS + 1];  // Bullets of cell c are items[cellStart[c] .. cellStart[c + 1])
+    int     cellFill[GRID_CELLS];       // Write cursor used while building
+    int    *items;                      // Bullet indices, ascending inside each cell
+    float   top;                        // World y of the top row (the view's top)
+    float   maxRadius;                  // Largest radius of a bullet in the grid
+    Vector2 maxTravel;                  // Longest move of one of them this step, per axis
+} BulletGrid;
+
+// Collisions run in phases (see sim.c). Detection looks at every enemy in
+// parallel and only writes down what touches what; resolution then turns that
+// into events one enemy at a time, in index order, and only applying the events
+// changes the game. Applying marks the spent bullets and dead enemies in two
+// bitsets (bit i of word i / 32) and a last sweep removes them.
+typedef struct {
+    int           *bulletOwner;     // Per bullet: the enemy it hits first, with the time (see sim.c)
+    int           *hitStart;        // Enemy i is hit by hitList[hitStart[i] .. hitStart[i + 1])
+    int           *hitList;         // Bullet indices, ascending for each enemy
+    unsigned char *touchesPlayer;   // Per enemy
+    uint32_t      *deadBullets;     // Bitsets, cleared every step
+    uint32_t      *deadEnemies;
+} CollisionScratch;
+
+// What gameplay events happened in a tick. Collisions only emit these; applying
+// them (score, damage, explosions) is a separate step, and anything else that
+// wants to know what happened (sounds, statistics) reads the same list.
+typedef enum {
+    SIM_EVENT_BULLET_HIT,           // bullet hit enemy
+    SIM_EVENT_ENEMY_KILLED,         // enemy destroyed by a bullet, enemyType says what it was
+    SIM_EVENT_PLAYER_DAMAGED,       // enemy rammed the player
+    SIM_EVENT_PLAYER_DIED,          // right after the PLAYER_DAMAGED that did it
+    SIM_EVENT_TYPE_COUNT
+} SimEventType;
+
+typedef struct {
+    unsigned char type;             // SimEventType
+    unsigned char enemyType;
+    int           bullet;           // Index, or -1
+    int           enemy;            // Index, or -1
+    Vector2       position;         // Where the effect goes
+} SimEvent;
+
+// The events of the last SimStep: items[0 .. count), in a fixed order. Slots
+// are claimed with an atomic add, so any job can emit without a lock. The
+// capacity covers every event a tick can produce (at most one hit per bullet
+// and one kill per enemy), dropped only counts a broken promise.
+typedef struct {
+    SimEvent *items;
+    int       capacity;
+    int       count;
+    int       dropped;
+} SimEventQueue;
+
+// The difficulty curve. SimCreate starts from SimDefaultTuning() and SimInit
+// keeps whatever is set, so a batch of games can try other numbers (batch.c)
+typedef struct {
+    float spawnInterval;                    // Seconds between enemies at difficulty 1...
+    float difficultyPeriod;                 // ...which grows by 1 every this many seconds
+    float wavePeriod;                       // Seconds per wave (enemies get faster every wave)
+    int   spawnChance[ENEMY_TYPE_COUNT];    // Percent of spawns per type
+} SimTuning;
+
+// Entity capacities, chosen at startup: from a config file or command line
+// flags (config.c), or straight from code in the benchmarks
+typedef struct {
+    int maxBullets;
+    int maxEnemies;
+    int maxStars;                   // Background density only: stars have no simulation state (starfield.h)
+    int maxParticles;
+    int maxFrozenEnemies;           // Enemies kept in chunks far from the view (see SimWorld)
+    int worldHeight;                // Pixels, at least SCREEN_HEIGHT
+} SimConfig;
+
+// Where the view is and which chunks run at what rate (recomputed every SimStep
+// from the player's position). Chunk c covers world y
+// [(c - 1) * SIM_CHUNK_HEIGHT, c * SIM_CHUNK_HEIGHT): chunk 0 is the strip above
+// the world where enemies spawn, the last one the strip below it.
+//
+//   active  [activeFirst, activeLast]   full rate, like the original game
+//   awake   [awakeFirst, awakeLast]     the active ones plus a ring at reduced rate
+//   frozen  everything else             enemies wait in sim->frozen, untouched
+//
+// A world of one screen is active everywhere, so it plays exactly like before.
+typedef struct {
+    float viewTop;                  // World y of the screen's top edge
+    int   chunkCount;
+    int   activeFirst, activeLast;
+    int   awakeFirst, awakeLast;
+} SimWorld;
+
+// The complete simulation state. Several of these can live side by side,
+// nothing in sim.c keeps hidden globals.
+// Bullets and enemies are packed at the front of their arrays by their pools:
+// bullets[0 .. bulletPool.count) are all live. All arrays live in one arena.
+// Enemies are also grouped by type: enemies of type t are
+// enemies[enemyBucket[t] .. enemyBucket[t + 1]), so per-type loops need no
+// branches (enemyBucket[ENEMY_TYPE_COUNT] is always enemyPool.count).
+typedef struct {
+    SimConfig    config;
+    Arena        arena;             // The one allocation behind every array below
+    Player       player;
+    Bullet      *bullets;
+    Pool         bulletPool;
+    Enemy       *enemies;
+    Pool         enemyPool;
+    int          enemyBucket[ENEMY_TYPE_COUNT + 1];
+    Enemy       *frozen;            // Enemies in frozen chunks, grouped by chunk:
+    Pool         frozenPool;        // chunk c has frozen[frozenStart[c] .. frozenStart[c + 1])
+    int         *frozenStart;       // chunkCount + 1 entries
+    SimWorld     world;
+    unsigned int ticks;             // Steps this game (reduced-rate chunks move on every SIM_REDUCED_STEP-th)
+    ParticlePool particles;
+    SimPalette   palette;           // Bullet and particle colors, filled as they are used
+    float        gameTime;
+    float        enemyTimer;
+    int          wave;              // Enemy wave number
+    float        difficultyMultiplier;
+    unsigned int rngState;          // Private random generator (see SimRandomInt)
+    unsigned int particleRng;       // Particles only, so their number never changes the game
+    float        particleScale;     // Multiplies particle bursts (quality.h); 1 by default, kept by SimInit
+    SimTuning    tuning;            // Difficulty curve, kept by SimInit
+    bool         broadphase;        // Use bulletGrid (true) or test every bullet (false)
+    BulletGrid   bulletGrid;
+    CollisionScratch collision;
+    SimEventQueue events;           // This tick's gameplay events (rebuilt every SimStep)
+    JobSystem   *jobs;              // Threads for the big loops (NULL: run everything on this thread)
+} Simulation;
+
+// =====================================================================
+// SIMULATION API
+// =====================================================================
+
+// The game's defaults (the DEFAULT_MAX_* values)
+SimConfig SimDefaultConfig(void);
+
+// The game's difficulty curve
+SimTuning SimDefaultTuning(void);
+
+// Bytes of arena memory a simulation with these capacities needs
+size_t SimArenaSize(const SimConfig *config);
+
+// Allocate the arena for these capacities: one malloc for all entity arrays.
+// Call once, then SimInit for every game. Returns false if out of memory.
+bool SimCreate(Simulation *sim, const SimConfig *config);
+void SimDestroy(Simulation *sim);
+
+// Reset everything for a new game (the palette too). The same seed always produces the same game.
+// Pools are emptied and the arena is reset in O(1): no per-entity work at all.
+// The grid broadphase is on by default; turning it off gives identical results.
+// sim->jobs is kept: the results never depend on how many threads there are.
+void SimInit(Simulation *sim, unsigned int seed);
+
+// Copy the state of src into dst, which must have been created with the same
+// config: player, live entities, the pools' counters, palette, timers, the world
+// and this tick's events. Only live entities are copied, so it costs what is
+// near the view; frozen enemies are far from it and stay behind.
+// Used to hand finished ticks to another thread (see sim_thread.h); dst->jobs
+// is left alone.
+void SimCopyState(Simulation *dst, const Simulation *src);
+
+// Advance the game by dt seconds (normally 1/SIM_TICK_RATE) using the buttons
+// held in input. Every entity's prev_position is set to where it was before
+// the step, so a renderer can blend between the two. Enemies in reduced-rate
+// chunks only move every SIM_REDUCED_STEP ticks (by that many ticks' worth),
+// frozen ones not at all.
+// Returns false once the player has died (the game is over). What happened
+// during the step is in sim->events until the next one.
+bool SimStep(Simulation *sim, SimInput input, float dt);
+
+// Cosmetic update, also used by the game over screen
+void SimUpdateParticles(Simulation *sim, float dt);
+
+// The palette index of color, added if it is new. A full palette gives the
+// nearest color it has.
+int  SimPaletteIndex(Simulation *sim, Color color);
+
+// Spawning
+void SimSpawnParticles(Simulation *sim, Vector2 position, Color color, int count);
+void SimShootBullet(Simulation *sim, Vector2 position, Vector2 velocity, Color color);
+// Enemies: a random type at a random place above the view, or a given type at a
+// given place. Both return the new enemy's index (-1 if the pool is full, or if the
+// place is in a frozen chunk: the enemy then waits in sim->frozen); keeping the
+// types grouped may move other enemies to new indices.
+int  SimSpawnEnemy(Simulation *sim);
+int  SimSpawnEnemyType(Simulation *sim, EnemyType type, Vector2 position);
+
+// The world (see SimWorld). SimViewTop is where the view is with the player at
+// playerY (a renderer passes the blended position); SimChunkOf is the chunk of world y.
+float SimViewTop(const Simulation *sim, float playerY);
+int   SimChunkOf(const Simulation *sim, float y);
+int   SimChunkCount(const SimConfig *config);
+
+// Particle pool kernels (particles.c). Integrate moves every live particle,
+// applies drag and returns how many expired; RemoveExpired then packs the
+// survivors back together. IntegrateRange does the same for [begin, end) only.
+// Carve lets a pool take its arrays from an arena (ParticlePoolArenaSize bytes).
+// Rebase moves the origin to originY (whole pixels), shifting every particle
+// so it stays where it is in the world.
+size_t ParticlePoolArenaSize(int capacity);
+bool ParticlePoolCarve(ParticlePool *pool, Arena *arena, int capacity);
+int  ParticlePoolIntegrate(ParticlePool *pool, float dt, float drag);
+int  ParticlePoolIntegrateRange(ParticlePool *pool, int begin, int end, float dt, float drag);
+void ParticlePoolRemoveExpired(ParticlePool *pool);
+void ParticlePoolRebase(ParticlePool *pool, float originY);
+void ParticlePoolCopy(ParticlePool *dst, const ParticlePool *src);     // Live particles, same capacity
+const char *ParticleKernelName(void);   // "avx2", "sse2" or "scalar"
+
+// Hash of the gameplay state (player, bullets, enemies, frozen ones included,
+// timers and the random generator; particles are cosmetic and left out). Two runs that agree on it are in the same state;
+// replays (replay.h) use it to find the tick where two runs went apart.
+unsigned int SimChecksum(const Simulation *sim);
+
+// Deterministic random numbers (same contract as raylib's GetRandomValue)
+int   SimRandomInt(Simulation *sim, int min, int max);
+float SimRandomFloat(Simulation *sim, float min, float max);
+
+#endif // SIM_H
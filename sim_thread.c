@@ -0,0 +1,182 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SIMULATION THREAD
+*
+*   Triple buffer, input queue, jitter statistics and the fixed-rate thread
+*   (see sim_thread.h).
+*
+********************************************************************************************/
+
+#include "sim_thread.h"
+#include "profiler.h"
+#include "timer.h"
+#include <math.h>
+
+// =====================================================================
+// TRIPLE BUFFER
+// =====================================================================
+// Publishing swaps the writer's slot into the middle and takes the old middle
+// back; reading swaps the reader's slot into the middle if the middle is newer.
+// Both are a single exchange, so there is never a moment where two sides own
+// the same slot.
+
+void TripleBufferInit(TripleBuffer *buffer) {
+    buffer->front = 0;
+    atomic_init(&buffer->middle, 1);
+    buffer->back = 2;
+}
+
+int TripleBufferWriteSlot(const TripleBuffer *buffer) {
+    return buffer->back;
+}
+
+void TripleBufferPublish(TripleBuffer *buffer) {
+    int old = atomic_exchange_explicit(&buffer->middle, buffer->back | TRIPLE_BUFFER_FRESH, memory_order_acq_rel);
+    buffer->back = old & ~TRIPLE_BUFFER_FRESH;
+}
+
+int TripleBufferReadSlot(TripleBuffer *buffer) {
+    if (atomic_load_explicit(&buffer->middle, memory_order_relaxed) & TRIPLE_BUFFER_FRESH) {
+        int old = atomic_exchange_explicit(&buffer->middle, buffer->front, memory_order_acq_rel);
+        buffer->front = old & ~TRIPLE_BUFFER_FRESH;
+    }
+    return buffer->front;
+}
+
+// =====================================================================
+// INPUT QUEUE
+// =====================================================================
+// head and tail only ever grow (wrapping at 2^32); the slot is index % size.
+// Each side publishes its index with a release store after it is done with
+// the slot, and reads the other side's with an acquire load.
+
+void InputQueueInit(InputQueue *queue) {
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    queue->dropped = 0;
+}
+
+bool InputQueuePush(InputQueue *queue, InputMessage message) {
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail - head == INPUT_QUEUE_SIZE) {
+        queue->dropped++;
+        return false;
+    }
+    queue->items[tail % INPUT_QUEUE_SIZE] = message;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool InputQueuePop(InputQueue *queue, InputMessage *message) {
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head == tail) return false;
+    *message = queue->items[head % INPUT_QUEUE_SIZE];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+// =====================================================================
+// JITTER
+// =====================================================================
+
+static JitterStats MakeStats(double sum, double squares, double worst, long count) {
+    JitterStats stats = { 0, 0, 0, count };
+    if (count == 0) return stats;
+    double mean = sum / count;
+    double variance = squares / count - mean * mean;
+    stats.mean = mean * 1000.0;
+    stats.stddev = variance > 0 ? sqrt(variance) * 1000.0 : 0.0;
+    stats.worst = worst * 1000.0;
+    return stats;
+}
+
+void JitterInit(JitterTracker *tracker, double expected) {
+    *tracker = (JitterTracker){ 0 };
+    tracker->expected = expected;
+    tracker->last = -1.0;
+}
+
+void JitterRecord(JitterTracker *tracker, double now) {
+    double last = tracker->last;
+    tracker->last = now;
+    if (last < 0) return;
+
+    double interval = now - last;
+    double off = fabs(interval - tracker->expected);
+    tracker->sum += interval;
+    tracker->sumSquares += interval * interval;
+    if (off > tracker->worst) tracker->worst = off;
+    tracker->totalSum += interval;
+    tracker->totalSquares += interval * interval;
+    if (off > tracker->totalWorst) tracker->totalWorst = off;
+    tracker->totalCount++;
+
+    if (++tracker->count == JITTER_WINDOW) {
+        tracker->window = MakeStats(tracker->sum, tracker->sumSquares, tracker->worst, tracker->count);
+        tracker->sum = tracker->sumSquares = tracker->worst = 0;
+        tracker->count = 0;
+    }
+}
+
+JitterStats JitterTotal(const JitterTracker *tracker) {
+    return MakeStats(tracker->totalSum, tracker->totalSquares, tracker->totalWorst, tracker->totalCount);
+}
+
+// =====================================================================
+// THREAD
+// =====================================================================
+
+double SimThreadNow(void) {
+    return TimerNow();
+}
+
+double SimThreadNextTick(const SimThread *thread) {
+    return atomic_load_explicit(&thread->nextTick, memory_order_relaxed);
+}
+
+static void *SimThreadMain(void *arg) {
+    SimThread *thread = arg;
+    PROFILE_THREAD("Simulation");   // Its zones show up on a row of their own
+
+    double next = TimerNow();
+    while (atomic_load_explicit(&thread->running, memory_order_acquire)) {
+        atomic_store_explicit(&thread->nextTick, next, memory_order_relaxed);
+        double now = TimerNow();
+        if (now < next) {
+            TimerSleepUntil(next);
+            now = TimerNow();
+        }
+        // After a long hitch, slow down instead of spiralling
+        if (now - next > SIM_THREAD_MAX_LAG) {
+            next = now;
+            atomic_store_explicit(&thread->nextTick, next, memory_order_relaxed);
+            thread->catchUps++;
+        }
+        JitterRecord(&thread->jitter, now);
+        thread->tick(thread->context);
+        next += thread->dt;
+    }
+    return NULL;
+}
+
+bool SimThreadStart(SimThread *thread, double dt, SimThreadFunc tick, void *context) {
+    thread->dt = dt;
+    thread->tick = tick;
+    thread->context = context;
+    thread->catchUps = 0;
+    JitterInit(&thread->jitter, dt);
+    atomic_init(&thread->nextTick, TimerNow());
+    atomic_init(&thread->running, true);
+    if (pthread_create(&thread->handle, NULL, SimThreadMain, thread) != 0) {
+        atomic_store(&thread->running, false);
+        return false;
+    }
+    return true;
+}
+
+void SimThreadStop(SimThread *thread) {
+    if (!atomic_exchange(&thread->running, false)) return;
+    pthread_join(thread->handle, NULL);
+}
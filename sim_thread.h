@@ -0,0 +1,150 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SIMULATION THREAD
+*
+*   Runs the fixed-rate simulation on a thread of its own, so a slow frame (vsync,
+*   SetTargetFPS sleeping, a driver hiccup) no longer holds up the game's ticks,
+*   and a slow tick no longer holds up drawing. The two threads never wait for
+*   each other and never take a lock; three small pieces connect them:
+*
+*     - TripleBuffer: three copies of the drawable state. The simulation fills
+*       one and swaps it with the "middle" copy in one atomic exchange; the
+*       renderer swaps its copy for the middle one whenever there is a newer
+*       one. Each side always owns a copy the other can't touch, so the
+*       renderer draws the latest finished tick without ever blocking it.
+*     - InputQueue: a single-producer single-consumer ring. The main thread
+*       samples the keyboard once per frame and pushes a message; the
+*       simulation drains the queue before every tick.
+*     - JitterTracker: how evenly something happens (ticks on one side, frames
+*       on the other), so the decoupling can be seen working.
+*
+*   What goes into a copy, and what a tick does with the input, is up to the game
+*   (see main.c). Pure C with POSIX threads and C11 atomics, no raylib.
+*
+********************************************************************************************/
+
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include "sim.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// =====================================================================
+// TRIPLE BUFFER
+// =====================================================================
+// Only the slot indices live here (0, 1 or 2); the caller keeps three copies
+// of whatever it hands over.
+
+typedef struct {
+    atomic_int middle;      // Slot index, | TRIPLE_BUFFER_FRESH while the reader hasn't taken it
+    int        back;        // The writer's slot
+    int        front;       // The reader's slot
+} TripleBuffer;
+
+#define TRIPLE_BUFFER_FRESH 4
+
+// Reader starts on slot 0, the writer on 2; fill all three before the first read
+void TripleBufferInit(TripleBuffer *buffer);
+
+// Writer: the slot to fill next, then hand it over
+int  TripleBufferWriteSlot(const TripleBuffer *buffer);
+void TripleBufferPublish(TripleBuffer *buffer);
+
+// Reader: the newest published slot. It stays the reader's until the next call.
+int  TripleBufferReadSlot(TripleBuffer *buffer);
+
+// =====================================================================
+// INPUT QUEUE
+// =====================================================================
+
+#define INPUT_QUEUE_SIZE    64      // Messages; a power of two
+
+typedef struct {
+    SimInput     input;             // Buttons held, for SimStep
+    double       sampled;           // When they were read (SimThreadNow)
+    unsigned int commands;          // Keys the game handles itself (main.c)
+    float        particleScale;     // The quality level's burst size (quality.h)
+} InputMessage;
+
+typedef struct {
+    InputMessage items[INPUT_QUEUE_SIZE];
+    atomic_uint  head;              // Next message to read (consumer only writes it)
+    atomic_uint  tail;              // Next slot to write (producer only writes it)
+    long         dropped;           // Pushes that found the queue full (producer side)
+} InputQueue;
+
+void InputQueueInit(InputQueue *queue);
+
+// Producer: false (and the message is dropped) if the consumer is 64 messages behind
+bool InputQueuePush(InputQueue *queue, InputMessage message);
+
+// Consumer: false if there is nothing new
+bool InputQueuePop(InputQueue *queue, InputMessage *message);
+
+// =====================================================================
+// JITTER
+// =====================================================================
+// Record the time of every tick (or frame) and get how far apart they were.
+// Statistics come per window of JITTER_WINDOW samples and for the whole run.
+
+#define JITTER_WINDOW   120
+
+typedef struct {
+    double mean;            // Average interval (ms)
+    double stddev;          // Spread of the intervals (ms): the jitter
+    double worst;           // Largest distance from the expected interval (ms)
+    long   samples;
+} JitterStats;
+
+typedef struct {
+    double      expected;   // Seconds between samples when all is well
+    double      last;       // Time of the previous sample (< 0: none yet)
+    double      sum, sumSquares, worst;             // Current window
+    int         count;
+    double      totalSum, totalSquares, totalWorst; // Whole run
+    long        totalCount;
+    JitterStats window;     // The last complete window
+} JitterTracker;
+
+void        JitterInit(JitterTracker *tracker, double expected);
+void        JitterRecord(JitterTracker *tracker, double now);
+JitterStats JitterTotal(const JitterTracker *tracker);
+
+// =====================================================================
+// THREAD
+// =====================================================================
+
+typedef void (*SimThreadFunc)(void *context);
+
+typedef struct {
+    pthread_t     handle;
+    atomic_bool   running;
+    _Atomic double nextTick;        // When the coming tick starts (SimThreadNextTick)
+    double        dt;               // Seconds per tick
+    SimThreadFunc tick;
+    void         *context;
+    JitterTracker jitter;           // Tick starts; only the simulation thread touches it while running
+    long          catchUps;         // Times it fell so far behind it skipped ahead
+} SimThread;
+
+// Call tick(context) every dt seconds on a new thread, until SimThreadStop.
+// Ticks that fall behind run back to back to catch up (like the frame
+// accumulator did), up to SIM_THREAD_MAX_LAG behind. Returns false if the
+// thread couldn't be started.
+#define SIM_THREAD_MAX_LAG  0.25
+
+bool SimThreadStart(SimThread *thread, double dt, SimThreadFunc tick, void *context);
+
+// Let the current tick finish and wait for the thread to end
+void SimThreadStop(SimThread *thread);
+
+// When the next tick will start (SimThreadNow time). Read from any thread;
+// input pushed before then is in that tick.
+double SimThreadNextTick(const SimThread *thread);
+
+// The clock the thread runs on (seconds, monotonic), for code that can't
+// include timer.h next to raylib.h
+double SimThreadNow(void);
+
+#endif // SIM_THREAD_H
@@ -0,0 +1,536 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - STATE SNAPSHOTS AND REWIND
+*
+*   Capturing, rewinding and saving states (see snapshot.h).
+*
+********************************************************************************************/
+
+#include "snapshot.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define SNAPSHOT_SSE2
+#endif
+
+#define BLOCK_WORDS     32      // Words per change mask
+#define SAVE_MAGIC      "SSST"
+
+// Entities are captured as whole 32-bit words
+_Static_assert(sizeof(Bullet) % 4 == 0, "Bullet must be a whole number of words");
+_Static_assert(sizeof(Enemy) % 4 == 0, "Enemy must be a whole number of words");
+_Static_assert(sizeof(SnapshotState) % 4 == 0, "SnapshotState must be a whole number of words");
+
+#define WORDS(bytes)    ((size_t)(bytes) / 4)
+#define WORDS_UP(bytes) (((size_t)(bytes) + 3) / 4)
+
+// =====================================================================
+// SECTIONS
+// =====================================================================
+
+// Bytes per particle in a particle section. A section's last word may run past
+// the live particles; the arena rounds every array up to ARENA_ALIGNMENT, so
+// it always stays inside the array.
+static size_t ParticleFieldSize(int section) {
+    return section >= SNAPSHOT_PARTICLE_RADIUS ? sizeof(uint8_t) : sizeof(int16_t);
+}
+
+// Words a section needs at full capacity
+static size_t SectionCapacity(const SimConfig *config, int section) {
+    switch (section) {
+        case SNAPSHOT_STATE:   return WORDS(sizeof(SnapshotState));
+        case SNAPSHOT_BULLETS: return WORDS(sizeof(Bullet)) * (size_t)config->maxBullets;
+        case SNAPSHOT_ENEMIES: return WORDS(sizeof(Enemy)) * (size_t)config->maxEnemies;
+        case SNAPSHOT_FROZEN:  return WORDS(sizeof(Enemy)) * (size_t)config->maxFrozenEnemies;
+        case SNAPSHOT_FROZEN_STARTS: return (size_t)SimChunkCount(config) + 1;
+        default:               return WORDS_UP(ParticleFieldSize(section) * (size_t)config->maxParticles);
+    }
+}
+
+// Words of the whole image: every section at full capacity
+static size_t ImageWords(const SnapshotRing *ring) {
+    return ring->sectionOffset[SNAPSHOT_SECTIONS - 1] + SectionCapacity(&ring->config, SNAPSHOT_SECTIONS - 1);
+}
+
+// The live part of each particle array, in SnapshotSection order
+static void *ParticleArray(const ParticlePool *pool, int section) {
+    switch (section) {
+        case SNAPSHOT_PARTICLE_X:            return pool->x;
+        case SNAPSHOT_PARTICLE_Y:            return pool->y;
+        case SNAPSHOT_PARTICLE_VX:           return pool->vx;
+        case SNAPSHOT_PARTICLE_VY:           return pool->vy;
+        case SNAPSHOT_PARTICLE_LIFETIME:     return pool->lifetime;
+        case SNAPSHOT_PARTICLE_MAX_LIFETIME: return pool->max_lifetime;
+        case SNAPSHOT_PARTICLE_RADIUS:       return pool->radius;
+        default:                             return pool->color;
+    }
+}
+
+// Where section's current data lives in sim, and how many words of it there are
+static const uint32_t *SectionSource(SnapshotRing *ring, const Simulation *sim, int section, size_t *words) {
+    switch (section) {
+        case SNAPSHOT_STATE: {
+            SnapshotState *state = &ring->state;
+            memset(state, 0, sizeof(*state));   // Keep the padding from showing up as changes
+            state->player = sim->player;
+            state->gameTime = sim->gameTime;
+            state->enemyTimer = sim->enemyTimer;
+            state->wave = sim->wave;
+            state->difficultyMultiplier = sim->difficultyMultiplier;
+            state->rngState = sim->rngState;
+            state->particleRng = sim->particleRng;
+            state->palette = sim->palette;
+            memcpy(state->enemyBucket, sim->enemyBucket, sizeof(state->enemyBucket));
+            state->world = sim->world;
+            state->ticks = sim->ticks;
+            state->particleOrigin = sim->particles.originY;
+            state->bullets = sim->bulletPool.count;
+            state->enemies = sim->enemyPool.count;
+            state->frozen = sim->frozenPool.count;
+            state->particles = sim->particles.slots.count;
+            *words = WORDS(sizeof(*state));
+            return (const uint32_t *)state;
+        }
+        case SNAPSHOT_BULLETS:
+            *words = WORDS(sizeof(Bullet)) * (size_t)sim->bulletPool.count;
+            return (const uint32_t *)sim->bullets;
+        case SNAPSHOT_ENEMIES:
+            *words = WORDS(sizeof(Enemy)) * (size_t)sim->enemyPool.count;
+            return (const uint32_t *)sim->enemies;
+        case SNAPSHOT_FROZEN:
+            *words = WORDS(sizeof(Enemy)) * (size_t)sim->frozenPool.count;
+            return (const uint32_t *)sim->frozen;
+        case SNAPSHOT_FROZEN_STARTS:
+            *words = (size_t)sim->world.chunkCount + 1;
+            return (const uint32_t *)sim->frozenStart;
+        default:
+            *words = WORDS_UP(ParticleFieldSize(section) * (size_t)sim->particles.slots.count);
+            return ParticleArray(&sim->particles, section);
+    }
+}
+
+// Copy the image back into sim
+static void RestoreImage(const SnapshotRing *ring, Simulation *sim) {
+    const uint32_t *image = ring->image;
+    SnapshotState state;
+    memcpy(&state, image + ring->sectionOffset[SNAPSHOT_STATE], sizeof(state));
+    sim->player = state.player;
+    sim->gameTime = state.gameTime;
+    sim->enemyTimer = state.enemyTimer;
+    sim->wave = state.wave;
+    sim->difficultyMultiplier = state.difficultyMultiplier;
+    sim->rngState = state.rngState;
+    sim->particleRng = state.particleRng;
+    sim->palette = state.palette;
+    memcpy(sim->enemyBucket, state.enemyBucket, sizeof(sim->enemyBucket));
+    sim->world = state.world;
+    sim->ticks = state.ticks;
+    sim->particles.originY = state.particleOrigin;
+    sim->bulletPool.count = state.bullets;
+    sim->enemyPool.count = state.enemies;
+    sim->frozenPool.count = state.frozen;
+    sim->particles.slots.count = state.particles;
+
+    memcpy(sim->bullets, image + ring->sectionOffset[SNAPSHOT_BULLETS], ring->sectionWords[SNAPSHOT_BULLETS] * 4);
+    memcpy(sim->enemies, image + ring->sectionOffset[SNAPSHOT_ENEMIES], ring->sectionWords[SNAPSHOT_ENEMIES] * 4);
+    memcpy(sim->frozen, image + ring->sectionOffset[SNAPSHOT_FROZEN], ring->sectionWords[SNAPSHOT_FROZEN] * 4);
+    memcpy(sim->frozenStart, image + ring->sectionOffset[SNAPSHOT_FROZEN_STARTS],
+           ring->sectionWords[SNAPSHOT_FROZEN_STARTS] * 4);
+    for (int s = SNAPSHOT_PARTICLE_X; s < SNAPSHOT_SECTIONS; s++) {
+        memcpy(ParticleArray(&sim->particles, s), image + ring->sectionOffset[s], ring->sectionWords[s] * 4);
+    }
+    // Nothing to blend from: draw the restored tick as it is
+    memcpy(sim->particles.prev_x, sim->particles.x, (size_t)state.particles * sizeof(int16_t));
+    memcpy(sim->particles.prev_y, sim->particles.y, (size_t)state.particles * sizeof(int16_t));
+    sim->events.count = 0;      // They belonged to a tick that is gone now
+}
+
+// =====================================================================
+// DELTA ENCODING
+// =====================================================================
+// A section's delta is: old length, new length, then for every block of 32 words
+// (up to the longer of the two) a mask of the words that changed followed by
+// old XOR new for each of them. Words past a section's length are 0 in the image.
+
+static size_t MaxEncodedWords(size_t prevWords, size_t curWords) {
+    size_t words = prevWords > curWords ? prevWords : curWords;
+    return 2 + words + (words + BLOCK_WORDS - 1) / BLOCK_WORDS;
+}
+
+// One whole block that lies inside cur: image[0..32) becomes cur[0..32), the
+// changes go to out. Returns the change mask; *written is how many words changed.
+static uint32_t EncodeFullBlock(const uint32_t *restrict cur, uint32_t *restrict image, uint32_t *restrict out,
+                                size_t *written) {
+    uint32_t mask = 0;
+    size_t n = 0;
+#if defined(SNAPSHOT_SSE2)
+    // 4 words at a time; a group where all 4 changed (every moving particle) is one store
+    const __m128i zero = _mm_setzero_si128();
+    for (int k = 0; k < BLOCK_WORDS; k += 4) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(cur + k));
+        __m128i x = _mm_xor_si128(c, _mm_loadu_si128((const __m128i *)(image + k)));
+        _mm_storeu_si128((__m128i *)(image + k), c);
+        _mm_storeu_si128((__m128i *)(out + n), x);
+        uint32_t changed = ~(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, zero))) & 0xF;
+        mask |= changed << k;
+        if (changed == 0xF) {
+            n += 4;
+        } else if (changed) {
+            uint32_t lanes[4];
+            memcpy(lanes, out + n, sizeof(lanes));
+            for (int j = 0; j < 4; j++) {
+                out[n] = lanes[j];
+                n += lanes[j] != 0;
+            }
+        }
+    }
+#else
+    for (int k = 0; k < BLOCK_WORDS; k++) {
+        uint32_t x = cur[k] ^ image[k];
+        out[n] = x;
+        n += x != 0;
+        mask |= (uint32_t)(x != 0) << k;
+        image[k] = cur[k];
+    }
+#endif
+    *written = n;
+    return mask;
+}
+
+// Encode cur against image (which becomes cur). Returns the words written to out.
+static size_t EncodeSection(const uint32_t *cur, size_t curWords, uint32_t *image, size_t prevWords, uint32_t *out) {
+    size_t total = prevWords > curWords ? prevWords : curWords;
+    size_t n = 0;
+    out[n++] = (uint32_t)prevWords;
+    out[n++] = (uint32_t)curWords;
+
+    for (size_t base = 0; base < total; base += BLOCK_WORDS) {
+        size_t maskAt = n++;
+        if (base + BLOCK_WORDS <= curWords) {
+            size_t written;
+            out[maskAt] = EncodeFullBlock(cur + base, image + base, out + n, &written);
+            n += written;
+            continue;
+        }
+        // The last block, or the section shrank: words past curWords become 0
+        size_t end = base + BLOCK_WORDS < total ? base + BLOCK_WORDS : total;
+        uint32_t mask = 0;
+        for (size_t w = base; w < end; w++) {
+            uint32_t c = w < curWords ? cur[w] : 0;
+            uint32_t x = c ^ image[w];
+            out[n] = x;
+            n += x != 0;
+            mask |= (uint32_t)(x != 0) << (w - base);
+            image[w] = c;
+        }
+        out[maskAt] = mask;
+    }
+    return n;
+}
+
+// Apply a section's delta to image, forwards or backwards (XOR works both ways).
+// Returns the words read from in.
+static size_t ApplySection(const uint32_t *in, uint32_t *image, size_t *words, bool backwards) {
+    size_t prevWords = in[0], curWords = in[1];
+    size_t total = prevWords > curWords ? prevWords : curWords;
+    size_t n = 2;
+    for (size_t base = 0; base < total; base += BLOCK_WORDS) {
+        uint32_t mask = in[n++];
+        for (int k = 0; mask; k++, mask >>= 1) {
+            if (mask & 1) image[base + k] ^= in[n++];
+        }
+    }
+    *words = backwards ? prevWords : curWords;
+    return n;
+}
+
+// =====================================================================
+// THE RING
+// =====================================================================
+
+static SnapshotEntry *Oldest(SnapshotRing *ring) {
+    return &ring->entries[ring->first];
+}
+
+static SnapshotEntry *Newest(SnapshotRing *ring) {
+    return &ring->entries[(ring->first + ring->count - 1) % ring->maxEntries];
+}
+
+static void DropOldest(SnapshotRing *ring) {
+    ring->first = (ring->first + 1) % ring->maxEntries;
+    ring->count--;
+}
+
+// Make `words` contiguous words free at the head, dropping the oldest snapshots
+// in the way. Returns the offset to write at.
+static size_t MakeRoom(SnapshotRing *ring, size_t words) {
+    if (ring->head + words > ring->ringWords) {
+        // Wrap around. Everything between the head and the end is older than
+        // everything before the head, so it goes first.
+        while (ring->count > 0 && Oldest(ring)->offset >= ring->head) DropOldest(ring);
+        ring->head = 0;
+    }
+    while (ring->count > 0 && Oldest(ring)->offset < ring->head + words &&
+           Oldest(ring)->offset + Oldest(ring)->words > ring->head) {
+        DropOldest(ring);
+    }
+    if (ring->count == ring->maxEntries) DropOldest(ring);
+    return ring->head;
+}
+
+bool SnapshotRingCreate(SnapshotRing *ring, const SimConfig *config, size_t ringBytes, int maxEntries) {
+    memset(ring, 0, sizeof(*ring));
+    ring->config = *config;
+    ring->maxEntries = maxEntries > 1 ? maxEntries : 2;
+
+    size_t imageWords = 0, worstCase = 0;
+    for (int s = 0; s < SNAPSHOT_SECTIONS; s++) {
+        ring->sectionOffset[s] = imageWords;
+        imageWords += SectionCapacity(config, s);
+        worstCase += MaxEncodedWords(0, SectionCapacity(config, s));
+    }
+    // Always room for at least one snapshot of a completely full simulation
+    ring->ringWords = WORDS(ringBytes) > worstCase ? WORDS(ringBytes) : worstCase;
+
+    ring->image = calloc(imageWords, sizeof(uint32_t));
+    ring->ring = malloc(ring->ringWords * sizeof(uint32_t));
+    ring->entries = malloc((size_t)ring->maxEntries * sizeof(SnapshotEntry));
+    if (!ring->image || !ring->ring || !ring->entries) {
+        SnapshotRingDestroy(ring);
+        return false;
+    }
+    return true;
+}
+
+void SnapshotRingDestroy(SnapshotRing *ring) {
+    free(ring->image);
+    free(ring->ring);
+    free(ring->entries);
+    free(ring->loaded);
+    memset(ring, 0, sizeof(*ring));
+}
+
+void SnapshotRingReset(SnapshotRing *ring) {
+    for (int s = 0; s < SNAPSHOT_SECTIONS; s++) {
+        memset(ring->image + ring->sectionOffset[s], 0, ring->sectionWords[s] * sizeof(uint32_t));
+        ring->sectionWords[s] = 0;
+    }
+    ring->head = 0;
+    ring->first = 0;
+    ring->count = 0;
+    ring->ticks = 0;
+}
+
+void SnapshotCapture(SnapshotRing *ring, const Simulation *sim) {
+    double start = TimerNow();
+
+    const uint32_t *source[SNAPSHOT_SECTIONS];
+    size_t words[SNAPSHOT_SECTIONS];
+    size_t bound = 0, raw = 0;
+    for (int s = 0; s < SNAPSHOT_SECTIONS; s++) {
+        source[s] = SectionSource(ring, sim, s, &words[s]);
+        bound += MaxEncodedWords(ring->sectionWords[s], words[s]);
+        raw += words[s];
+    }
+
+    size_t offset = MakeRoom(ring, bound);
+    uint32_t *out = ring->ring + offset;
+    size_t n = 0;
+    for (int s = 0; s < SNAPSHOT_SECTIONS; s++) {
+        n += EncodeSection(source[s], words[s], ring->image + ring->sectionOffset[s], ring->sectionWords[s], out + n);
+        ring->sectionWords[s] = words[s];
+    }
+
+    ring->entries[(ring->first + ring->count) % ring->maxEntries] = (SnapshotEntry){ offset, n, ring->ticks };
+    ring->count++;
+    ring->ticks++;
+    ring->head = offset + n;
+
+    ring->last.bytes = n * sizeof(uint32_t);
+    ring->last.rawBytes = raw * sizeof(uint32_t);
+    ring->last.micros = (TimerNow() - start) * 1e6;
+}
+
+// The oldest snapshot stays: its delta leads back to a state the ring no longer has
+int SnapshotHistory(const SnapshotRing *ring) {
+    return ring->count > 0 ? ring->count - 1 : 0;
+}
+
+int SnapshotRewind(SnapshotRing *ring, Simulation *sim, int ticks) {
+    if (ring->count == 0) return 0;
+    if (ticks > SnapshotHistory(ring)) ticks = SnapshotHistory(ring);
+    if (ticks < 0) ticks = 0;
+
+    for (int t = 0; t < ticks; t++) {
+        SnapshotEntry *entry = Newest(ring);
+        const uint32_t *in = ring->ring + entry->offset;
+        for (int s = 0; s < SNAPSHOT_SECTIONS; s++) {
+            in += ApplySection(in, ring->image + ring->sectionOffset[s], &ring->sectionWords[s], true);
+        }
+        ring->head = entry->offset;
+        ring->count--;
+        ring->ticks--;
+    }
+    RestoreImage(ring, sim);
+    return ticks;
+}
+
+// =====================================================================
+// SAVE STATES
+// =====================================================================
+// Magic, capacities and struct sizes (a save only loads into the same build
+// layout), then every section as its length in words and the words, in the
+// machine's byte order.
+
+bool SnapshotSave(const SnapshotRing *ring, const char *path) {
+    if (ring->count == 0) return false;
+    FILE *file = fopen(path, "wb");
+    if (!file) return false;
+
+    uint32_t layout[] = { (uint32_t)sizeof(Bullet), (uint32_t)sizeof(Enemy), (uint32_t)sizeof(SnapshotState) };
+    bool ok = fwrite(SAVE_MAGIC, 1, 4, file) == 4 &&
+              fwrite(&ring->config, sizeof(ring->config), 1, file) == 1 &&
+              fwrite(layout, sizeof(layout), 1, file) == 1;
+    for (int s = 0; ok && s < SNAPSHOT_SECTIONS; s++) {
+        uint32_t words = (uint32_t)ring->sectionWords[s];
+        ok = fwrite(&words, sizeof(words), 1, file) == 1 &&
+             fwrite(ring->image + ring->sectionOffset[s], sizeof(uint32_t), words, file) == words;
+    }
+    if (fclose(file) != 0) ok = false;
+    return ok;
+}
+
+// Bucket starts as sim keeps them: from 0, never going down, ending at total
+static bool StartsValid(const int *start, int n, int total) {
+    if (start[0] != 0 || start[n] != total) return false;
+    for (int i = 0; i < n; i++) {
+        if (start[i + 1] < start[i]) return false;
+    }
+    return true;
+}
+
+// Whether image (laid out like ring->image, lengths in words) is a state this
+// build can run: every count, index and bucket start the simulation trusts
+// without checking again. A save file is only as good as whoever wrote it.
+static bool ImageValid(const SnapshotRing *ring, const uint32_t *image, const size_t *words) {
+    const SimConfig *config = &ring->config;
+    if (words[SNAPSHOT_STATE] != WORDS(sizeof(SnapshotState))) return false;
+    SnapshotState state;
+    memcpy(&state, image + ring->sectionOffset[SNAPSHOT_STATE], sizeof(state));
+
+    // The pool counts must fit the pools and agree with the section lengths
+    int chunks = SimChunkCount(config);
+    if (state.bullets < 0 || state.bullets > config->maxBullets ||
+        state.enemies < 0 || state.enemies > config->maxEnemies ||
+        state.frozen < 0 || state.frozen > config->maxFrozenEnemies ||
+        state.particles < 0 || state.particles > config->maxParticles ||
+        words[SNAPSHOT_BULLETS] != WORDS(sizeof(Bullet)) * (size_t)state.bullets ||
+        words[SNAPSHOT_ENEMIES] != WORDS(sizeof(Enemy)) * (size_t)state.enemies ||
+        words[SNAPSHOT_FROZEN] != WORDS(sizeof(Enemy)) * (size_t)state.frozen ||
+        words[SNAPSHOT_FROZEN_STARTS] != (size_t)chunks + 1) {
+        return false;
+    }
+    for (int s = SNAPSHOT_PARTICLE_X; s < SNAPSHOT_SECTIONS; s++) {
+        if (words[s] != WORDS_UP(ParticleFieldSize(s) * (size_t)state.particles)) return false;
+    }
+
+    // The world's chunk ranges, nested and inside the world
+    const SimWorld *world = &state.world;
+    if (world->chunkCount != chunks || world->awakeFirst < 0 || world->awakeFirst > world->activeFirst ||
+        world->activeFirst > world->activeLast || world->activeLast > world->awakeLast ||
+        world->awakeLast >= chunks) {
+        return false;
+    }
+
+    // Live enemies sorted into their type's bucket, frozen ones into their chunk's
+    if (!StartsValid(state.enemyBucket, ENEMY_TYPE_COUNT, state.enemies)) return false;
+    const Enemy *enemies = (const Enemy *)(image + ring->sectionOffset[SNAPSHOT_ENEMIES]);
+    for (int t = 0; t < ENEMY_TYPE_COUNT; t++) {
+        for (int i = state.enemyBucket[t]; i < state.enemyBucket[t + 1]; i++) {
+            if (enemies[i].type != t) return false;
+        }
+    }
+    const int *frozenStart = (const int *)(image + ring->sectionOffset[SNAPSHOT_FROZEN_STARTS]);
+    if (!StartsValid(frozenStart, chunks, state.frozen)) return false;
+    const Enemy *frozen = (const Enemy *)(image + ring->sectionOffset[SNAPSHOT_FROZEN]);
+    for (int i = 0; i < state.frozen; i++) {
+        if (frozen[i].type >= ENEMY_TYPE_COUNT) return false;
+    }
+
+    // A bool that is neither 0 nor 1 is undefined to read
+    unsigned char active;
+    memcpy(&active, &state.player.active, 1);
+    if (active > 1) return false;
+
+    // Colors are palette indices
+    if (state.palette.count < 0 || state.palette.count > SIM_PALETTE_SIZE) return false;
+    const Bullet *bullets = (const Bullet *)(image + ring->sectionOffset[SNAPSHOT_BULLETS]);
+    for (int i = 0; i < state.bullets; i++) {
+        if (bullets[i].color >= state.palette.count) return false;
+    }
+    const uint8_t *colors = (const uint8_t *)(image + ring->sectionOffset[SNAPSHOT_PARTICLE_COLOR]);
+    for (int i = 0; i < state.particles; i++) {
+        if (colors[i] >= state.palette.count) return false;
+    }
+    return true;
+}
+
+bool SnapshotRead(SnapshotRing *ring, const char *path) {
+    free(ring->loaded);
+    ring->loaded = NULL;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+
+    char magic[4];
+    SimConfig config;
+    uint32_t layout[3];
+    uint32_t expected[] = { (uint32_t)sizeof(Bullet), (uint32_t)sizeof(Enemy), (uint32_t)sizeof(SnapshotState) };
+    bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, SAVE_MAGIC, 4) == 0 &&
+              fread(&config, sizeof(config), 1, file) == 1 &&
+              memcmp(&config, &ring->config, sizeof(config)) == 0 &&
+              fread(layout, sizeof(layout), 1, file) == 1 &&
+              memcmp(layout, expected, sizeof(layout)) == 0;
+
+    // Read into scratch first: a file that turns out bad leaves the history alone
+    size_t imageWords = ImageWords(ring);
+    uint32_t *image = ok ? calloc(imageWords, sizeof(uint32_t)) : NULL;
+    size_t words[SNAPSHOT_SECTIONS];
+    ok = ok && image;
+    for (int s = 0; ok && s < SNAPSHOT_SECTIONS; s++) {
+        uint32_t n;
+        ok = fread(&n, sizeof(n), 1, file) == 1 && n <= SectionCapacity(&config, s) &&
+             fread(image + ring->sectionOffset[s], sizeof(uint32_t), n, file) == n;
+        words[s] = n;
+    }
+    fclose(file);
+    ok = ok && ImageValid(ring, image, words);
+
+    if (!ok) {
+        free(image);
+        return false;
+    }
+    ring->loaded = image;
+    memcpy(ring->loadedWords, words, sizeof(words));
+    return true;
+}
+
+bool SnapshotApply(SnapshotRing *ring, Simulation *sim) {
+    if (!ring->loaded) return false;
+    SnapshotRingReset(ring);
+    memcpy(ring->image, ring->loaded, ImageWords(ring) * sizeof(uint32_t));
+    memcpy(ring->sectionWords, ring->loadedWords, sizeof(ring->loadedWords));
+    free(ring->loaded);
+    ring->loaded = NULL;
+    RestoreImage(ring, sim);
+    SnapshotCapture(ring, sim);     // The loaded state is the new start of the history
+    return true;
+}
+
+bool SnapshotLoad(SnapshotRing *ring, Simulation *sim, const char *path) {
+    return SnapshotRead(ring, path) && SnapshotApply(ring, sim);
+}
@@ -0,0 +1,142 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - STATE SNAPSHOTS AND REWIND
+*
+*   Captures the complete game state every tick, cheaply enough to leave on while
+*   playing, and keeps the most recent snapshots in a fixed-size ring so the game
+*   can go back in time (rewind) or be saved and loaded (save states).
+*
+*   How it stays cheap:
+*
+*     - Only live entities are captured: bullets[0 .. count), enemies[0 .. count),
+*       frozen enemies[0 .. count) and the particle arrays up to slots.count (see
+*       pool.h). A snapshot of an empty field is a few hundred bytes whatever the
+*       capacities (plus one word per chunk of the world).
+*     - The ring keeps the last captured state as one image. A new snapshot is
+*       only the 32-bit words that changed since then: per block of 32 words, a
+*       mask of the changed ones followed by (old XOR new) for each of them.
+*     - Because XOR undoes itself, the same delta takes the image one tick back
+*       as well as forward: rewinding walks from the latest image backwards, with
+*       no periodic full snapshots to keep around.
+*
+*   Not captured: prev_x / prev_y of particles (every step overwrites them before
+*   using them; a restore sets them to the current position), the collision
+*   scratch, grid and events (rebuilt every tick) and the job system.
+*
+*   The ring's memory is allocated once. When it is full the oldest snapshots are
+*   dropped. Pure C, no raylib.
+*
+********************************************************************************************/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "sim.h"
+#include <stdint.h>
+
+#define SNAPSHOT_DEFAULT_BYTES      (16 * 1024 * 1024)
+#define SNAPSHOT_DEFAULT_ENTRIES    (10 * SIM_TICK_RATE)    // 10 seconds of rewind
+
+// The parts of the state image, in order
+typedef enum {
+    SNAPSHOT_STATE,             // Player, timers, wave, random generators, palette, pool counts
+    SNAPSHOT_BULLETS,
+    SNAPSHOT_ENEMIES,
+    SNAPSHOT_FROZEN,            // Enemies in frozen chunks...
+    SNAPSHOT_FROZEN_STARTS,     // ...and where each chunk starts among them (sim->frozenStart)
+    SNAPSHOT_PARTICLE_X,
+    SNAPSHOT_PARTICLE_Y,
+    SNAPSHOT_PARTICLE_VX,
+    SNAPSHOT_PARTICLE_VY,
+    SNAPSHOT_PARTICLE_LIFETIME,
+    SNAPSHOT_PARTICLE_MAX_LIFETIME,
+    SNAPSHOT_PARTICLE_RADIUS,
+    SNAPSHOT_PARTICLE_COLOR,
+    SNAPSHOT_SECTIONS
+} SnapshotSection;
+
+// Everything in a Simulation that isn't an entity array
+typedef struct {
+    Player       player;
+    float        gameTime;
+    float        enemyTimer;
+    int          wave;
+    float        difficultyMultiplier;
+    unsigned int rngState;
+    unsigned int particleRng;
+    SimPalette   palette;
+    int          enemyBucket[ENEMY_TYPE_COUNT + 1];
+    SimWorld     world;
+    unsigned int ticks;
+    float        particleOrigin;
+    int          bullets;               // Pool counts
+    int          enemies;
+    int          frozen;
+    int          particles;
+} SnapshotState;
+
+typedef struct {
+    size_t offset;          // In words, into ring
+    size_t words;
+    long   tick;            // Capture number
+} SnapshotEntry;
+
+typedef struct {
+    size_t bytes;           // Encoded delta
+    size_t rawBytes;        // The full state it stands for
+    double micros;          // Time SnapshotCapture took
+} SnapshotStats;
+
+typedef struct {
+    SimConfig      config;
+    SnapshotState  state;                               // Scratch for SNAPSHOT_STATE
+    uint32_t      *image;                               // The last captured state
+    size_t         sectionOffset[SNAPSHOT_SECTIONS];    // Where each section starts in image
+    size_t         sectionWords[SNAPSHOT_SECTIONS];     // How much of it is in use
+    uint32_t      *ring;                                // Encoded deltas, oldest first (wrapping)
+    size_t         ringWords;
+    size_t         head;                                // Where the next delta goes
+    SnapshotEntry *entries;                             // Circular, entries[first] is the oldest
+    int            maxEntries;
+    int            first;
+    int            count;
+    long           ticks;                               // Snapshots captured so far
+    SnapshotStats  last;
+    uint32_t      *loaded;                              // A save state read but not applied yet
+    size_t         loadedWords[SNAPSHOT_SECTIONS];
+} SnapshotRing;
+
+// Allocate a ring for simulations with this config: about ringBytes of deltas and
+// at most maxEntries snapshots. The ring is made big enough for at least one
+// snapshot at full capacity. Returns false if out of memory.
+bool SnapshotRingCreate(SnapshotRing *ring, const SimConfig *config, size_t ringBytes, int maxEntries);
+void SnapshotRingDestroy(SnapshotRing *ring);
+
+// Forget every snapshot (e.g. for a new game): O(1) apart from clearing the image
+void SnapshotRingReset(SnapshotRing *ring);
+
+// Add the current state of sim (normally right after SimStep). Stats in ring->last.
+void SnapshotCapture(SnapshotRing *ring, const Simulation *sim);
+
+// How many snapshots back SnapshotRewind can go
+int SnapshotHistory(const SnapshotRing *ring);
+
+// Put sim back into the state of `ticks` snapshots before the latest one (0: the
+// latest itself) and forget the newer ones. Returns how far it actually went.
+int SnapshotRewind(SnapshotRing *ring, Simulation *sim, int ticks);
+
+// Save states: the last captured state as a file, and back. Loading needs the same
+// capacities and clears the rewind history; a file that fails its checks (a bad
+// count, index or bucket) is refused and leaves sim and the history untouched.
+// Both return false on errors.
+bool SnapshotSave(const SnapshotRing *ring, const char *path);
+bool SnapshotLoad(SnapshotRing *ring, Simulation *sim, const char *path);
+
+// SnapshotLoad in two steps, for a caller that still needs the old state once the
+// file is known to be good (main.c ends the replay on it): SnapshotRead checks the
+// file and keeps it aside, SnapshotApply puts it into sim. Nothing else changes in
+// between; SnapshotApply returns false if no file was read.
+bool SnapshotRead(SnapshotRing *ring, const char *path);
+bool SnapshotApply(SnapshotRing *ring, Simulation *sim);
+
+#endif // SNAPSHOT_H
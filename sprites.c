@@ -0,0 +1,242 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SPRITE ATLAS
+*
+*   The ship and enemy shapes, the atlas layout and frame picking (see sprites.h).
+*
+********************************************************************************************/
+
+#include "sprites.h"
+#include <math.h>
+
+#define SPRITE_SCRATCH      64      // Commands in one frame, for measuring
+
+// =====================================================================
+// SHAPES
+// =====================================================================
+
+// The player ship (ship shape made of triangles)
+void SpritePushPlayerShapes(RenderQueue *queue, Vector2 pos, float flame) {
+    float x = pos.x;
+    float y = pos.y;
+
+    // Ship body (triangle)
+    RenderPushTriangle(queue,
+        (Vector2){ x, y - 22 },          // Top tip (nose)
+        (Vector2){ x - 18, y + 15 },     // Bottom left
+        (Vector2){ x + 18, y + 15 },     // Bottom right
+        (Color){ 50, 150, 255, 255 }
+    );
+
+    // Inner detail
+    RenderPushTriangle(queue,
+        (Vector2){ x, y - 14 },
+        (Vector2){ x - 10, y + 8 },
+        (Vector2){ x + 10, y + 8 },
+        (Color){ 100, 200, 255, 255 }
+    );
+
+    // Wings
+    RenderPushTriangle(queue,
+        (Vector2){ x - 18, y + 15 },
+        (Vector2){ x - 28, y + 22 },
+        (Vector2){ x - 8, y + 10 },
+        (Color){ 30, 100, 200, 255 }
+    );
+    RenderPushTriangle(queue,
+        (Vector2){ x + 18, y + 15 },
+        (Vector2){ x + 28, y + 22 },
+        (Vector2){ x + 8, y + 10 },
+        (Color){ 30, 100, 200, 255 }
+    );
+
+    // Engine flame
+    RenderPushTriangle(queue,
+        (Vector2){ x - 6, y + 15 },
+        (Vector2){ x, y + 28 + flame },
+        (Vector2){ x + 6, y + 15 },
+        (Color){ 255, 150, 0, 200 }
+    );
+    RenderPushTriangle(queue,
+        (Vector2){ x - 3, y + 15 },
+        (Vector2){ x, y + 22 + flame },
+        (Vector2){ x + 3, y + 15 },
+        (Color){ 253, 249, 0, 255 }     // raylib YELLOW
+    );
+}
+
+// Enemy, drawn from its archetype's list of parts (see enemyArchetypes in sim.c)
+void SpritePushEnemyShapes(RenderQueue *queue, const EnemyArchetype *arch, Vector2 pos, float rotation, int health) {
+    for (int p = 0; p < arch->partCount; p++) {
+        const EnemyPart *part = &arch->parts[p];
+        Vector2 v0 = { pos.x + part->v[0].x, pos.y + part->v[0].y };
+        Vector2 v1 = { pos.x + part->v[1].x, pos.y + part->v[1].y };
+        Vector2 v2 = { pos.x + part->v[2].x, pos.y + part->v[2].y };
+
+        switch (part->shape) {
+            case ENEMY_PART_RECT:
+                RenderPushRect(queue, pos, (Vector2){ arch->size.x * part->scale, arch->size.y * part->scale },
+                               rotation, part->color);
+                break;
+            case ENEMY_PART_TRIANGLE:
+                RenderPushTriangle(queue, v0, v1, v2, part->color);
+                break;
+            case ENEMY_PART_TRIANGLE_LINES:
+                RenderPushTriangleLines(queue, v0, v1, v2, part->color);
+                break;
+            case ENEMY_PART_POLY:
+                RenderPushPoly(queue, pos, part->sides, arch->size.x * part->scale, rotation, part->color);
+                break;
+        }
+    }
+
+    // Health indicator (whole pixels, like DrawCircle)
+    if (arch->pips.a == 0) return;
+    for (int c = 0; c < health; c++) {
+        Vector2 pip = { (float)(int)(pos.x - 8 + c * 8), (float)(int)(pos.y - arch->size.y / 2 - 8) };
+        RenderPushCircle(queue, pip, 3, arch->pips);
+    }
+}
+
+// =====================================================================
+// LAYOUT
+// =====================================================================
+
+// Degrees after which a part looks the same again (0: it never turns)
+static float PartPeriod(const EnemyPart *part, Vector2 size) {
+    switch (part->shape) {
+        case ENEMY_PART_RECT: return size.x == size.y ? 90.0f : 180.0f;
+        case ENEMY_PART_POLY: return 360.0f / part->sides;
+    }
+    return 0.0f;        // Triangles are drawn at fixed offsets
+}
+
+// How an enemy type turns: all parts together, by the first part's wobble and spin
+static void EnemyKind(SpriteKind *kind, const EnemyArchetype *arch) {
+    const EnemyPart *first = &arch->parts[0];
+    float period = 0.0f;
+    for (int p = 0; p < arch->partCount; p++) {
+        float q = PartPeriod(&arch->parts[p], arch->size);
+        if (q == 0.0f || period == q) continue;
+        if (period == 0.0f || fmodf(q, period) == 0.0f) period = q;
+        else if (fmodf(period, q) != 0.0f) period = 360.0f;
+    }
+    bool turns = period > 0.0f && (first->wobble != 0.0f || first->spin != 0.0f);
+    kind->rotations = turns ? SPRITE_ROTATION_FRAMES : 1;
+    kind->period = turns ? period : 360.0f;
+    kind->variants = arch->pips.a != 0 ? arch->health : 1;
+}
+
+int SpriteFrameKind(const SpriteAtlas *atlas, int frame) {
+    for (int k = SPRITE_KIND_COUNT - 1; k > 0; k--)
+        if (frame >= atlas->kinds[k].first) return k;
+    return 0;
+}
+
+void SpritePushShapes(RenderQueue *queue, const SpriteAtlas *atlas, int frame, Vector2 center) {
+    int k = SpriteFrameKind(atlas, frame);
+    const SpriteKind *kind = &atlas->kinds[k];
+    int index = frame - kind->first;
+    int rotation = index % kind->rotations, variant = index / kind->rotations;
+
+    if (k == SPRITE_PLAYER) {
+        float flame = sinf(2.0f * PI * variant / SPRITE_FLAME_FRAMES) * SPRITE_FLAME_HEIGHT;
+        SpritePushPlayerShapes(queue, center, flame);
+    } else {
+        SpritePushEnemyShapes(queue, &enemyArchetypes[k], center, rotation * kind->period / kind->rotations,
+                              variant + 1);
+    }
+}
+
+// Half the frame's extent, from the shapes of all its frames at the origin
+static void MeasureKind(SpriteAtlas *atlas, int k) {
+    static RenderCommand commands[SPRITE_SCRATCH];
+    static int order[SPRITE_SCRATCH];
+    Vector2 vertices[RENDER_MAX_SHAPE_VERTICES];
+    RenderQueue queue;
+    RenderQueueInit(&queue, commands, order, SPRITE_SCRATCH);
+
+    SpriteKind *kind = &atlas->kinds[k];
+    float maxX = 0.0f, maxY = 0.0f;
+    for (int f = 0; f < kind->rotations * kind->variants; f++) {
+        RenderQueueBegin(&queue);
+        SpritePushShapes(&queue, atlas, kind->first + f, (Vector2){ 0, 0 });
+        for (int c = 0; c < queue.count; c++) {
+            int n = RenderCommandTessellate(&queue.commands[c], vertices);
+            for (int i = 0; i < n; i++) {
+                if (fabsf(vertices[i].x) > maxX) maxX = fabsf(vertices[i].x);
+                if (fabsf(vertices[i].y) > maxY) maxY = fabsf(vertices[i].y);
+            }
+        }
+    }
+    // Even sizes keep the center on a whole pixel
+    kind->width = 2 * ((int)ceilf(maxX) + 1);
+    kind->height = 2 * ((int)ceilf(maxY) + 1);
+}
+
+bool SpriteAtlasBuild(SpriteAtlas *atlas) {
+    // Frames per kind
+    int frames = 0;
+    for (int k = 0; k < SPRITE_KIND_COUNT; k++) {
+        SpriteKind *kind = &atlas->kinds[k];
+        if (k == SPRITE_PLAYER) *kind = (SpriteKind){ .rotations = 1, .period = 360.0f, .variants = SPRITE_FLAME_FRAMES };
+        else EnemyKind(kind, &enemyArchetypes[k]);
+        kind->first = frames;
+        frames += kind->rotations * kind->variants;
+    }
+    if (frames > SPRITE_MAX_FRAMES) return false;
+    atlas->frameCount = frames;
+
+    // Shelves: left to right, a new row when one is full. The white square goes first.
+    atlas->width = SPRITE_ATLAS_WIDTH;
+    atlas->whiteX = atlas->whiteY = 0;
+    int x = 2 + SPRITE_PADDING, y = 0, shelf = 2;
+    for (int k = 0; k < SPRITE_KIND_COUNT; k++) {
+        MeasureKind(atlas, k);
+        const SpriteKind *kind = &atlas->kinds[k];
+        for (int f = kind->first; f < kind->first + kind->rotations * kind->variants; f++) {
+            if (x + kind->width > atlas->width) {
+                x = 0;
+                y += shelf + SPRITE_PADDING;
+                shelf = 0;
+            }
+            atlas->frames[f] = (SpriteFrame){ (short)x, (short)y };
+            x += kind->width + SPRITE_PADDING;
+            if (kind->height > shelf) shelf = kind->height;
+        }
+    }
+    atlas->height = y + shelf;
+    return atlas->height <= SPRITE_ATLAS_MAX_HEIGHT;
+}
+
+// =====================================================================
+// PICKING FRAMES
+// =====================================================================
+
+int SpriteEnemyFrame(const SpriteAtlas *atlas, const Enemy *e) {
+    const SpriteKind *kind = &atlas->kinds[e->type];
+    const EnemyPart *first = &enemyArchetypes[e->type].parts[0];
+    int rotation = 0;
+    if (kind->rotations > 1) {
+        float degrees = sinf(e->move_angle) * first->wobble + e->move_angle * first->spin;
+        rotation = (int)floorf(degrees / kind->period * kind->rotations + 0.5f) % kind->rotations;
+        if (rotation < 0) rotation += kind->rotations;
+    }
+    int variant = e->health - 1;
+    if (variant < 0) variant = 0;
+    if (variant >= kind->variants) variant = kind->variants - 1;
+    return kind->first + variant * kind->rotations + rotation;
+}
+
+int SpritePlayerFrame(const SpriteAtlas *atlas, double time) {
+    double turns = time * SPRITE_FLAME_SPEED / (2.0 * PI);
+    long step = (long)floor(turns * SPRITE_FLAME_FRAMES);
+    return atlas->kinds[SPRITE_PLAYER].first + (int)(step % SPRITE_FLAME_FRAMES);
+}
+
+void SpritePush(RenderQueue *queue, const SpriteAtlas *atlas, int frame, Vector2 center) {
+    const SpriteKind *kind = &atlas->kinds[SpriteFrameKind(atlas, frame)];
+    SpriteFrame source = atlas->frames[frame];
+    RenderPushSprite(queue, center, (Vector2){ source.x, source.y },
+                     (Vector2){ (float)kind->width, (float)kind->height });
+}
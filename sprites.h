@@ -0,0 +1,95 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - SPRITE ATLAS
+*
+*   The player ship and every enemy type are made of a handful of triangles,
+*   rectangles and polygons (plus health dots). Instead of building those shapes
+*   again for every entity every frame, each look an entity can have is drawn once
+*   at startup into one texture, the atlas, and every entity becomes one textured
+*   quad cut out of it:
+*
+*     - enemies that turn (the square wobbles, the hexagon spins) get
+*       SPRITE_ROTATION_FRAMES pre-rotated frames over one turn of their symmetry
+*       (90 degrees for the square, 60 for the hexagon),
+*     - enemies with health dots get that set of frames once per health value,
+*     - the player gets SPRITE_FLAME_FRAMES frames of its engine flame.
+*
+*   Because it is one texture, thousands of enemies are still one draw call. The
+*   atlas also has a small white square, so the plain shapes (bullets, particles)
+*   can use the same texture and stay in the same draw call.
+*
+*   This file only lays the atlas out and picks frames; it never calls raylib, so
+*   the headless build can build sprite frames too. The pixels are drawn by
+*   RenderAtlasLoad (render_gl.c), from the shapes SpritePushShapes gives it.
+*
+********************************************************************************************/
+
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include "sim.h"
+#include "render_queue.h"
+
+#define SPRITE_ROTATION_FRAMES  32      // Frames per turn through a shape's symmetry
+#define SPRITE_FLAME_FRAMES     8       // Steps of the player's engine flame
+#define SPRITE_FLAME_HEIGHT     5.0f    // Pixels the flame grows and shrinks
+#define SPRITE_FLAME_SPEED      20.0f   // Radians per second of its sine
+#define SPRITE_MAX_FRAMES       256
+#define SPRITE_ATLAS_WIDTH      1024
+#define SPRITE_ATLAS_MAX_HEIGHT 4096
+#define SPRITE_PADDING          1       // Empty pixels between frames
+
+// What gets a row of frames: one kind per enemy type, then the player
+typedef enum {
+    SPRITE_PLAYER = ENEMY_TYPE_COUNT,
+    SPRITE_KIND_COUNT
+} SpriteKindId;
+
+typedef struct {
+    int   first;                // Its first frame in SpriteAtlas.frames
+    int   rotations;            // Frames per turn (1: it never turns)
+    float period;               // Degrees of one turn (it looks the same after that)
+    int   variants;             // Health values (enemies) or flame steps (player)
+    int   width, height;        // Frame size in pixels; the entity is at the center
+} SpriteKind;
+
+// Top left corner of a frame in the atlas
+typedef struct {
+    short x, y;
+} SpriteFrame;
+
+typedef struct {
+    SpriteKind  kinds[SPRITE_KIND_COUNT];
+    SpriteFrame frames[SPRITE_MAX_FRAMES];
+    int         frameCount;
+    int         width, height;  // Texture size
+    int         whiteX, whiteY; // A 2x2 white square for plain shapes
+} SpriteAtlas;
+
+// Lay out every frame. False if they don't fit (SPRITE_MAX_FRAMES or the height).
+bool SpriteAtlasBuild(SpriteAtlas *atlas);
+
+// Which frame to draw
+int SpriteEnemyFrame(const SpriteAtlas *atlas, const Enemy *e);
+int SpritePlayerFrame(const SpriteAtlas *atlas, double time);
+
+// The kind (enemy type or SPRITE_PLAYER) a frame belongs to
+int SpriteFrameKind(const SpriteAtlas *atlas, int frame);
+
+// Push a sprite frame as one quad, centered at center
+void SpritePush(RenderQueue *queue, const SpriteAtlas *atlas, int frame, Vector2 center);
+
+// The shapes that make up a frame, centered at center (what the atlas is baked from)
+void SpritePushShapes(RenderQueue *queue, const SpriteAtlas *atlas, int frame, Vector2 center);
+
+// The same shapes, built for one entity straight from its state (no atlas)
+void SpritePushPlayerShapes(RenderQueue *queue, Vector2 pos, float flame);
+void SpritePushEnemyShapes(RenderQueue *queue, const EnemyArchetype *arch, Vector2 pos, float rotation, int health);
+
+// Draw every frame into a texture (render_gl.c, needs raylib and an open window).
+// From then on RenderQueueSubmit draws every batch with it: sprites cut out of it,
+// plain shapes from its white square. False if the texture couldn't be created.
+bool RenderAtlasLoad(const SpriteAtlas *atlas);
+void RenderAtlasUnload(void);
+
+#endif // SPRITES_H
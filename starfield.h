@@ -0,0 +1,89 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - ANALYTIC STAR FIELD
+*
+*   The background stars have no state to update. Star i is a pure function of the
+*   field's seed and i: a hash picks its place, size and brightness, and i picks one
+*   of STARFIELD_LAYERS parallax layers. All stars in a layer scroll down at the
+*   layer's speed, so where a star is at any moment follows from one number, how far
+*   the field has scrolled:
+*
+*     y = (start y + scroll * layer speed) mod SCREEN_HEIGHT
+*
+*   That is why the game can draw each layer from a texture baked once (background.c)
+*   and just move it: a handful of quads whatever the number of stars. Pure C, no
+*   raylib calls.
+*
+********************************************************************************************/
+
+#ifndef STARFIELD_H
+#define STARFIELD_H
+
+#include "sim.h"        // Vector2, SCREEN_WIDTH / SCREEN_HEIGHT
+#include <math.h>
+
+#define STARFIELD_LAYERS    4
+#define STARFIELD_SEED      0x5EED57A2u     // Any seed gives a different sky
+
+typedef struct {
+    Vector2 position;       // At scroll 0
+    float   size;           // Radius in pixels
+    float   brightness;     // 0..1
+    int     layer;          // 0 is the farthest (slowest, dimmest)
+} StarfieldStar;
+
+// Integer hash (lowbias32): every bit of the input affects every bit of the output
+static inline unsigned int StarfieldHash(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Uniform in [0, 1), the k-th number for star i
+static inline float StarfieldRandom(unsigned int seed, int i, unsigned int k) {
+    return (float)(StarfieldHash(seed ^ StarfieldHash((unsigned int)i * 4u + k)) >> 8) / 16777216.0f;
+}
+
+// Far layers move slowly, near ones quickly: 20 to 150 pixels/second
+static inline float StarfieldLayerSpeed(int layer) {
+    return 20.0f + 130.0f * (float)layer / (STARFIELD_LAYERS - 1);
+}
+
+static inline StarfieldStar StarfieldGetStar(unsigned int seed, int i) {
+    StarfieldStar star;
+    star.layer = i % STARFIELD_LAYERS;
+    float depth = (float)(star.layer + 1) / STARFIELD_LAYERS;     // Nearer layers are brighter
+    star.position.x = StarfieldRandom(seed, i, 0) * SCREEN_WIDTH;
+    star.position.y = StarfieldRandom(seed, i, 1) * SCREEN_HEIGHT;
+    star.size = 1.0f + 2.0f * StarfieldRandom(seed, i, 2) * depth;
+    star.brightness = 0.3f + 0.7f * StarfieldRandom(seed, i, 3) * (0.4f + 0.6f * depth);
+    return star;
+}
+
+// How far (in pixels, 0..SCREEN_HEIGHT) a layer has moved after scrolling for `scroll` seconds
+static inline float StarfieldLayerOffset(int layer, double scroll) {
+    double offset = fmod(scroll * StarfieldLayerSpeed(layer), (double)SCREEN_HEIGHT);
+    return (float)(offset < 0 ? offset + SCREEN_HEIGHT : offset);
+}
+
+// Scroll that also follows a camera whose view starts at world y viewTop: every
+// pixel the camera climbs moves a layer by its speed / STARFIELD_PARALLAX pixels,
+// so near stars slide by faster than far ones (LESSON 19 in sim.c)
+#define STARFIELD_PARALLAX 300.0f
+
+static inline double StarfieldCameraScroll(double scroll, float viewTop) {
+    return scroll - viewTop / STARFIELD_PARALLAX;
+}
+
+// Where star i is after scrolling for `scroll` seconds
+static inline Vector2 StarfieldPosition(unsigned int seed, int i, double scroll) {
+    StarfieldStar star = StarfieldGetStar(seed, i);
+    float y = star.position.y + StarfieldLayerOffset(star.layer, scroll);
+    if (y >= SCREEN_HEIGHT) y -= SCREEN_HEIGHT;
+    return (Vector2){ star.position.x, y };
+}
+
+#endif // STARFIELD_H
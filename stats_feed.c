@@ -0,0 +1,179 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - POOL STATISTICS FEED
+*
+*   Counting ticks and the shared memory ring (see stats_feed.h).
+*
+********************************************************************************************/
+
+#include "stats_feed.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#define STATS_READ_TRIES    4       // StatsFeedLatest: records to try while the writer laps us
+
+const char *const statsPoolNames[STATS_POOL_COUNT] = { "bullets", "enemies", "particles", "frozen" };
+
+// =====================================================================
+// COUNTING
+// =====================================================================
+
+void StatsCounterInit(StatsCounter *counter) {
+    memset(counter, 0, sizeof(*counter));
+}
+
+void StatsCounterTick(StatsCounter *counter, const Simulation *sim, uint32_t game, double time) {
+    const Pool *pools[STATS_POOL_COUNT] = { &sim->bulletPool, &sim->enemyPool, &sim->particles.slots,
+                                            &sim->frozenPool };
+    StatsRecord *record = &counter->record;
+
+    // A new game: what the last tick counted is final for the old one
+    bool newGame = record->tick > 0 && game != record->game;
+    for (int p = 0; p < STATS_POOL_COUNT; p++) {
+        StatsPool *stats = &record->pools[p];
+        if (newGame) {
+            counter->attempts[p] = stats->attempts;
+            counter->dropped[p] = stats->dropped;
+        }
+        stats->live = pools[p]->count;
+        stats->capacity = pools[p]->capacity;
+        if (pools[p]->peak > stats->peak) stats->peak = pools[p]->peak;
+        stats->attempts = counter->attempts[p] + pools[p]->attempts;
+        stats->dropped = counter->dropped[p] + pools[p]->dropped;
+    }
+
+    record->tick++;
+    record->time = time;
+    record->game = game;
+    record->events = sim->events.count;
+    for (int t = 0; t < ENEMY_TYPE_COUNT; t++)
+        record->enemies[t] = sim->enemyBucket[t + 1] - sim->enemyBucket[t];
+}
+
+// =====================================================================
+// SHARED MEMORY
+// =====================================================================
+
+static bool MapShared(StatsFeed *feed, const char *name, bool writer) {
+    size_t size = sizeof(StatsFeedShared);
+#if defined(_WIN32)
+    HANDLE mapping = writer
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, name)
+        : OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (!mapping) return false;
+    void *memory = MapViewOfFile(mapping, writer ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+    if (!memory) {
+        CloseHandle(mapping);
+        return false;
+    }
+    feed->handle = mapping;
+#else
+    int fd = writer ? shm_open(name, O_CREAT | O_RDWR, 0644) : shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+    if (writer && ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    void *memory = mmap(NULL, size, writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);      // The mapping keeps the memory
+    if (memory == MAP_FAILED) {
+        if (writer) shm_unlink(name);
+        return false;
+    }
+    feed->handle = NULL;
+#endif
+    feed->shared = memory;
+    feed->writer = writer;
+    snprintf(feed->name, sizeof(feed->name), "%s", name);
+    return true;
+}
+
+bool StatsFeedCreate(StatsFeed *feed, const char *name) {
+    *feed = (StatsFeed){ 0 };
+    if (!MapShared(feed, name, true)) return false;
+
+    // Readers check the header first: a zero magic means "not ready yet"
+    StatsFeedShared *shared = feed->shared;
+    shared->magic = 0;
+    atomic_store_explicit(&shared->head, 0, memory_order_relaxed);
+    for (int s = 0; s < STATS_FEED_RECORDS; s++)
+        atomic_store_explicit(&shared->ring[s].sequence, 0, memory_order_relaxed);
+    shared->version = STATS_FEED_VERSION;
+    shared->recordSize = sizeof(StatsRecord);
+    shared->slots = STATS_FEED_RECORDS;
+    atomic_thread_fence(memory_order_release);
+    shared->magic = STATS_FEED_MAGIC;
+    return true;
+}
+
+bool StatsFeedOpen(StatsFeed *feed, const char *name) {
+    *feed = (StatsFeed){ 0 };
+    if (!MapShared(feed, name, false)) return false;
+
+    const StatsFeedShared *shared = feed->shared;
+    if (shared->magic != STATS_FEED_MAGIC || shared->version != STATS_FEED_VERSION ||
+        shared->recordSize != sizeof(StatsRecord) || shared->slots != STATS_FEED_RECORDS) {
+        StatsFeedClose(feed);
+        return false;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return true;
+}
+
+void StatsFeedClose(StatsFeed *feed) {
+    if (!feed->shared) return;
+#if defined(_WIN32)
+    UnmapViewOfFile(feed->shared);
+    CloseHandle(feed->handle);
+#else
+    munmap(feed->shared, sizeof(StatsFeedShared));
+    if (feed->writer) shm_unlink(feed->name);
+#endif
+    *feed = (StatsFeed){ 0 };
+}
+
+void StatsFeedPublish(StatsFeed *feed, const StatsRecord *record) {
+    StatsFeedShared *shared = feed->shared;
+    if (!shared) return;
+
+    // Only this thread writes head, so a relaxed load sees its own last store
+    uint64_t n = atomic_load_explicit(&shared->head, memory_order_relaxed);
+    StatsSlot *slot = &shared->ring[n & (STATS_FEED_RECORDS - 1)];
+
+    atomic_store_explicit(&slot->sequence, 2 * n + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);      // Odd before any byte of the record
+    slot->record = *record;
+    atomic_store_explicit(&slot->sequence, 2 * n + 2, memory_order_release);
+    atomic_store_explicit(&shared->head, n + 1, memory_order_release);
+}
+
+bool StatsFeedRead(const StatsFeed *feed, uint64_t n, StatsRecord *record) {
+    StatsFeedShared *shared = feed->shared;
+    if (!shared) return false;
+    StatsSlot *slot = &shared->ring[n & (STATS_FEED_RECORDS - 1)];
+
+    uint64_t before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (before != 2 * n + 2) return false;          // Not written yet, being written or overwritten
+    memcpy(record, &slot->record, sizeof(*record));
+    atomic_thread_fence(memory_order_acquire);      // The copy before the second look
+    return atomic_load_explicit(&slot->sequence, memory_order_relaxed) == before;
+}
+
+bool StatsFeedLatest(const StatsFeed *feed, StatsRecord *record) {
+    if (!feed->shared) return false;
+    for (int tries = 0; tries < STATS_READ_TRIES; tries++) {
+        uint64_t head = atomic_load_explicit(&feed->shared->head, memory_order_acquire);
+        if (head == 0) return false;
+        if (StatsFeedRead(feed, head - 1, record)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,137 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - POOL STATISTICS FEED
+*
+*   Every pool refuses spawns once it is full (pool.h): a shot that isn't fired, an
+*   enemy that doesn't appear, an explosion with fewer particles. Nothing breaks, so
+*   nothing shows it. This turns the pools' counters into a record per tick:
+*
+*     - per pool: live entities, the high-water mark, spawns asked for and spawns
+*       dropped, counted over every game since the program started,
+*     - per tick: enemies of each type and the number of gameplay events.
+*
+*   The game can publish those records into shared memory, where another process
+*   (statsmon.c) reads them while the game runs. The shared memory is a ring of
+*   STATS_FEED_RECORDS records, each behind a sequence number (a seqlock):
+*
+*     writer:  sequence = odd, copy the record in, sequence = even, head++
+*     reader:  read the sequence, copy the record out, read it again; if it
+*              changed or was odd, the copy may be torn and is thrown away
+*
+*   The writer never waits for a reader and doesn't know if there is one; a reader
+*   that is too slow just misses records. The layout only uses fixed-size types, and
+*   the header has a magic number, a version and the record size to check against.
+*
+*   StatsCounter works without any shared memory (headless.c prints its totals).
+*   Pure C with C11 atomics, no raylib.
+*
+********************************************************************************************/
+
+#ifndef STATS_FEED_H
+#define STATS_FEED_H
+
+#include "sim.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #define STATS_FEED_NAME "Local\\space_shooter_stats"
+#else
+    #define STATS_FEED_NAME "/space_shooter_stats"
+#endif
+#define STATS_FEED_MAGIC    0x54415453u     // "STAT"
+#define STATS_FEED_VERSION  2
+#define STATS_FEED_RECORDS  256             // Ring size (a power of two): over 4 s of ticks at 60 Hz
+
+typedef enum {
+    STATS_POOL_BULLETS,
+    STATS_POOL_ENEMIES,
+    STATS_POOL_PARTICLES,
+    STATS_POOL_FROZEN,          // Enemies parked in frozen chunks of a tall world (sim.h)
+    STATS_POOL_COUNT
+} StatsPoolId;
+
+typedef struct {
+    int32_t live;
+    int32_t peak;               // Highest live count in any game
+    int32_t capacity;
+    int32_t reserved;
+    int64_t attempts;           // Entities asked for, all games together
+    int64_t dropped;            // Of those, refused because the pool was full
+} StatsPool;
+
+typedef struct {
+    uint64_t  tick;             // Ticks counted so far, this one included
+    double    time;             // When it was counted (the publisher's clock, seconds)
+    uint32_t  game;             // Games started so far
+    int32_t   events;           // Gameplay events in this tick
+    int32_t   enemies[ENEMY_TYPE_COUNT];    // Live enemies per type
+    StatsPool pools[STATS_POOL_COUNT];
+} StatsRecord;
+
+// =====================================================================
+// COUNTING
+// =====================================================================
+// The pools' counters start over with every game (SimInit); the counter adds
+// up the finished games, so the record's totals only ever grow.
+
+typedef struct {
+    StatsRecord record;         // The latest tick
+    int64_t     attempts[STATS_POOL_COUNT];     // Finished games
+    int64_t     dropped[STATS_POOL_COUNT];
+} StatsCounter;
+
+extern const char *const statsPoolNames[STATS_POOL_COUNT];
+
+void StatsCounterInit(StatsCounter *counter);
+
+// Count one tick of sim. game is a number that changes whenever a new game starts,
+// so counters that start over can be told apart from ones that went down.
+void StatsCounterTick(StatsCounter *counter, const Simulation *sim, uint32_t game, double time);
+
+// =====================================================================
+// SHARED MEMORY
+// =====================================================================
+
+typedef struct {
+    _Atomic uint64_t sequence;  // 2n + 1 while record n is written, 2n + 2 once it is done
+    StatsRecord      record;
+} StatsSlot;
+
+typedef struct {
+    uint32_t         magic;
+    uint32_t         version;
+    uint32_t         recordSize;    // sizeof(StatsRecord)
+    uint32_t         slots;         // STATS_FEED_RECORDS
+    _Atomic uint64_t head;          // Records published so far
+    StatsSlot        ring[STATS_FEED_RECORDS];
+} StatsFeedShared;
+
+typedef struct {
+    StatsFeedShared *shared;        // NULL: not open
+    bool             writer;
+    void            *handle;        // Windows only: the file mapping
+    char             name[64];      // What it was created or opened as
+} StatsFeed;
+
+// Writer: create (or take over) the shared memory under name and start an empty ring.
+// False if shared memory isn't available. Closing the writer removes the name again.
+bool StatsFeedCreate(StatsFeed *feed, const char *name);
+
+// Reader: map an existing feed read-only. False if there is none, or it is from
+// a build with a different layout.
+bool StatsFeedOpen(StatsFeed *feed, const char *name);
+
+void StatsFeedClose(StatsFeed *feed);
+
+// Writer: put record into the ring. Never blocks.
+void StatsFeedPublish(StatsFeed *feed, const StatsRecord *record);
+
+// Reader: the newest complete record. False if nothing has been published yet
+// (or the writer kept overwriting it while it was being read).
+bool StatsFeedLatest(const StatsFeed *feed, StatsRecord *record);
+
+// Reader: record number n (0 is the first ever published), if it is still in the ring
+bool StatsFeedRead(const StatsFeed *feed, uint64_t n, StatsRecord *record);
+
+#endif // STATS_FEED_H
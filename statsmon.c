@@ -0,0 +1,121 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - POOL STATISTICS MONITOR
+*
+*   Reads the statistics feed (stats_feed.h) of a running game from shared memory
+*   and prints a line of live rates every interval: for each pool the live count,
+*   the high-water mark, spawns per second and how many of those were dropped
+*   because the pool was full. It never stops or slows the game; it only reads.
+*
+*   Start the game (or headless) with --stats-feed, then this in another terminal.
+*   When the game goes away it waits for the next one.
+*
+*   To compile:
+*     gcc statsmon.c stats_feed.c -O2 -o statsmon
+*   (add -lrt for glibc older than 2.34)
+*
+*   Usage:
+*     ./statsmon [--interval=SECONDS] [--samples=N] [--name=NAME]
+*
+********************************************************************************************/
+
+#include "stats_feed.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MONITOR_HEADER_EVERY    20      // Lines between repeated column headers
+#define MONITOR_STALE           2.0     // Seconds without a new tick before looking for a new feed
+
+static void PrintHeader(void) {
+    printf("%8s %9s %5s", "time", "ticks/s", "game");
+    for (int p = 0; p < STATS_POOL_COUNT; p++) printf(" | %-33s", statsPoolNames[p]);
+    printf("\n%8s %9s %5s", "s", "", "");
+    for (int p = 0; p < STATS_POOL_COUNT; p++) printf(" | %7s %7s %9s %7s", "live", "peak", "spawns/s", "drop %");
+    printf("\n");
+}
+
+static void PrintRates(const StatsRecord *now, const StatsRecord *before, double seconds, double start) {
+    printf("%8.1f %9.1f %5u", now->time - start, (double)(now->tick - before->tick) / seconds, now->game);
+    for (int p = 0; p < STATS_POOL_COUNT; p++) {
+        const StatsPool *pool = &now->pools[p];
+        int64_t attempts = pool->attempts - before->pools[p].attempts;
+        int64_t dropped = pool->dropped - before->pools[p].dropped;
+        printf(" | %7d %7d %9.1f %6.1f%s", pool->live, pool->peak, attempts / seconds,
+               attempts > 0 ? 100.0 * dropped / attempts : 0.0, pool->peak >= pool->capacity ? "!" : " ");
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    double interval = 1.0;
+    long samples = -1;      // Forever
+    const char *name = STATS_FEED_NAME;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--interval=", 11) == 0) interval = atof(argv[i] + 11);
+        else if (strncmp(argv[i], "--samples=", 10) == 0) samples = atol(argv[i] + 10);
+        else if (strncmp(argv[i], "--name=", 7) == 0) name = argv[i] + 7;
+        else {
+            fprintf(stderr, "usage: %s [--interval=SECONDS] [--samples=N] [--name=NAME]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (interval < 0.05) interval = 0.05;
+
+    StatsFeed feed = { 0 };
+    StatsRecord before, now;
+    bool haveBefore = false;
+    double start = 0.0, lastNew = TimerNow();
+    bool waiting = false;
+    int lines = 0;
+
+    for (double next = TimerNow(); samples != 0; next += interval) {
+        TimerSleepUntil(next);
+
+        if (!feed.shared) {
+            if (!StatsFeedOpen(&feed, name)) {
+                if (!waiting) printf("waiting for a game with --stats-feed (%s)...\n", name);
+                fflush(stdout);
+                waiting = true;
+                continue;
+            }
+            printf("reading %s\n", name);
+            waiting = false;
+            haveBefore = false;
+            lines = 0;
+            lastNew = TimerNow();
+        }
+
+        if (!StatsFeedLatest(&feed, &now)) continue;
+        if (!haveBefore) {
+            before = now;
+            start = now.time;
+            haveBefore = true;
+            continue;
+        }
+        if (now.tick == before.tick) {
+            // The game is gone (or stuck): start over with whatever publishes next
+            if (TimerNow() - lastNew > MONITOR_STALE) {
+                printf("no new ticks for %.0f s\n", MONITOR_STALE);
+                StatsFeedClose(&feed);
+            }
+            continue;
+        }
+        lastNew = TimerNow();
+        if (now.tick < before.tick) {
+            before = now;       // Counting started over (a new run of headless)
+            continue;
+        }
+
+        if (lines++ % MONITOR_HEADER_EVERY == 0) PrintHeader();
+        PrintRates(&now, &before, now.time - before.time, start);
+        before = now;
+        if (samples > 0) samples--;
+    }
+
+    StatsFeedClose(&feed);
+    return 0;
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - HIGH RESOLUTION TIMER
+*
+*   A monotonic clock for benchmarks and tools that run without raylib
+*   (raylib's GetTime() needs an open window).
+*
+********************************************************************************************/
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <time.h>
+    #include <sched.h>
+#endif
+
+#define TIMER_SPIN  0.001   // The last stretch before a deadline is waited out by yielding, not sleeping
+
+// Seconds since an arbitrary fixed point, never goes backwards
+static inline double TimerNow(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+// Sleep most of the way, then yield until the deadline: sleeping alone
+// oversleeps by up to a scheduler tick, spinning alone burns a core
+static inline void TimerSleepUntil(double deadline) {
+    double remaining = deadline - TimerNow();
+    if (remaining > TIMER_SPIN) {
+        double seconds = remaining - TIMER_SPIN;
+#if defined(_WIN32)
+        Sleep((DWORD)(seconds * 1000.0));
+#else
+        struct timespec ts = { (time_t)seconds, (long)((seconds - (double)(time_t)seconds) * 1e9) };
+        nanosleep(&ts, NULL);
+#endif
+    }
+    while (TimerNow() < deadline) {
+#if defined(_WIN32)
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+    }
+}
+
+#endif // TIMER_H
@@ -0,0 +1,252 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - RETAINED UI
+*
+*   Same text, shapes and colors main.c used to draw every frame, now drawn into
+*   panels once and reused (see ui.h).
+*
+********************************************************************************************/
+
+#include "ui.h"
+#include <stdio.h>
+#include <math.h>
+
+// A cached piece of UI. key holds the values it was drawn for (unused ones are 0).
+typedef struct {
+    RenderTexture2D target;
+    int             width;
+    int             height;
+    int             key[3];
+    bool            valid;      // false until first drawn
+} UiPanel;
+
+typedef enum {
+    // HUD
+    PANEL_HP,
+    PANEL_SCORE,
+    PANEL_WAVE,
+    PANEL_TIME,
+    // Menu
+    PANEL_MENU_TITLE,       // Title and subtitle, bobbing up and down
+    PANEL_MENU_START,       // Blinking
+    PANEL_MENU_LEGEND,      // Controls and enemy types
+    // Game over
+    PANEL_GAMEOVER_TITLE,
+    PANEL_GAMEOVER_STATS,   // Final score, time and wave
+    PANEL_GAMEOVER_RETRY,   // Blinking
+    PANEL_GAMEOVER_MENU,
+    PANEL_COUNT
+} UiPanelId;
+
+// Texture sizes; full-width panels are centered by drawing at x = 0
+static const int panelSizes[PANEL_COUNT][2] = {
+    [PANEL_HP]             = { 200, 24 },
+    [PANEL_SCORE]          = { 200, 24 },
+    [PANEL_WAVE]           = { 120, 24 },
+    [PANEL_TIME]           = { 80, 20 },
+    [PANEL_MENU_TITLE]     = { SCREEN_WIDTH, 82 },
+    [PANEL_MENU_START]     = { SCREEN_WIDTH, 26 },
+    [PANEL_MENU_LEGEND]    = { SCREEN_WIDTH, 180 },
+    [PANEL_GAMEOVER_TITLE] = { SCREEN_WIDTH, 54 },
+    [PANEL_GAMEOVER_STATS] = { SCREEN_WIDTH, 110 },
+    [PANEL_GAMEOVER_RETRY] = { SCREEN_WIDTH, 26 },
+    [PANEL_GAMEOVER_MENU]  = { SCREEN_WIDTH, 22 },
+};
+
+static UiPanel panels[PANEL_COUNT];
+static UiStats stats;
+
+void UiLoad(void) {
+    for (int p = 0; p < PANEL_COUNT; p++) {
+        panels[p].width = panelSizes[p][0];
+        panels[p].height = panelSizes[p][1];
+        panels[p].target = LoadRenderTexture(panels[p].width, panels[p].height);
+        panels[p].valid = false;
+    }
+    stats = (UiStats){ 0 };
+}
+
+void UiUnload(void) {
+    for (int p = 0; p < PANEL_COUNT; p++) UnloadRenderTexture(panels[p].target);
+}
+
+UiStats UiGetStats(void) { return stats; }
+void UiResetStats(void) { stats = (UiStats){ 0 }; }
+
+// =====================================================================
+// PANELS
+// =====================================================================
+// LESSON: Drawing between BeginTextureMode() and EndTextureMode() goes into
+// a texture instead of the screen. The texture starts fully transparent, so
+// drawing it later with alpha blending shows only the text. (raylib's default
+// font has hard edges, so blending it twice looks the same as drawing it once.)
+
+// Returns true (and starts drawing into the panel) if its contents are stale
+static bool PanelBegin(UiPanel *panel, int a, int b, int c) {
+    if (panel->valid && panel->key[0] == a && panel->key[1] == b && panel->key[2] == c) {
+        stats.hits++;
+        return false;
+    }
+    panel->key[0] = a;
+    panel->key[1] = b;
+    panel->key[2] = c;
+    panel->valid = true;
+    stats.renders++;
+    BeginTextureMode(panel->target);
+    ClearBackground(BLANK);
+    return true;
+}
+
+static void PanelEnd(void) {
+    EndTextureMode();
+}
+
+// Render textures are stored upside down, hence the negative source height
+static void PanelDraw(const UiPanel *panel, float x, float y, Color tint) {
+    Rectangle source = { 0, 0, (float)panel->width, -(float)panel->height };
+    DrawTextureRec(panel->target.texture, source, (Vector2){ x, y }, tint);
+}
+
+static void DrawTextCentered(const char *text, int y, int fontSize, Color color) {
+    DrawText(text, SCREEN_WIDTH / 2 - MeasureText(text, fontSize) / 2, y, fontSize, color);
+}
+
+// Big title with a drop shadow 2 px down and right
+static void DrawTitle(const char *text, int fontSize, Color shadow, Color color) {
+    int x = SCREEN_WIDTH / 2 - MeasureText(text, fontSize) / 2;
+    DrawText(text, x + 2, 2, fontSize, shadow);
+    DrawText(text, x, 0, fontSize, color);
+}
+
+// =====================================================================
+// HUD
+// =====================================================================
+
+void UiDrawHud(const Simulation *sim) {
+    char text[64];
+
+    // Health indicator
+    UiPanel *hp = &panels[PANEL_HP];
+    if (PanelBegin(hp, sim->player.health, 0, 0)) {
+        DrawText("HP:", 0, 0, 20, WHITE);
+        for (int i = 0; i < sim->player.health && 40 + i * 25 + 18 <= hp->width; i++) {
+            DrawRectangle(40 + i * 25, 2, 18, 18, (Color){ 255, 50, 50, 255 });
+            DrawRectangleLines(40 + i * 25, 2, 18, 18, WHITE);
+        }
+        PanelEnd();
+    }
+    PanelDraw(hp, 10, 10, WHITE);
+
+    // Score
+    if (PanelBegin(&panels[PANEL_SCORE], sim->player.score, 0, 0)) {
+        snprintf(text, sizeof(text), "SCORE: %d", sim->player.score);
+        DrawText(text, 0, 0, 20, (Color){ 0, 255, 200, 255 });
+        PanelEnd();
+    }
+    PanelDraw(&panels[PANEL_SCORE], SCREEN_WIDTH - 200, 10, WHITE);
+
+    // Wave info
+    if (PanelBegin(&panels[PANEL_WAVE], sim->wave, 0, 0)) {
+        snprintf(text, sizeof(text), "WAVE: %d", sim->wave);
+        DrawText(text, 0, 0, 20, YELLOW);
+        PanelEnd();
+    }
+    PanelDraw(&panels[PANEL_WAVE], SCREEN_WIDTH / 2 - 40, 10, WHITE);
+
+    // Time, shown to a tenth of a second
+    if (PanelBegin(&panels[PANEL_TIME], (int)lroundf(sim->gameTime * 10.0f), 0, 0)) {
+        snprintf(text, sizeof(text), "%.1f sec", sim->gameTime);
+        DrawText(text, 0, 0, 16, GRAY);
+        PanelEnd();
+    }
+    PanelDraw(&panels[PANEL_TIME], SCREEN_WIDTH - 80, 35, WHITE);
+}
+
+// =====================================================================
+// MENU
+// =====================================================================
+
+void UiDrawMenu(double time) {
+    // Title and subtitle (animated)
+    if (PanelBegin(&panels[PANEL_MENU_TITLE], 0, 0, 0)) {
+        DrawTitle("SPACE SHOOTER", 50, DARKBLUE, (Color){ 0, 200, 255, 255 });
+        DrawTextCentered("made with raylib", 60, 20, GRAY);
+        PanelEnd();
+    }
+    float titleY = 120 + sinf(time * 2.0f) * 10.0f;
+    PanelDraw(&panels[PANEL_MENU_TITLE], 0, (float)(int)titleY, WHITE);
+
+    // Start button (blinking)
+    if (PanelBegin(&panels[PANEL_MENU_START], 0, 0, 0)) {
+        DrawTextCentered("[ ENTER ] to START", 0, 24, (Color){ 0, 200, 255, 255 });
+        PanelEnd();
+    }
+    float alpha = (sinf(time * 3.0f) + 1.0f) / 2.0f;
+    PanelDraw(&panels[PANEL_MENU_START], 0, 320, (Color){ 255, 255, 255, (unsigned char)(150 + alpha * 105) });
+
+    // Controls info and enemy types, drawn relative to infoY
+    if (PanelBegin(&panels[PANEL_MENU_LEGEND], 0, 0, 0)) {
+        DrawText("CONTROLS:", SCREEN_WIDTH / 2 - 80, 0, 20, WHITE);
+        DrawText("WASD / Arrow Keys  -  Move", SCREEN_WIDTH / 2 - 140, 35, 16, LIGHTGRAY);
+        DrawText("SPACE / Left Click -  Shoot", SCREEN_WIDTH / 2 - 140, 60, 16, LIGHTGRAY);
+
+        DrawRectangle(SCREEN_WIDTH / 2 - 120, 100, 18, 18, (Color){ 180, 20, 80, 255 });
+        DrawText("Normal (100 pts)", SCREEN_WIDTH / 2 - 90, 100, 16, LIGHTGRAY);
+
+        // Fast enemy preview (tip pointing down, clockwise)
+        float mx = SCREEN_WIDTH / 2.0f - 111;
+        float my = 135.0f;
+        Vector2 mv0 = { mx,      my - 10 };
+        Vector2 mv1 = { mx + 10, my + 8  };
+        Vector2 mv2 = { mx - 10, my + 8  };
+        DrawTriangle(mv0, mv1, mv2, (Color){ 220, 0, 120, 255 });
+        DrawTriangleLines(mv0, mv1, mv2, (Color){ 255, 150, 220, 255 });
+        DrawText("Fast   (150 pts)", SCREEN_WIDTH / 2 - 90, 128, 16, LIGHTGRAY);
+
+        DrawPoly((Vector2){ SCREEN_WIDTH / 2.0f - 111, 165.0f }, 6, 10, 0, (Color){ 140, 0, 200, 255 });
+        DrawText("Strong (300 pts)", SCREEN_WIDTH / 2 - 90, 156, 16, LIGHTGRAY);
+        PanelEnd();
+    }
+    PanelDraw(&panels[PANEL_MENU_LEGEND], 0, 420, WHITE);
+}
+
+// =====================================================================
+// GAME OVER
+// =====================================================================
+
+void UiDrawGameOver(const Simulation *sim, double time) {
+    char text[64];
+
+    // Title
+    if (PanelBegin(&panels[PANEL_GAMEOVER_TITLE], 0, 0, 0)) {
+        DrawTitle("GAME OVER!", 50, MAROON, RED);
+        PanelEnd();
+    }
+    PanelDraw(&panels[PANEL_GAMEOVER_TITLE], 0, 150, WHITE);
+
+    // Score and stats: only redrawn when another game has ended
+    if (PanelBegin(&panels[PANEL_GAMEOVER_STATS], sim->player.score, sim->wave, (int)lroundf(sim->gameTime * 10.0f))) {
+        snprintf(text, sizeof(text), "SCORE: %d", sim->player.score);
+        DrawTextCentered(text, 0, 36, (Color){ 0, 255, 200, 255 });
+        snprintf(text, sizeof(text), "Survival time: %.1f seconds", sim->gameTime);
+        DrawTextCentered(text, 55, 20, LIGHTGRAY);
+        snprintf(text, sizeof(text), "Wave reached: %d", sim->wave);
+        DrawTextCentered(text, 85, 20, LIGHTGRAY);
+        PanelEnd();
+    }
+    PanelDraw(&panels[PANEL_GAMEOVER_STATS], 0, 230, WHITE);
+
+    // Play again (blinking)
+    if (PanelBegin(&panels[PANEL_GAMEOVER_RETRY], 0, 0, 0)) {
+        DrawTextCentered("[ ENTER ] to PLAY AGAIN", 0, 24, (Color){ 255, 200, 0, 255 });
+        PanelEnd();
+    }
+    float alpha = (sinf(time * 3.0f) + 1.0f) / 2.0f;
+    PanelDraw(&panels[PANEL_GAMEOVER_RETRY], 0, 400, (Color){ 255, 255, 255, (unsigned char)(150 + alpha * 105) });
+
+    if (PanelBegin(&panels[PANEL_GAMEOVER_MENU], 0, 0, 0)) {
+        DrawTextCentered("[ ESC ] for MENU", 0, 20, GRAY);
+        PanelEnd();
+    }
+    PanelDraw(&panels[PANEL_GAMEOVER_MENU], 0, 440, WHITE);
+}
@@ -0,0 +1,39 @@
+/*******************************************************************************************
+*
+*   SPACE SHOOTER - RETAINED UI
+*
+*   The HUD, menu and game over text, cached in render textures. Each piece of UI is
+*   a UiPanel: a texture plus the value it was last drawn for. A panel is only drawn
+*   again (DrawText, MeasureText, snprintf) when that value changes - the score panel
+*   when the score changes, the menu legend never - and every other frame costs one
+*   textured quad. Blinking and bobbing are done with the tint and position of that
+*   quad, so they don't invalidate anything.
+*
+*   Needs raylib and an open window: call UiLoad() after InitWindow() and UiUnload()
+*   before CloseWindow().
+*
+********************************************************************************************/
+
+#ifndef UI_H
+#define UI_H
+
+#include "raylib.h"
+#include "sim.h"
+
+// Cache counters since UiLoad (or the last UiResetStats)
+typedef struct {
+    int hits;               // Panels drawn straight from their texture
+    int renders;            // Panels whose value changed and were drawn again
+} UiStats;
+
+void UiLoad(void);
+void UiUnload(void);
+
+void UiDrawHud(const Simulation *sim);
+void UiDrawMenu(double time);
+void UiDrawGameOver(const Simulation *sim, double time);
+
+UiStats UiGetStats(void);
+void    UiResetStats(void);
+
+#endif // UI_H